@@ -0,0 +1,46 @@
+#include "SPBinaryUtil.h"
+
+#define FNV32_PRIME 16777619u
+#define FNV64_PRIME 1099511628211ULL
+
+uint32_t spBinaryReadLE32(const unsigned char* bytes) {
+	return (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8) | ((uint32_t) bytes[2] << 16)
+			| ((uint32_t) bytes[3] << 24);
+}
+
+void spBinaryWriteLE32(unsigned char* bytes, uint32_t value) {
+	for (int i=0; i<4; i++) {
+		bytes[i] = (unsigned char) (value >> (8*i));
+	}
+}
+
+uint64_t spBinaryReadLE64(const unsigned char* bytes) {
+	return (uint64_t) spBinaryReadLE32(bytes) | ((uint64_t) spBinaryReadLE32(bytes + 4) << 32);
+}
+
+void spBinaryWriteLE64(unsigned char* bytes, uint64_t value) {
+	spBinaryWriteLE32(bytes, (uint32_t) value);
+	spBinaryWriteLE32(bytes + 4, (uint32_t) (value >> 32));
+}
+
+uint32_t spBinaryChecksum(uint32_t hash, const unsigned char* bytes, size_t size) {
+	for (size_t i=0; i<size; i++) {
+		hash ^= bytes[i];
+		hash *= FNV32_PRIME;
+	}
+	return hash;
+}
+
+unsigned long long spBinaryHashBytes(unsigned long long hash, const unsigned char* bytes, size_t size) {
+	for (size_t i=0; i<size; i++) {
+		hash ^= bytes[i];
+		hash *= FNV64_PRIME;
+	}
+	return hash;
+}
+
+unsigned long long spBinaryHashValue(unsigned long long hash, uint64_t value) {
+	unsigned char bytes[8];
+	spBinaryWriteLE64(bytes, value);
+	return spBinaryHashBytes(hash, bytes, sizeof(bytes));
+}
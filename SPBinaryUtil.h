@@ -0,0 +1,63 @@
+#ifndef SPBINARYUTIL_H_
+#define SPBINARYUTIL_H_
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * SP Binary Util summary
+ * The byte order and hash helpers shared by the binary file formats (feats files, the features
+ * database, k-d tree snapshots and extraction manifests). Integers are stored little-endian
+ * regardless of the host, and checksums and hashes are FNV-1a.
+ *
+ * The following functions are supported:
+ *
+ * spBinaryReadLE32		- Reads a little-endian 32-bit unsigned integer
+ * spBinaryWriteLE32		- Writes a little-endian 32-bit unsigned integer
+ * spBinaryReadLE64		- Reads a little-endian 64-bit unsigned integer
+ * spBinaryWriteLE64		- Writes a little-endian 64-bit unsigned integer
+ * spBinaryChecksum		- 32-bit FNV-1a hash of bytes
+ * spBinaryHashBytes		- 64-bit FNV-1a hash of bytes
+ * spBinaryHashValue		- 64-bit FNV-1a hash of a 64-bit value
+ */
+
+#define SP_BINARY_FNV32_OFFSET_BASIS 2166136261u
+#define SP_BINARY_FNV64_OFFSET_BASIS 14695981039346656037ULL
+
+/**
+ * Reads a little-endian 32-bit unsigned integer from the 4 bytes at <bytes>.
+ */
+uint32_t spBinaryReadLE32(const unsigned char* bytes);
+
+/**
+ * Writes <value> as a little-endian 32-bit unsigned integer to the 4 bytes at <bytes>.
+ */
+void spBinaryWriteLE32(unsigned char* bytes, uint32_t value);
+
+/**
+ * Reads a little-endian 64-bit unsigned integer from the 8 bytes at <bytes>.
+ */
+uint64_t spBinaryReadLE64(const unsigned char* bytes);
+
+/**
+ * Writes <value> as a little-endian 64-bit unsigned integer to the 8 bytes at <bytes>.
+ */
+void spBinaryWriteLE64(unsigned char* bytes, uint64_t value);
+
+/**
+ * 32-bit FNV-1a hash of the bytes, continuing from <hash>
+ * (SP_BINARY_FNV32_OFFSET_BASIS for the first bytes).
+ */
+uint32_t spBinaryChecksum(uint32_t hash, const unsigned char* bytes, size_t size);
+
+/**
+ * 64-bit FNV-1a hash of the bytes, continuing from <hash>
+ * (SP_BINARY_FNV64_OFFSET_BASIS for the first bytes).
+ */
+unsigned long long spBinaryHashBytes(unsigned long long hash, const unsigned char* bytes, size_t size);
+
+/**
+ * 64-bit FNV-1a hash of a value, as 8 little-endian bytes, continuing from <hash>.
+ */
+unsigned long long spBinaryHashValue(unsigned long long hash, uint64_t value);
+
+#endif
@@ -1,4 +1,5 @@
 #include "SPConfig.h"
+#include "SPImageCatalogue.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -8,6 +9,7 @@
 
 //File open mode
 #define SP_CONFIG_OPEN_MODE "r"
+#define SP_CONFIG_FEATS_SUFFIX ".feats"
 
 struct sp_config_t {
 	char spImagesDirectory[STR_MAX_LENGTH+1];	//path of images directory
@@ -24,6 +26,24 @@ struct sp_config_t {
 	bool spMinimalGUI;
 	int spLoggerLevel;							//indicates the active level of the logger {1,2,3,4}
 	char spLoggerFilename[STR_MAX_LENGTH+1];	//the log file name
+	int spNumOfThreads;							//the number of threads used to search the query features
+	int spNumOfDecodeThreads;					//the number of pipeline workers decoding query images
+	int spNumOfExtractThreads;					//the number of workers extracting image and query features
+	int spNumOfSearchThreads;					//the number of pipeline workers searching query features
+	int spPipelineQueueSize;					//the capacity of each queue between pipeline stages
+	int spNumOfServerThreads;					//the number of client requests served concurrently
+	bool spEarlyTermination;					//stop searching once the best images are decided
+	int spQueryCacheSize;						//the memory budget of the query cache in megabytes
+	int spQueryDeadline;						//the latency budget of each query in milliseconds
+	bool spBinaryFeatures;						//write the feats files in the binary format
+	char spDatabaseFilename[STR_MAX_LENGTH+1];	//the filename of the features database, empty if not used
+	int spNumOfLoadThreads;						//the number of workers loading the feats files
+	char spKDTreeSnapshotFilename[STR_MAX_LENGTH+1]; //the filename of the KD tree snapshot, empty if not used
+	int spMaxImageDimension;					//the largest side images are downscaled to before SIFT, 0 if not capped
+	SP_FEATURE_TYPE spFeatureType;				//SIFT features reduced by the PCA, or binary ORB features
+	char spExtractionManifestFilename[STR_MAX_LENGTH+1]; //the filename of the extraction manifest, empty if not used
+	char spCatalogueFilename[STR_MAX_LENGTH+1];	//the filename of the image catalogue, empty if not used
+	SPImageCatalogue* catalogue;				//the paths of the images by index, NULL if not used
 };
 
 SPConfig spConfigCreate(const char* filename, SP_CONFIG_MSG* msg) {
@@ -148,6 +168,16 @@ int spConfigGetKNN(const SPConfig config, SP_CONFIG_MSG* msg) {
 	return config->spKNN;
 }
 
+int spConfigGetNumOfThreads(const SPConfig config, SP_CONFIG_MSG* msg) {
+	assert(msg!=NULL);
+	if (config == NULL) {
+		*msg = SP_CONFIG_INVALID_ARGUMENT;
+		return -1;
+	}
+	*msg = SP_CONFIG_SUCCESS;
+	return config->spNumOfThreads;
+}
+
 int spConfigGetNumOfSimilarImages(const SPConfig config, SP_CONFIG_MSG* msg) {
 	assert(msg!=NULL);
 	if (config == NULL) {
@@ -158,12 +188,150 @@ int spConfigGetNumOfSimilarImages(const SPConfig config, SP_CONFIG_MSG* msg) {
 	return config->spNumOfSimilarImages;
 }
 
+int spConfigGetNumOfDecodeThreads(const SPConfig config, SP_CONFIG_MSG* msg) {
+	assert(msg!=NULL);
+	if (config == NULL) {
+		*msg = SP_CONFIG_INVALID_ARGUMENT;
+		return -1;
+	}
+	*msg = SP_CONFIG_SUCCESS;
+	return config->spNumOfDecodeThreads;
+}
+
+int spConfigGetNumOfExtractThreads(const SPConfig config, SP_CONFIG_MSG* msg) {
+	assert(msg!=NULL);
+	if (config == NULL) {
+		*msg = SP_CONFIG_INVALID_ARGUMENT;
+		return -1;
+	}
+	*msg = SP_CONFIG_SUCCESS;
+	return config->spNumOfExtractThreads;
+}
+
+int spConfigGetNumOfSearchThreads(const SPConfig config, SP_CONFIG_MSG* msg) {
+	assert(msg!=NULL);
+	if (config == NULL) {
+		*msg = SP_CONFIG_INVALID_ARGUMENT;
+		return -1;
+	}
+	*msg = SP_CONFIG_SUCCESS;
+	return config->spNumOfSearchThreads;
+}
+
+int spConfigGetPipelineQueueSize(const SPConfig config, SP_CONFIG_MSG* msg) {
+	assert(msg!=NULL);
+	if (config == NULL) {
+		*msg = SP_CONFIG_INVALID_ARGUMENT;
+		return -1;
+	}
+	*msg = SP_CONFIG_SUCCESS;
+	return config->spPipelineQueueSize;
+}
+
+int spConfigGetNumOfServerThreads(const SPConfig config, SP_CONFIG_MSG* msg) {
+	assert(msg!=NULL);
+	if (config == NULL) {
+		*msg = SP_CONFIG_INVALID_ARGUMENT;
+		return -1;
+	}
+	*msg = SP_CONFIG_SUCCESS;
+	return config->spNumOfServerThreads;
+}
+
+bool spConfigIsEarlyTermination(const SPConfig config, SP_CONFIG_MSG* msg) {
+	assert(msg!=NULL);
+	if (config == NULL) {
+		*msg = SP_CONFIG_INVALID_ARGUMENT;
+		return false;
+	}
+	*msg = SP_CONFIG_SUCCESS;
+	return config->spEarlyTermination;
+}
+
+int spConfigGetQueryCacheSize(const SPConfig config, SP_CONFIG_MSG* msg) {
+	assert(msg!=NULL);
+	if (config == NULL) {
+		*msg = SP_CONFIG_INVALID_ARGUMENT;
+		return -1;
+	}
+	*msg = SP_CONFIG_SUCCESS;
+	return config->spQueryCacheSize;
+}
+
+int spConfigGetQueryDeadline(const SPConfig config, SP_CONFIG_MSG* msg) {
+	assert(msg!=NULL);
+	if (config == NULL) {
+		*msg = SP_CONFIG_INVALID_ARGUMENT;
+		return -1;
+	}
+	*msg = SP_CONFIG_SUCCESS;
+	return config->spQueryDeadline;
+}
+
+bool spConfigIsBinaryFeatures(const SPConfig config, SP_CONFIG_MSG* msg) {
+	assert(msg!=NULL);
+	if (config == NULL) {
+		*msg = SP_CONFIG_INVALID_ARGUMENT;
+		return false;
+	}
+	*msg = SP_CONFIG_SUCCESS;
+	return config->spBinaryFeatures;
+}
+
+int spConfigGetNumOfLoadThreads(const SPConfig config, SP_CONFIG_MSG* msg) {
+	assert(msg!=NULL);
+	if (config == NULL) {
+		*msg = SP_CONFIG_INVALID_ARGUMENT;
+		return -1;
+	}
+	*msg = SP_CONFIG_SUCCESS;
+	return config->spNumOfLoadThreads;
+}
+
+int spConfigGetMaxImageDimension(const SPConfig config, SP_CONFIG_MSG* msg) {
+	assert(msg!=NULL);
+	if (config == NULL) {
+		*msg = SP_CONFIG_INVALID_ARGUMENT;
+		return -1;
+	}
+	*msg = SP_CONFIG_SUCCESS;
+	return config->spMaxImageDimension;
+}
+
+SP_FEATURE_TYPE spConfigGetFeatureType(const SPConfig config, SP_CONFIG_MSG* msg) {
+	assert(msg!=NULL);
+	if (config == NULL) {
+		*msg = SP_CONFIG_INVALID_ARGUMENT;
+		return SIFT_FEATURES;
+	}
+	*msg = SP_CONFIG_SUCCESS;
+	return config->spFeatureType;
+}
+
+int spConfigGetFeatureDim(const SPConfig config, SP_CONFIG_MSG* msg) {
+	assert(msg!=NULL);
+	if (config == NULL) {
+		*msg = SP_CONFIG_INVALID_ARGUMENT;
+		return -1;
+	}
+	*msg = SP_CONFIG_SUCCESS;
+	return (config->spFeatureType == ORB_FEATURES) ? ORB_FEATURE_DIM : config->spPCADimension;
+}
+
 SP_CONFIG_MSG spConfigGetImagePath(char* imagePath, const SPConfig config, int index) {
 	if (imagePath == NULL || config == NULL)
 		return SP_CONFIG_INVALID_ARGUMENT;
 	if (index >= config->spNumOfImages)
 		return SP_CONFIG_INDEX_OUT_OF_RANGE;
 
+	if (config->catalogue != NULL) { // the path of the image is listed in the catalogue
+		const char* cataloguePath = spImageCatalogueGetPath(config->catalogue, index);
+		if (cataloguePath == NULL) {
+			return SP_CONFIG_INDEX_OUT_OF_RANGE;
+		}
+		strcpy(imagePath, cataloguePath);
+		return SP_CONFIG_SUCCESS;
+	}
 	if (sprintf(imagePath, "%s%s%d%s", config->spImagesDirectory,
 			config->spImagesPrefix, index, config->spImagesSuffix) < 0) {
 		return SP_CONFIG_INDEX_OUT_OF_RANGE;
@@ -181,6 +349,48 @@ SP_CONFIG_MSG spConfigGetPCAPath(char* pcaPath, const SPConfig config) {
     return SP_CONFIG_SUCCESS;
 }
 
+SP_CONFIG_MSG spConfigGetDatabasePath(char* databasePath, const SPConfig config) {
+	if (databasePath == NULL || config == NULL)
+		return SP_CONFIG_INVALID_ARGUMENT;
+
+	if (config->spDatabaseFilename[0] == '\0') { // per-image feats files
+		databasePath[0] = '\0';
+		return SP_CONFIG_SUCCESS;
+	}
+	if (sprintf(databasePath, "%s%s", config->spImagesDirectory, config->spDatabaseFilename) < 0) {
+		return SP_CONFIG_INDEX_OUT_OF_RANGE;
+	}
+	return SP_CONFIG_SUCCESS;
+}
+
+SP_CONFIG_MSG spConfigGetExtractionManifestPath(char* manifestPath, const SPConfig config) {
+	if (manifestPath == NULL || config == NULL)
+		return SP_CONFIG_INVALID_ARGUMENT;
+
+	if (config->spExtractionManifestFilename[0] == '\0') { // every image is always extracted
+		manifestPath[0] = '\0';
+		return SP_CONFIG_SUCCESS;
+	}
+	if (sprintf(manifestPath, "%s%s", config->spImagesDirectory, config->spExtractionManifestFilename) < 0) {
+		return SP_CONFIG_INDEX_OUT_OF_RANGE;
+	}
+	return SP_CONFIG_SUCCESS;
+}
+
+SP_CONFIG_MSG spConfigGetKDTreeSnapshotPath(char* snapshotPath, const SPConfig config) {
+	if (snapshotPath == NULL || config == NULL)
+		return SP_CONFIG_INVALID_ARGUMENT;
+
+	if (config->spKDTreeSnapshotFilename[0] == '\0') { // the KD tree is always built
+		snapshotPath[0] = '\0';
+		return SP_CONFIG_SUCCESS;
+	}
+	if (sprintf(snapshotPath, "%s%s", config->spImagesDirectory, config->spKDTreeSnapshotFilename) < 0) {
+		return SP_CONFIG_INDEX_OUT_OF_RANGE;
+	}
+	return SP_CONFIG_SUCCESS;
+}
+
 char* spConfigGetLoggerFilename(const SPConfig config, SP_CONFIG_MSG* msg) {
 	assert(msg != NULL);
 	if (config == NULL) {
@@ -237,8 +447,21 @@ SP_CONFIG_MSG spConfigGetFeatsPath(char* imagePath, SPConfig config, int index)
 	if (index >= config->spNumOfImages)
 		return SP_CONFIG_INDEX_OUT_OF_RANGE;
 
+	if (config->catalogue != NULL) { // next to the image, its suffix replaced
+		const char* cataloguePath = spImageCatalogueGetPath(config->catalogue, index);
+		if (cataloguePath == NULL) {
+			return SP_CONFIG_INDEX_OUT_OF_RANGE;
+		}
+		strcpy(imagePath, cataloguePath);
+		char* suffix = strrchr(imagePath, '.');
+		if (suffix != NULL && strchr(suffix, '/') == NULL) {
+			*suffix = '\0';
+		}
+		strcat(imagePath, SP_CONFIG_FEATS_SUFFIX);
+		return SP_CONFIG_SUCCESS;
+	}
 	if (sprintf(imagePath, "%s%s%d%s", config->spImagesDirectory,
-			config->spImagesPrefix, index, ".feats") < 0) {
+			config->spImagesPrefix, index, SP_CONFIG_FEATS_SUFFIX) < 0) {
 		return SP_CONFIG_INDEX_OUT_OF_RANGE;
 	}
 	return SP_CONFIG_SUCCESS;
@@ -248,12 +471,13 @@ void spConfigDestroy(SPConfig config) {
 	if (!config) {
 		return;
 	}
+	spImageCatalogueDestroy(config->catalogue);
 	free(config);	//free allocation
 	config = NULL;
 }
 
 void spConfigPrintError(const char* filename, int line, int error_type, char* param_name) {
-	if (filename == NULL || line < 0 || error_type < 0 || error_type > 3 || (error_type == 3 && param_name == NULL)) {
+	if (filename == NULL || line < 0 || error_type < 0 || error_type > 4 || (error_type == 3 && param_name == NULL)) {
 		printf("Invalid arguments\n");
 		return;
 	}
@@ -267,6 +491,9 @@ void spConfigPrintError(const char* filename, int line, int error_type, char* pa
 	case 3:
 		printf("File: %s\nLine: %d\nMessage: Parameter %s is not set\n", filename, line, param_name);
 		break;
+	case 4:
+		printf("File: %s\nLine: %d\nMessage: Invalid image catalogue\n", filename, line);
+		break;
 	}
 }
 
@@ -521,6 +748,254 @@ bool spConfigGetVariables(SPConfig config, FILE* fp, SP_CONFIG_MSG* msg, const c
 				return false;
 			}
 		}
+		if (strcmp(system_param, "spNumOfThreads") == 0) {
+			if (isNumber(val)) {
+				int temp = atoi(val);
+				if (temp > 0) {
+					config->spNumOfThreads = temp;
+					(*lineNumber)++;
+					continue;
+				}
+				else {
+					spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+					return false;
+				}
+			}
+			else {
+				spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+				return false;
+			}
+		}
+		if (strcmp(system_param, "spNumOfDecodeThreads") == 0) {
+			if (isNumber(val)) {
+				int temp = atoi(val);
+				if (temp > 0) {
+					config->spNumOfDecodeThreads = temp;
+					(*lineNumber)++;
+					continue;
+				}
+				else {
+					spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+					return false;
+				}
+			}
+			else {
+				spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+				return false;
+			}
+		}
+		if (strcmp(system_param, "spNumOfExtractThreads") == 0) {
+			if (isNumber(val)) {
+				int temp = atoi(val);
+				if (temp > 0) {
+					config->spNumOfExtractThreads = temp;
+					(*lineNumber)++;
+					continue;
+				}
+				else {
+					spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+					return false;
+				}
+			}
+			else {
+				spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+				return false;
+			}
+		}
+		if (strcmp(system_param, "spNumOfSearchThreads") == 0) {
+			if (isNumber(val)) {
+				int temp = atoi(val);
+				if (temp > 0) {
+					config->spNumOfSearchThreads = temp;
+					(*lineNumber)++;
+					continue;
+				}
+				else {
+					spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+					return false;
+				}
+			}
+			else {
+				spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+				return false;
+			}
+		}
+		if (strcmp(system_param, "spPipelineQueueSize") == 0) {
+			if (isNumber(val)) {
+				int temp = atoi(val);
+				if (temp > 0) {
+					config->spPipelineQueueSize = temp;
+					(*lineNumber)++;
+					continue;
+				}
+				else {
+					spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+					return false;
+				}
+			}
+			else {
+				spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+				return false;
+			}
+		}
+		if (strcmp(system_param, "spNumOfServerThreads") == 0) {
+			if (isNumber(val)) {
+				int temp = atoi(val);
+				if (temp > 0) {
+					config->spNumOfServerThreads = temp;
+					(*lineNumber)++;
+					continue;
+				}
+				else {
+					spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+					return false;
+				}
+			}
+			else {
+				spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+				return false;
+			}
+		}
+		if (strcmp(system_param, "spEarlyTermination") == 0) {
+			if (strcmp(val, "true") == 0) {
+				config->spEarlyTermination = true;
+				(*lineNumber)++;
+				continue;
+			}
+			else if (strcmp(val, "false") == 0) {
+				config->spEarlyTermination = false;
+				(*lineNumber)++;
+				continue;
+			}
+			else {
+				spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_STRING ,filename, *lineNumber, 2, NULL);
+				return false;
+			}
+		}
+		if (strcmp(system_param, "spQueryCacheSize") == 0) {
+			if (isNumber(val)) {
+				int temp = atoi(val);
+				if (temp >= 0) {
+					config->spQueryCacheSize = temp;
+					(*lineNumber)++;
+					continue;
+				}
+				else {
+					spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+					return false;
+				}
+			}
+			else {
+				spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+				return false;
+			}
+		}
+		if (strcmp(system_param, "spQueryDeadline") == 0) {
+			if (isNumber(val)) {
+				int temp = atoi(val);
+				if (temp >= 0) {
+					config->spQueryDeadline = temp;
+					(*lineNumber)++;
+					continue;
+				}
+				else {
+					spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+					return false;
+				}
+			}
+			else {
+				spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+				return false;
+			}
+		}
+		if (strcmp(system_param, "spBinaryFeatures") == 0) {
+			if (strcmp(val, "true") == 0) {
+				config->spBinaryFeatures = true;
+				(*lineNumber)++;
+				continue;
+			}
+			else if (strcmp(val, "false") == 0) {
+				config->spBinaryFeatures = false;
+				(*lineNumber)++;
+				continue;
+			}
+			else {
+				spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_STRING ,filename, *lineNumber, 2, NULL);
+				return false;
+			}
+		}
+		if (strcmp(system_param, "spDatabaseFilename") == 0) {
+			strcpy(config->spDatabaseFilename, val);
+			(*lineNumber)++;
+			continue;
+		}
+		if (strcmp(system_param, "spNumOfLoadThreads") == 0) {
+			if (isNumber(val)) {
+				int temp = atoi(val);
+				if (temp > 0) {
+					config->spNumOfLoadThreads = temp;
+					(*lineNumber)++;
+					continue;
+				}
+				else {
+					spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+					return false;
+				}
+			}
+			else {
+				spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+				return false;
+			}
+		}
+		if (strcmp(system_param, "spCatalogueFilename") == 0) {
+			strcpy(config->spCatalogueFilename, val);
+			(*lineNumber)++;
+			continue;
+		}
+		if (strcmp(system_param, "spExtractionManifestFilename") == 0) {
+			strcpy(config->spExtractionManifestFilename, val);
+			(*lineNumber)++;
+			continue;
+		}
+		if (strcmp(system_param, "spKDTreeSnapshotFilename") == 0) {
+			strcpy(config->spKDTreeSnapshotFilename, val);
+			(*lineNumber)++;
+			continue;
+		}
+		if (strcmp(system_param, "spMaxImageDimension") == 0) {
+			if (isNumber(val)) {
+				int temp = atoi(val);
+				if (temp >= 0) {
+					config->spMaxImageDimension = temp;
+					(*lineNumber)++;
+					continue;
+				}
+				else {
+					spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+					return false;
+				}
+			}
+			else {
+				spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_INTEGER ,filename, *lineNumber, 2, NULL);
+				return false;
+			}
+		}
+		if (strcmp(system_param, "spFeatureType") == 0) {
+			if (strcmp(val, "SIFT") == 0) {
+				config->spFeatureType = SIFT_FEATURES;
+				(*lineNumber)++;
+				continue;
+			}
+			else if (strcmp(val, "ORB") == 0) {
+				config->spFeatureType = ORB_FEATURES;
+				(*lineNumber)++;
+				continue;
+			}
+			else {
+				spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_STRING ,filename, *lineNumber, 2, NULL);
+				return false;
+			}
+		}
 		if (strcmp(system_param, "spLoggerFilename") == 0) {
 			strcpy(config->spLoggerFilename, val);
 			(*lineNumber)++;
@@ -543,7 +1018,25 @@ void spConfigSetDefaultValues(SPConfig config) {
 	config->spKDTreeSplitMethod = DEFAULT_KDT_SPLIT_METHOD;
 	config->spLoggerLevel = DEFAULT_LOGGER_LVL;
 	strcpy(config->spLoggerFilename, DEFAULT_LOGGER_FILENAME);
+	config->spNumOfThreads = DEFAULT_NUM_OF_THREADS;
 
+	config->spNumOfDecodeThreads = DEFAULT_NUM_OF_DECODE_THREADS;
+	config->spNumOfExtractThreads = DEFAULT_NUM_OF_EXTRACT_THREADS;
+	config->spNumOfSearchThreads = DEFAULT_NUM_OF_SEARCH_THREADS;
+	config->spPipelineQueueSize = DEFAULT_PIPELINE_QUEUE_SIZE;
+	config->spNumOfServerThreads = DEFAULT_NUM_OF_SERVER_THREADS;
+	config->spEarlyTermination = DEFAULT_EARLY_TERMINATION;
+	config->spQueryCacheSize = DEFAULT_QUERY_CACHE_SIZE;
+	config->spQueryDeadline = DEFAULT_QUERY_DEADLINE;
+	config->spBinaryFeatures = DEFAULT_BINARY_FEATURES;
+	strcpy(config->spDatabaseFilename, DEFAULT_DATABASE_FILENAME);
+	config->spNumOfLoadThreads = DEFAULT_NUM_OF_LOAD_THREADS;
+	strcpy(config->spKDTreeSnapshotFilename, DEFAULT_KD_TREE_SNAPSHOT_FILENAME);
+	config->spMaxImageDimension = DEFAULT_MAX_IMAGE_DIMENSION;
+	config->spFeatureType = DEFAULT_FEATURE_TYPE;
+	strcpy(config->spExtractionManifestFilename, DEFAULT_EXTRACTION_MANIFEST_FILENAME);
+	strcpy(config->spCatalogueFilename, DEFAULT_CATALOGUE_FILENAME);
+	config->catalogue = NULL;
 	//str and int defaults:
 	strcpy(config->spImagesDirectory, DEFAULT_STR);
 	strcpy(config->spImagesPrefix, DEFAULT_STR);
@@ -557,6 +1050,9 @@ bool spConfigCheckVariablesInitialized(SPConfig config, FILE* fp, SP_CONFIG_MSG*
 		spConfigTerminate(config, fp, msg, SP_CONFIG_MISSING_DIR ,filename, lineNumber-1, 3, "spImagesDirectory");
 		return false;
 	}
+	if (config->spCatalogueFilename[0] != '\0') { // the catalogue names the images instead of the prefix and suffix
+		return spConfigLoadCatalogue(config, fp, msg, filename, lineNumber);
+	}
 	if (strcmp(config->spImagesPrefix, DEFAULT_STR) == 0) {
 		spConfigTerminate(config, fp, msg, SP_CONFIG_MISSING_PREFIX ,filename, lineNumber-1, 3, "spImagesPrefix");
 		return false;
@@ -572,6 +1068,28 @@ bool spConfigCheckVariablesInitialized(SPConfig config, FILE* fp, SP_CONFIG_MSG*
 	return true;
 }
 
+bool spConfigLoadCatalogue(SPConfig config, FILE* fp, SP_CONFIG_MSG* msg, const char* filename, int lineNumber) {
+	char cataloguePath[2*STR_MAX_LENGTH+1];
+	sprintf(cataloguePath, "%s%s", config->spImagesDirectory, config->spCatalogueFilename);
+	// the feats path of an image replaces its suffix, so it must fit as well
+	int catalogueLine = 0;
+	SP_IMAGE_CATALOGUE_MSG catalogueMsg;
+	config->catalogue = spImageCatalogueLoad(cataloguePath, config->spImagesDirectory,
+			STR_MAX_LENGTH - strlen(SP_CONFIG_FEATS_SUFFIX), &catalogueLine, &catalogueMsg);
+	if (config->catalogue == NULL) {
+		spConfigTerminate(config, fp, msg, (catalogueMsg == SP_IMAGE_CATALOGUE_OUT_OF_MEMORY) ? SP_CONFIG_ALLOC_FAIL
+				: SP_CONFIG_INVALID_CATALOGUE, cataloguePath, catalogueLine, 4, NULL);
+		return false;
+	}
+	int numOfImages = spImageCatalogueGetNumOfImages(config->catalogue);
+	if (config->spNumOfImages != DEFAULT_INT && config->spNumOfImages != numOfImages) {
+		spConfigTerminate(config, fp, msg, SP_CONFIG_INVALID_CATALOGUE, filename, lineNumber-1, 2, NULL);
+		return false;
+	}
+	config->spNumOfImages = numOfImages;
+	return true;
+}
+
 bool isNumber(char* num) {
     for (int i=0; num[i] != 0; i++) {
         //if (number[i] > '9' || number[i] < '0')
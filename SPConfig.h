@@ -16,6 +16,24 @@
 #define DEFAULT_KDT_SPLIT_METHOD MAX_SPREAD //check struct def here
 #define DEFAULT_LOGGER_LVL 3
 #define DEFAULT_LOGGER_FILENAME "stdout"
+#define DEFAULT_NUM_OF_THREADS 1
+#define DEFAULT_NUM_OF_DECODE_THREADS 1
+#define DEFAULT_NUM_OF_EXTRACT_THREADS 1
+#define DEFAULT_NUM_OF_SEARCH_THREADS 1
+#define DEFAULT_PIPELINE_QUEUE_SIZE 8
+#define DEFAULT_NUM_OF_SERVER_THREADS 4
+#define DEFAULT_EARLY_TERMINATION false
+#define DEFAULT_QUERY_CACHE_SIZE 0
+#define DEFAULT_QUERY_DEADLINE 0
+#define DEFAULT_BINARY_FEATURES false
+#define DEFAULT_DATABASE_FILENAME ""
+#define DEFAULT_KD_TREE_SNAPSHOT_FILENAME ""
+#define DEFAULT_NUM_OF_LOAD_THREADS 1
+#define DEFAULT_MAX_IMAGE_DIMENSION 0
+#define DEFAULT_FEATURE_TYPE SIFT_FEATURES
+#define ORB_FEATURE_DIM 16 //the 256 bits of an ORB descriptor, as 16-bit words
+#define DEFAULT_EXTRACTION_MANIFEST_FILENAME ""
+#define DEFAULT_CATALOGUE_FILENAME ""
 #define DEFAULT_INT 0
 #define DEFAULT_STR ""
 #define DEFAULT_CONFIG_FILE "spcbir.config"
@@ -35,6 +53,7 @@ typedef enum sp_config_msg_t {
 	SP_CONFIG_INVALID_STRING,
 	SP_CONFIG_INVALID_ARGUMENT,
 	SP_CONFIG_INDEX_OUT_OF_RANGE,
+	SP_CONFIG_INVALID_CATALOGUE,
 	SP_CONFIG_SUCCESS
 } SP_CONFIG_MSG;
 
@@ -46,6 +65,12 @@ typedef enum sp_kdtree_split_method {
 	INCREMENTAL
 } SP_KD_TREE_SPLIT_METHOD;
 
+/** A type used to decide the image features: SIFT reduced by the PCA, or binary ORB descriptors**/
+typedef enum sp_feature_type_t {
+	SIFT_FEATURES,
+	ORB_FEATURES
+} SP_FEATURE_TYPE;
+
 typedef struct sp_config_t* SPConfig;
 
 /**
@@ -68,7 +93,12 @@ typedef struct sp_config_t* SPConfig;
  * - SP_CONFIG_MISSING_PREFIX - if spImagesPrefix is missing
  * - SP_CONFIG_MISSING_SUFFIX - if spImagesSuffix is missing 
  * - SP_CONFIG_MISSING_NUM_IMAGES - if spNumOfImages is missing
+ * - SP_CONFIG_INVALID_CATALOGUE - if the image catalogue is invalid, or doesn't list spNumOfImages images
  * - SP_CONFIG_SUCCESS - in case of success
+ *
+ * If spCatalogueFilename is set, the images are those listed in the image catalogue (see
+ * SPImageCatalogue.h), which is loaded here. spImagesPrefix and spImagesSuffix are then not needed,
+ * and spNumOfImages, if set, must be the number of images in the catalogue.
  */
 SPConfig spConfigCreate(const char* filename, SP_CONFIG_MSG* msg);
 
@@ -152,6 +182,19 @@ int spConfigGetPCADim(const SPConfig config, SP_CONFIG_MSG* msg);
  */
 int spConfigGetKNN(const SPConfig config, SP_CONFIG_MSG* msg);
 
+/**
+ * Returns the number of worker threads used to search the query features. i.e the value of spNumOfThreads.
+ *
+ * @param config - the configuration structure
+ * @assert msg != NULL
+ * @param msg - pointer in which the msg returned by the function is stored
+ * @return positive integer in success, negative integer otherwise.
+ *
+ * - SP_CONFIG_INVALID_ARGUMENT - if config == NULL
+ * - SP_CONFIG_SUCCESS - in case of success
+ */
+int spConfigGetNumOfThreads(const SPConfig config, SP_CONFIG_MSG* msg);
+
 /**
  * Returns the number of the similar images. i.e the value of spNumOfSimilarImages.
  *
@@ -165,6 +208,188 @@ int spConfigGetKNN(const SPConfig config, SP_CONFIG_MSG* msg);
  */
 int spConfigGetNumOfSimilarImages(const SPConfig config, SP_CONFIG_MSG* msg);
 
+/**
+ * Returns the number of batch pipeline workers decoding the query images. i.e the value of spNumOfDecodeThreads.
+ *
+ * @param config - the configuration structure
+ * @assert msg != NULL
+ * @param msg - pointer in which the msg returned by the function is stored
+ * @return positive integer in success, negative integer otherwise.
+ *
+ * - SP_CONFIG_INVALID_ARGUMENT - if config == NULL
+ * - SP_CONFIG_SUCCESS - in case of success
+ */
+int spConfigGetNumOfDecodeThreads(const SPConfig config, SP_CONFIG_MSG* msg);
+
+/**
+ * Returns the number of workers extracting the SIFT features of the images and projecting them with
+ * the PCA, in the batch pipeline as well as in extraction mode and PCA training.
+ * i.e the value of spNumOfExtractThreads.
+ *
+ * @param config - the configuration structure
+ * @assert msg != NULL
+ * @param msg - pointer in which the msg returned by the function is stored
+ * @return positive integer in success, negative integer otherwise.
+ *
+ * - SP_CONFIG_INVALID_ARGUMENT - if config == NULL
+ * - SP_CONFIG_SUCCESS - in case of success
+ */
+int spConfigGetNumOfExtractThreads(const SPConfig config, SP_CONFIG_MSG* msg);
+
+/**
+ * Returns the number of batch pipeline workers searching the KNN of the query features and counting the
+ * feature hits. i.e the value of spNumOfSearchThreads.
+ *
+ * @param config - the configuration structure
+ * @assert msg != NULL
+ * @param msg - pointer in which the msg returned by the function is stored
+ * @return positive integer in success, negative integer otherwise.
+ *
+ * - SP_CONFIG_INVALID_ARGUMENT - if config == NULL
+ * - SP_CONFIG_SUCCESS - in case of success
+ */
+int spConfigGetNumOfSearchThreads(const SPConfig config, SP_CONFIG_MSG* msg);
+
+/**
+ * Returns the maximal number of queries waiting between two stages of the batch pipeline.
+ * i.e the value of spPipelineQueueSize.
+ *
+ * @param config - the configuration structure
+ * @assert msg != NULL
+ * @param msg - pointer in which the msg returned by the function is stored
+ * @return positive integer in success, negative integer otherwise.
+ *
+ * - SP_CONFIG_INVALID_ARGUMENT - if config == NULL
+ * - SP_CONFIG_SUCCESS - in case of success
+ */
+int spConfigGetPipelineQueueSize(const SPConfig config, SP_CONFIG_MSG* msg);
+
+/**
+ * Returns the number of client requests the query server (-s) serves concurrently.
+ * i.e the value of spNumOfServerThreads.
+ *
+ * @param config - the configuration structure
+ * @assert msg != NULL
+ * @param msg - pointer in which the msg returned by the function is stored
+ * @return positive integer in success, negative integer otherwise.
+ *
+ * - SP_CONFIG_INVALID_ARGUMENT - if config == NULL
+ * - SP_CONFIG_SUCCESS - in case of success
+ */
+int spConfigGetNumOfServerThreads(const SPConfig config, SP_CONFIG_MSG* msg);
+
+/**
+ * Returns true if spEarlyTermination = true, false otherwise.
+ * In early termination mode the search of the query features stops once the
+ * best spNumOfSimilarImages images can no longer change.
+ *
+ * @param config - the configuration structure
+ * @assert msg != NULL
+ * @param msg - pointer in which the msg returned by the function is stored
+ * @return true if spEarlyTermination = true, false otherwise.
+ *
+ * - SP_CONFIG_INVALID_ARGUMENT - if config == NULL
+ * - SP_CONFIG_SUCCESS - in case of success
+ */
+bool spConfigIsEarlyTermination(const SPConfig config, SP_CONFIG_MSG* msg);
+
+/**
+ * Returns the memory budget of the query cache in megabytes,
+ * i.e the value of spQueryCacheSize. 0 disables the cache.
+ *
+ * @param config - the configuration structure
+ * @assert msg != NULL
+ * @param msg - pointer in which the msg returned by the function is stored
+ * @return non-negative integer in success, negative integer otherwise.
+ *
+ * - SP_CONFIG_INVALID_ARGUMENT - if config == NULL
+ * - SP_CONFIG_SUCCESS - in case of success
+ */
+int spConfigGetQueryCacheSize(const SPConfig config, SP_CONFIG_MSG* msg);
+
+/**
+ * Returns the latency budget of each query in milliseconds,
+ * i.e the value of spQueryDeadline. 0 means no deadline.
+ *
+ * @param config - the configuration structure
+ * @assert msg != NULL
+ * @param msg - pointer in which the msg returned by the function is stored
+ * @return non-negative integer in success, negative integer otherwise.
+ *
+ * - SP_CONFIG_INVALID_ARGUMENT - if config == NULL
+ * - SP_CONFIG_SUCCESS - in case of success
+ */
+int spConfigGetQueryDeadline(const SPConfig config, SP_CONFIG_MSG* msg);
+
+/**
+ * Returns true if spBinaryFeatures = true, false otherwise.
+ * In extraction mode the feats files are then written in the binary format (see SPFeatsFile.h).
+ *
+ * @param config - the configuration structure
+ * @assert msg != NULL
+ * @param msg - pointer in which the msg returned by the function is stored
+ * @return true if spBinaryFeatures = true, false otherwise.
+ *
+ * - SP_CONFIG_INVALID_ARGUMENT - if config == NULL
+ * - SP_CONFIG_SUCCESS - in case of success
+ */
+bool spConfigIsBinaryFeatures(const SPConfig config, SP_CONFIG_MSG* msg);
+
+/**
+ * Returns the number of workers reading the feats files of the images in non-extraction mode.
+ * i.e the value of spNumOfLoadThreads.
+ *
+ * @param config - the configuration structure
+ * @assert msg != NULL
+ * @param msg - pointer in which the msg returned by the function is stored
+ * @return positive integer in success, negative integer otherwise.
+ *
+ * - SP_CONFIG_INVALID_ARGUMENT - if config == NULL
+ * - SP_CONFIG_SUCCESS - in case of success
+ */
+int spConfigGetNumOfLoadThreads(const SPConfig config, SP_CONFIG_MSG* msg);
+
+/**
+ * Returns the largest width or height of the images SIFT runs on, larger images are downscaled
+ * to it when decoded. i.e the value of spMaxImageDimension. 0 means the images aren't downscaled.
+ *
+ * @param config - the configuration structure
+ * @assert msg != NULL
+ * @param msg - pointer in which the msg returned by the function is stored
+ * @return non-negative integer in success, negative integer otherwise.
+ *
+ * - SP_CONFIG_INVALID_ARGUMENT - if config == NULL
+ * - SP_CONFIG_SUCCESS - in case of success
+ */
+int spConfigGetMaxImageDimension(const SPConfig config, SP_CONFIG_MSG* msg);
+
+/**
+ * Returns the type of the image features. i.e the value of spFeatureType.
+ *
+ * @param config - the configuration structure
+ * @assert msg != NULL
+ * @param msg - pointer in which the msg returned by the function is stored
+ * @return enum of type SP_FEATURE_TYPE, SIFT_FEATURES if config == NULL
+ *
+ * - SP_CONFIG_INVALID_ARGUMENT - if config == NULL
+ * - SP_CONFIG_SUCCESS - in case of success
+ */
+SP_FEATURE_TYPE spConfigGetFeatureType(const SPConfig config, SP_CONFIG_MSG* msg);
+
+/**
+ * Returns the dimension of the image features. i.e spPCADimension for SIFT features,
+ * and ORB_FEATURE_DIM for ORB features, whose coordinates are 16-bit words of the descriptor.
+ *
+ * @param config - the configuration structure
+ * @assert msg != NULL
+ * @param msg - pointer in which the msg returned by the function is stored
+ * @return positive integer in success, negative integer otherwise.
+ *
+ * - SP_CONFIG_INVALID_ARGUMENT - if config == NULL
+ * - SP_CONFIG_SUCCESS - in case of success
+ */
+int spConfigGetFeatureDim(const SPConfig config, SP_CONFIG_MSG* msg);
+
 /**
  * Given an index 'index' the function stores in imagePath the full path of the
  * ith image.
@@ -178,6 +403,7 @@ int spConfigGetNumOfSimilarImages(const SPConfig config, SP_CONFIG_MSG* msg);
  *  index = 10
  *
  * The functions stores "./images/img10.png" to the address given by imagePath.
+ * If spCatalogueFilename is set, the path of the image listed in the catalogue is stored instead.
  * Thus the address given by imagePath must contain enough space to
  * store the resulting string.
  *
@@ -211,6 +437,67 @@ SP_CONFIG_MSG spConfigGetImagePath(char* imagePath, const SPConfig config,
  */
 SP_CONFIG_MSG spConfigGetPCAPath(char* pcaPath, const SPConfig config);
 
+/**
+ * The function stores in databasePath the full path of the database file, in which
+ * the features of all images are kept in a single file (see SPFeatsFile.h).
+ * For example given the values of:
+ *  spImagesDirectory = "./images/"
+ *  spDatabaseFilename = "features.spdb"
+ *
+ * The functions stores "./images/features.spdb" to the address given by databasePath.
+ * If spDatabaseFilename isn't set, an empty string is stored, and the per-image feats files are used.
+ * Thus the address given by databasePath must contain enough space to
+ * store the resulting string.
+ *
+ * @param databasePath - an address to store the result in, it must contain enough space.
+ * @param config - the configuration structure
+ * @return
+ *  - SP_CONFIG_INVALID_ARGUMENT - if databasePath == NULL or config == NULL
+ *  - SP_CONFIG_SUCCESS - in case of success
+ */
+SP_CONFIG_MSG spConfigGetDatabasePath(char* databasePath, const SPConfig config);
+
+/**
+ * The function stores in manifestPath the full path of the extraction manifest file, which records
+ * the images the features were extracted from, so extraction mode only extracts the new or changed
+ * images (see SPExtractionManifest.h).
+ * For example given the values of:
+ *  spImagesDirectory = "./images/"
+ *  spExtractionManifestFilename = "images.spmf"
+ *
+ * The functions stores "./images/images.spmf" to the address given by manifestPath.
+ * If spExtractionManifestFilename isn't set, an empty string is stored, and every image is extracted.
+ * Thus the address given by manifestPath must contain enough space to
+ * store the resulting string.
+ *
+ * @param manifestPath - an address to store the result in, it must contain enough space.
+ * @param config - the configuration structure
+ * @return
+ *  - SP_CONFIG_INVALID_ARGUMENT - if manifestPath == NULL or config == NULL
+ *  - SP_CONFIG_SUCCESS - in case of success
+ */
+SP_CONFIG_MSG spConfigGetExtractionManifestPath(char* manifestPath, const SPConfig config);
+
+/**
+ * The function stores in snapshotPath the full path of the KD tree snapshot file, from which
+ * the KD tree is loaded instead of built (see SPKDTreeSnapshot.h).
+ * For example given the values of:
+ *  spImagesDirectory = "./images/"
+ *  spKDTreeSnapshotFilename = "tree.spkt"
+ *
+ * The functions stores "./images/tree.spkt" to the address given by snapshotPath.
+ * If spKDTreeSnapshotFilename isn't set, an empty string is stored, and the KD tree is always built.
+ * Thus the address given by snapshotPath must contain enough space to
+ * store the resulting string.
+ *
+ * @param snapshotPath - an address to store the result in, it must contain enough space.
+ * @param config - the configuration structure
+ * @return
+ *  - SP_CONFIG_INVALID_ARGUMENT - if snapshotPath == NULL or config == NULL
+ *  - SP_CONFIG_SUCCESS - in case of success
+ */
+SP_CONFIG_MSG spConfigGetKDTreeSnapshotPath(char* snapshotPath, const SPConfig config);
+
 /*
  * Returns the Logger Filename. i.e the value of spLoggerFileName.
  *
@@ -268,6 +555,8 @@ SP_KD_TREE_SPLIT_METHOD spConfigGetKDTreeSplitMethod(const SPConfig config,
  *  index = 10
  *
  * The functions stores "./images/img10.feats" to the address given by imagePath.
+ * If spCatalogueFilename is set, the path of the image listed in the catalogue is stored instead,
+ * with its suffix replaced by ".feats" (e.g. "./images/3f/img10.feats" for "./images/3f/img10.png").
  * Thus the address given by imagePath must contain enough space to
  * store the resulting string.
  *
@@ -305,9 +594,14 @@ void spConfigDestroy(SPConfig config);
  *  - Line: <the number of lines in the configuration file>
  *  - Message: Parameter <parameter name> is not set
  *
+ *  Case 4: if the image catalogue is invalid
+ * 	- File: <the catalogue filename>
+ *  - Line: <the number of the invalid line in the catalogue, 0 if it isn't a line's>
+ *  - Message: Invalid image catalogue
+ *
  * @param filename    	- A string representing the configuration filename
  * @param line			- The number of the invalid line in the configuration file
- * @param error_type	- Indicates the error message case={1,2,3}
+ * @param error_type	- Indicates the error message case={1,2,3,4}
  * @param param_name	- A string representing the parameter name in case 3, NULL in cases 1-2
  */
 void spConfigPrintError(const char* filename, int line, int error_type, char* param_name);
@@ -372,6 +666,19 @@ void spConfigSetDefaultValues(SPConfig config);
 bool spConfigCheckVariablesInitialized(SPConfig config, FILE* fp, SP_CONFIG_MSG* msg, const char* filename,
 		int lineNumber);
 
+/**
+ * Loads the image catalogue named by spCatalogueFilename, and sets spNumOfImages to its number of images.
+ *
+ * @param config 		- the configuration structure
+ * @param fp	 		- the pointer to the config file
+ * @param msg 			- pointer in which the msg returned by the function is stored
+ * @param filename 		- the configuration file name
+ * @param lineNumber 	- the line number which was read from the config file
+ *
+ * @return - True if the catalogue was loaded, False otherwise (config is then destroyed, see spConfigTerminate)
+ */
+bool spConfigLoadCatalogue(SPConfig config, FILE* fp, SP_CONFIG_MSG* msg, const char* filename, int lineNumber);
+
 /**
  * Checks if the string is a positive integer:
  * for every i: ('0' <= num[i] <= '9'), using isdigit function
@@ -0,0 +1,265 @@
+#define _POSIX_C_SOURCE 200809L
+#include "SPExtractionManifest.h"
+#include "SPBinaryUtil.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+#define MAGIC_SIZE 4
+#define ENTRY_RECORDED 1u
+#define HASH_CHUNK_SIZE 65536
+
+/**
+ * The source image of the features of an image.
+ */
+typedef struct sp_extraction_manifest_entry_t {
+	uint64_t pathHash;
+	uint64_t size;
+	int64_t mtimeSeconds;
+	uint32_t mtimeNanoseconds;
+	uint32_t flags;
+	uint64_t contentHash;
+} ManifestEntry;
+
+struct sp_extraction_manifest_t {
+	int numOfImages;
+	unsigned long long settingsHash;
+	ManifestEntry* entries;
+};
+
+SPExtractionManifest* spExtractionManifestCreate(int numOfImages, unsigned long long settingsHash) {
+	if (numOfImages <= 0) {
+		return NULL;
+	}
+	SPExtractionManifest* manifest = (SPExtractionManifest*) malloc(sizeof(*manifest));
+	if (manifest == NULL) { //Allocation failure
+		return NULL;
+	}
+	manifest->entries = (ManifestEntry*) calloc(numOfImages, sizeof(ManifestEntry));
+	if (manifest->entries == NULL) { //Allocation failure
+		free(manifest);
+		return NULL;
+	}
+	manifest->numOfImages = numOfImages;
+	manifest->settingsHash = settingsHash;
+	return manifest;
+}
+
+void spExtractionManifestDestroy(SPExtractionManifest* manifest) {
+	if (manifest == NULL) {
+		return;
+	}
+	free(manifest->entries);
+	free(manifest);
+}
+
+int spExtractionManifestGetNumOfImages(const SPExtractionManifest* manifest) {
+	return (manifest == NULL) ? -1 : manifest->numOfImages;
+}
+
+unsigned long long spExtractionManifestGetSettingsHash(const SPExtractionManifest* manifest) {
+	return (manifest == NULL) ? 0 : manifest->settingsHash;
+}
+
+SP_EXTRACTION_MANIFEST_MSG spExtractionManifestHashFile(const char* path, unsigned long long* hash) {
+	if (path==NULL || hash==NULL) {
+		return SP_EXTRACTION_MANIFEST_INVALID_ARGUMENT;
+	}
+	FILE* file = fopen(path, "rb");
+	if (file == NULL) {
+		return SP_EXTRACTION_MANIFEST_CANNOT_OPEN;
+	}
+	unsigned char* chunk = (unsigned char*) malloc(HASH_CHUNK_SIZE);
+	if (chunk == NULL) { //Allocation failure
+		fclose(file);
+		return SP_EXTRACTION_MANIFEST_OUT_OF_MEMORY;
+	}
+	unsigned long long contentHash = SP_BINARY_FNV64_OFFSET_BASIS;
+	size_t read;
+	while ((read = fread(chunk, 1, HASH_CHUNK_SIZE, file)) > 0) {
+		contentHash = spBinaryHashBytes(contentHash, chunk, read);
+	}
+	bool failed = ferror(file) != 0;
+	free(chunk);
+	fclose(file);
+	if (failed) {
+		return SP_EXTRACTION_MANIFEST_CANNOT_OPEN;
+	}
+	*hash = contentHash;
+	return SP_EXTRACTION_MANIFEST_SUCCESS;
+}
+
+unsigned long long spExtractionManifestSettingsHash(unsigned long long pcaHash, int pcaDim, int numOfFeatures,
+		bool binaryFeatures, int maxImageDimension) {
+	unsigned long long hash = SP_BINARY_FNV64_OFFSET_BASIS;
+	hash = spBinaryHashValue(hash, (uint64_t) pcaHash);
+	hash = spBinaryHashValue(hash, (uint64_t) pcaDim);
+	hash = spBinaryHashValue(hash, (uint64_t) numOfFeatures);
+	hash = spBinaryHashValue(hash, (uint64_t) binaryFeatures);
+	//full resolution images hash as before, so their manifests stay valid
+	if (maxImageDimension > 0) {
+		hash = spBinaryHashValue(hash, (uint64_t) maxImageDimension);
+	}
+	return hash;
+}
+
+SP_EXTRACTION_MANIFEST_MSG spExtractionManifestRecord(SPExtractionManifest* manifest, int imgIndex,
+		const char* imagePath, const SPExtractionManifest* previous) {
+	if (manifest==NULL || imagePath==NULL || imgIndex<0 || imgIndex>=manifest->numOfImages) {
+		return SP_EXTRACTION_MANIFEST_INVALID_ARGUMENT;
+	}
+	struct stat status;
+	if (stat(imagePath, &status) == -1) {
+		return SP_EXTRACTION_MANIFEST_CANNOT_OPEN;
+	}
+	ManifestEntry entry;
+	entry.pathHash = spBinaryHashBytes(SP_BINARY_FNV64_OFFSET_BASIS, (const unsigned char*) imagePath,
+			strlen(imagePath));
+	entry.size = (uint64_t) status.st_size;
+	entry.mtimeSeconds = (int64_t) status.st_mtim.tv_sec;
+	entry.mtimeNanoseconds = (uint32_t) status.st_mtim.tv_nsec;
+	entry.flags = ENTRY_RECORDED;
+
+	// the content is only hashed if the image may have changed
+	const ManifestEntry* old = (previous != NULL && imgIndex < previous->numOfImages)
+			? &previous->entries[imgIndex] : NULL;
+	if (old != NULL && (old->flags & ENTRY_RECORDED) && old->pathHash == entry.pathHash
+			&& old->size == entry.size && old->mtimeSeconds == entry.mtimeSeconds
+			&& old->mtimeNanoseconds == entry.mtimeNanoseconds) {
+		entry.contentHash = old->contentHash;
+	} else {
+		unsigned long long contentHash;
+		SP_EXTRACTION_MANIFEST_MSG msg = spExtractionManifestHashFile(imagePath, &contentHash);
+		if (msg != SP_EXTRACTION_MANIFEST_SUCCESS) {
+			return msg;
+		}
+		entry.contentHash = (uint64_t) contentHash;
+	}
+	manifest->entries[imgIndex] = entry;
+	return SP_EXTRACTION_MANIFEST_SUCCESS;
+}
+
+bool spExtractionManifestIsUnchanged(const SPExtractionManifest* manifest, const SPExtractionManifest* previous,
+		int imgIndex) {
+	if (manifest==NULL || previous==NULL || imgIndex<0 || imgIndex>=manifest->numOfImages
+			|| imgIndex>=previous->numOfImages || manifest->settingsHash != previous->settingsHash) {
+		return false;
+	}
+	const ManifestEntry* entry = &manifest->entries[imgIndex];
+	const ManifestEntry* old = &previous->entries[imgIndex];
+	return (entry->flags & ENTRY_RECORDED) && (old->flags & ENTRY_RECORDED) && entry->pathHash == old->pathHash
+			&& entry->size == old->size && entry->contentHash == old->contentHash;
+}
+
+SP_EXTRACTION_MANIFEST_MSG spExtractionManifestWrite(const char* path, const SPExtractionManifest* manifest) {
+	if (path==NULL || manifest==NULL) {
+		return SP_EXTRACTION_MANIFEST_INVALID_ARGUMENT;
+	}
+	size_t entriesSize = (size_t) manifest->numOfImages * SP_EXTRACTION_MANIFEST_ENTRY_SIZE;
+	size_t fileSize = SP_EXTRACTION_MANIFEST_HEADER_SIZE + entriesSize;
+	unsigned char* file = (unsigned char*) calloc(fileSize, 1);
+	if (file == NULL) { //Allocation failure
+		return SP_EXTRACTION_MANIFEST_OUT_OF_MEMORY;
+	}
+	unsigned char* entries = file + SP_EXTRACTION_MANIFEST_HEADER_SIZE;
+	for (int i=0; i<manifest->numOfImages; i++) {
+		const ManifestEntry* entry = &manifest->entries[i];
+		unsigned char* record = entries + (size_t) i * SP_EXTRACTION_MANIFEST_ENTRY_SIZE;
+		spBinaryWriteLE64(record, entry->pathHash);
+		spBinaryWriteLE64(record + 8, entry->size);
+		spBinaryWriteLE64(record + 16, (uint64_t) entry->mtimeSeconds);
+		spBinaryWriteLE32(record + 24, entry->mtimeNanoseconds);
+		spBinaryWriteLE32(record + 28, entry->flags);
+		spBinaryWriteLE64(record + 32, entry->contentHash);
+	}
+	memcpy(file, SP_EXTRACTION_MANIFEST_MAGIC, MAGIC_SIZE);
+	spBinaryWriteLE32(file + MAGIC_SIZE, SP_EXTRACTION_MANIFEST_VERSION);
+	spBinaryWriteLE32(file + MAGIC_SIZE + 4, (uint32_t) manifest->numOfImages);
+	spBinaryWriteLE64(file + MAGIC_SIZE + 8, (uint64_t) manifest->settingsHash);
+	spBinaryWriteLE32(file + MAGIC_SIZE + 16, spBinaryChecksum(SP_BINARY_FNV32_OFFSET_BASIS, entries, entriesSize));
+
+	FILE* out = fopen(path, "wb");
+	if (out == NULL) {
+		free(file);
+		return SP_EXTRACTION_MANIFEST_CANNOT_OPEN;
+	}
+	SP_EXTRACTION_MANIFEST_MSG msg = SP_EXTRACTION_MANIFEST_SUCCESS;
+	if (fwrite(file, 1, fileSize, out) != fileSize) {
+		msg = SP_EXTRACTION_MANIFEST_WRITE_ERROR;
+	}
+	free(file);
+	if (fclose(out) != 0) {
+		msg = SP_EXTRACTION_MANIFEST_WRITE_ERROR;
+	}
+	if (msg != SP_EXTRACTION_MANIFEST_SUCCESS) { // never leaving a partial manifest behind
+		remove(path);
+	}
+	return msg;
+}
+
+SPExtractionManifest* spExtractionManifestRead(const char* path, SP_EXTRACTION_MANIFEST_MSG* msg) {
+	if (msg == NULL) {
+		return NULL;
+	}
+	if (path == NULL) {
+		*msg = SP_EXTRACTION_MANIFEST_INVALID_ARGUMENT;
+		return NULL;
+	}
+	FILE* in = fopen(path, "rb");
+	if (in == NULL) {
+		*msg = SP_EXTRACTION_MANIFEST_CANNOT_OPEN;
+		return NULL;
+	}
+	unsigned char header[SP_EXTRACTION_MANIFEST_HEADER_SIZE];
+	if (fread(header, 1, SP_EXTRACTION_MANIFEST_HEADER_SIZE, in) != SP_EXTRACTION_MANIFEST_HEADER_SIZE) {
+		*msg = SP_EXTRACTION_MANIFEST_CORRUPTED;
+		fclose(in);
+		return NULL;
+	}
+	uint32_t version = spBinaryReadLE32(header + MAGIC_SIZE);
+	uint32_t numOfImages = spBinaryReadLE32(header + MAGIC_SIZE + 4);
+	uint64_t settingsHash = spBinaryReadLE64(header + MAGIC_SIZE + 8);
+	uint32_t fileChecksum = spBinaryReadLE32(header + MAGIC_SIZE + 16);
+	if (memcmp(header, SP_EXTRACTION_MANIFEST_MAGIC, MAGIC_SIZE) != 0 || version != SP_EXTRACTION_MANIFEST_VERSION
+			|| numOfImages == 0 || numOfImages > INT32_MAX) {
+		*msg = SP_EXTRACTION_MANIFEST_INVALID_FORMAT;
+		fclose(in);
+		return NULL;
+	}
+
+	// reading the entries, and making sure nothing follows them
+	size_t entriesSize = (size_t) numOfImages * SP_EXTRACTION_MANIFEST_ENTRY_SIZE;
+	unsigned char* entries = (unsigned char*) malloc(entriesSize + 1);
+	SPExtractionManifest* manifest = spExtractionManifestCreate((int) numOfImages, settingsHash);
+	if (entries == NULL || manifest == NULL) { //Allocation failure
+		*msg = SP_EXTRACTION_MANIFEST_OUT_OF_MEMORY;
+		free(entries);
+		spExtractionManifestDestroy(manifest);
+		fclose(in);
+		return NULL;
+	}
+	size_t read = fread(entries, 1, entriesSize + 1, in);
+	fclose(in);
+	if (read != entriesSize
+			|| spBinaryChecksum(SP_BINARY_FNV32_OFFSET_BASIS, entries, entriesSize) != fileChecksum) {
+		*msg = SP_EXTRACTION_MANIFEST_CORRUPTED;
+		free(entries);
+		spExtractionManifestDestroy(manifest);
+		return NULL;
+	}
+	for (uint32_t i=0; i<numOfImages; i++) {
+		const unsigned char* record = entries + (size_t) i * SP_EXTRACTION_MANIFEST_ENTRY_SIZE;
+		ManifestEntry* entry = &manifest->entries[i];
+		entry->pathHash = spBinaryReadLE64(record);
+		entry->size = spBinaryReadLE64(record + 8);
+		entry->mtimeSeconds = (int64_t) spBinaryReadLE64(record + 16);
+		entry->mtimeNanoseconds = spBinaryReadLE32(record + 24);
+		entry->flags = spBinaryReadLE32(record + 28);
+		entry->contentHash = spBinaryReadLE64(record + 32);
+	}
+	free(entries);
+	*msg = SP_EXTRACTION_MANIFEST_SUCCESS;
+	return manifest;
+}
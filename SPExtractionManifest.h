@@ -0,0 +1,182 @@
+#ifndef SPEXTRACTIONMANIFEST_H_
+#define SPEXTRACTIONMANIFEST_H_
+
+#include <stdbool.h>
+
+/**
+ * SP Extraction Manifest summary
+ * Records the source image of the features of each image - the hash of its path, its size, its
+ * modification time and the hash (64-bit FNV-1a) of its content - together with a hash of the
+ * settings the features were extracted with. Comparing the manifest of the previous extraction
+ * with the images as they are now tells which images are new or changed, so only they are
+ * extracted again, and the features of the others are reused.
+ *
+ * The content of an image is only hashed when its size or modification time differ from the
+ * previous manifest, so an unchanged catalogue costs one stat per image.
+ *
+ * The manifest file is made of a header and an entry per image. The header is the magic "SPMF"
+ * and seven little-endian 32-bit unsigned integers: version, number of images, the low and high
+ * halves of the settings hash, a checksum (32-bit FNV-1a) of the entries, and two reserved zeros.
+ * Each entry is the path hash, the size and the modification time in seconds as little-endian
+ * 64-bit integers, the nanoseconds of the modification time and the flags (1 if the entry was
+ * recorded) as little-endian 32-bit unsigned integers, and the content hash as a little-endian
+ * 64-bit integer.
+ *
+ * The following functions are supported:
+ *
+ * spExtractionManifestCreate			- Creates a new manifest with no recorded image
+ * spExtractionManifestDestroy			- Free all resources associated with a manifest
+ * spExtractionManifestGetNumOfImages	- A getter of the number of images
+ * spExtractionManifestGetSettingsHash	- A getter of the settings hash
+ * spExtractionManifestHashFile			- Hashes the content of a file
+ * spExtractionManifestSettingsHash		- Hashes the settings the features are extracted with
+ * spExtractionManifestRecord			- Records the source image of an image
+ * spExtractionManifestIsUnchanged		- Checks whether an image is unchanged since a previous manifest
+ * spExtractionManifestWrite			- Saves a manifest
+ * spExtractionManifestRead				- Loads a manifest
+ */
+
+#define SP_EXTRACTION_MANIFEST_MAGIC "SPMF"
+#define SP_EXTRACTION_MANIFEST_VERSION 1
+#define SP_EXTRACTION_MANIFEST_HEADER_SIZE 32
+#define SP_EXTRACTION_MANIFEST_ENTRY_SIZE 40
+
+/** type used to define the manifest **/
+typedef struct sp_extraction_manifest_t SPExtractionManifest;
+
+/** type for error reporting **/
+typedef enum sp_extraction_manifest_msg_t {
+	SP_EXTRACTION_MANIFEST_CANNOT_OPEN,
+	SP_EXTRACTION_MANIFEST_INVALID_FORMAT,		// not a manifest, or an unsupported version
+	SP_EXTRACTION_MANIFEST_CORRUPTED,			// the file is truncated, or its checksum doesn't match
+	SP_EXTRACTION_MANIFEST_WRITE_ERROR,
+	SP_EXTRACTION_MANIFEST_OUT_OF_MEMORY,
+	SP_EXTRACTION_MANIFEST_INVALID_ARGUMENT,
+	SP_EXTRACTION_MANIFEST_SUCCESS
+} SP_EXTRACTION_MANIFEST_MSG;
+
+/**
+ * Allocates a new manifest in the memory, for numOfImages images, none of them recorded yet.
+ *
+ * @param numOfImages 	- the number of images
+ * @param settingsHash 	- the hash of the settings the features are extracted with
+ * 						  (see spExtractionManifestSettingsHash)
+ *
+ * @return
+ * NULL in case allocation failure occurred OR numOfImages <= 0
+ * Otherwise, the new manifest is returned
+ */
+SPExtractionManifest* spExtractionManifestCreate(int numOfImages, unsigned long long settingsHash);
+
+/**
+ * Frees all memory allocation associated with the manifest.
+ * If manifest is NULL nothing happens.
+ */
+void spExtractionManifestDestroy(SPExtractionManifest* manifest);
+
+/**
+ * A getter of the number of images of the manifest.
+ *
+ * @return
+ * -1 if manifest == NULL, otherwise the number of images
+ */
+int spExtractionManifestGetNumOfImages(const SPExtractionManifest* manifest);
+
+/**
+ * A getter of the settings hash of the manifest.
+ *
+ * @return
+ * 0 if manifest == NULL, otherwise the settings hash
+ */
+unsigned long long spExtractionManifestGetSettingsHash(const SPExtractionManifest* manifest);
+
+/**
+ * Hashes (64-bit FNV-1a) the content of a file, read in chunks.
+ *
+ * @param path 	- the path of the file
+ * @param hash 	- pointer in which the hash is stored
+ *
+ * @return
+ * SP_EXTRACTION_MANIFEST_INVALID_ARGUMENT if path==NULL or hash==NULL
+ * SP_EXTRACTION_MANIFEST_CANNOT_OPEN if the file couldn't be read
+ * SP_EXTRACTION_MANIFEST_OUT_OF_MEMORY in case of allocation failure
+ * SP_EXTRACTION_MANIFEST_SUCCESS otherwise
+ */
+SP_EXTRACTION_MANIFEST_MSG spExtractionManifestHashFile(const char* path, unsigned long long* hash);
+
+/**
+ * Hashes (64-bit FNV-1a) the settings the features are extracted with, so the features of
+ * unchanged images are only reused if they would be extracted the same way.
+ *
+ * @param pcaHash 		 - the hash of the content of the PCA file (see spExtractionManifestHashFile)
+ * @param pcaDim 		 - spPCADimension from the config
+ * @param numOfFeatures	 - spNumOfFeatures from the config
+ * @param binaryFeatures - spBinaryFeatures from the config
+ * @param maxImageDimension - spMaxImageDimension from the config, 0 hashes as the settings without it
+ *
+ * @return the settings hash
+ */
+unsigned long long spExtractionManifestSettingsHash(unsigned long long pcaHash, int pcaDim, int numOfFeatures,
+		bool binaryFeatures, int maxImageDimension);
+
+/**
+ * Records the source image of an image: its path hash, size, modification time and content hash.
+ * If the previous manifest recorded the same path, size and modification time for the image, its
+ * content hash is taken from there, otherwise the content of the image is hashed.
+ *
+ * @param manifest 	- the manifest to record the image in
+ * @param imgIndex 	- the index of the image
+ * @param imagePath - the path of the image
+ * @param previous 	- the manifest of the previous extraction, or NULL
+ *
+ * @return
+ * SP_EXTRACTION_MANIFEST_INVALID_ARGUMENT if manifest==NULL or imagePath==NULL or imgIndex is out of range
+ * SP_EXTRACTION_MANIFEST_CANNOT_OPEN if the image couldn't be read
+ * SP_EXTRACTION_MANIFEST_OUT_OF_MEMORY in case of allocation failure
+ * SP_EXTRACTION_MANIFEST_SUCCESS otherwise
+ */
+SP_EXTRACTION_MANIFEST_MSG spExtractionManifestRecord(SPExtractionManifest* manifest, int imgIndex,
+		const char* imagePath, const SPExtractionManifest* previous);
+
+/**
+ * Checks whether an image recorded in the manifest is unchanged since the previous manifest -
+ * both recorded it, with the same path, size and content hash, and the same settings hash.
+ * A change of the modification time alone doesn't count as a change.
+ *
+ * @param manifest 	- the manifest the image was recorded in
+ * @param previous 	- the manifest of the previous extraction, or NULL
+ * @param imgIndex 	- the index of the image
+ *
+ * @return
+ * true if the image is unchanged, false otherwise (or in case of invalid arguments)
+ */
+bool spExtractionManifestIsUnchanged(const SPExtractionManifest* manifest, const SPExtractionManifest* previous,
+		int imgIndex);
+
+/**
+ * Saves the manifest to a file, replacing it if it exists.
+ *
+ * @param path 		- the path of the manifest file
+ * @param manifest 	- the manifest
+ *
+ * @return
+ * SP_EXTRACTION_MANIFEST_INVALID_ARGUMENT if path==NULL or manifest==NULL
+ * SP_EXTRACTION_MANIFEST_OUT_OF_MEMORY in case of allocation failure
+ * SP_EXTRACTION_MANIFEST_CANNOT_OPEN or SP_EXTRACTION_MANIFEST_WRITE_ERROR if the file couldn't be written
+ * SP_EXTRACTION_MANIFEST_SUCCESS otherwise
+ */
+SP_EXTRACTION_MANIFEST_MSG spExtractionManifestWrite(const char* path, const SPExtractionManifest* manifest);
+
+/**
+ * Loads a manifest from a file, verifying its header and checksum.
+ *
+ * @param path 	- the path of the manifest file
+ * @param msg 	- pointer in which the msg returned by the function is stored
+ *
+ * @return
+ * NULL in case of failure (see msg)
+ * Otherwise, the loaded manifest
+ */
+SPExtractionManifest* spExtractionManifestRead(const char* path, SP_EXTRACTION_MANIFEST_MSG* msg);
+
+#endif /* SPEXTRACTIONMANIFEST_H_ */
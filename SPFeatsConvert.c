@@ -0,0 +1,128 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SPFeatsFile.h"
+
+/**
+ * Converts text ".feats" files to the binary format, in place:
+ *
+ * SPFeatsConvert <dim> <feats file>...
+ *
+ * <dim> is spPCADimension of the config the files were extracted with. Files which are already
+ * binary are skipped. Each file is replaced only once its binary version was completely written.
+ *
+ * Or gathers the feats files (of either format) into a single database file, the i-th file
+ * holding the features of image i:
+ *
+ * SPFeatsConvert <dim> -d <database file> <feats file>...
+ */
+
+#define USAGE "Usage: %s <dim> [-d <database file>] <feats file>...\n"
+#define DATABASE_OPTION "-d"
+#define TEMP_SUFFIX ".tmp"
+
+/**
+ * Converts a single text feats file to the binary format.
+ *
+ * @return 0 on success, -1 otherwise
+ */
+static int convertFile(const char* path, int dim) {
+	if (spFeatsFileIsBinary(path)) {
+		printf("%s - already binary\n", path);
+		return 0;
+	}
+	SP_FEATS_FILE_MSG msg;
+	int numOfFeatures = 0;
+	SPPoint** features = spFeatsFileReadText(path, 0, dim, &numOfFeatures, &msg);
+	if (msg != SP_FEATS_FILE_SUCCESS) {
+		fprintf(stderr, "%s - couldn't be read\n", path);
+		return -1;
+	}
+
+	char* tempPath = (char*) malloc(strlen(path) + strlen(TEMP_SUFFIX) + 1);
+	if (tempPath == NULL) {
+		fprintf(stderr, "%s - allocation failure\n", path);
+		msg = SP_FEATS_FILE_OUT_OF_MEMORY;
+	} else {
+		sprintf(tempPath, "%s%s", path, TEMP_SUFFIX);
+		msg = spFeatsFileWriteBinary(tempPath, features, numOfFeatures, dim);
+		if (msg != SP_FEATS_FILE_SUCCESS || rename(tempPath, path) != 0) {
+			fprintf(stderr, "%s - couldn't be written\n", path);
+			remove(tempPath);
+			msg = SP_FEATS_FILE_WRITE_ERROR;
+		}
+	}
+	for (int i=0; i<numOfFeatures; i++) {
+		spPointDestroy(features[i]);
+	}
+	free(features);
+	free(tempPath);
+	if (msg != SP_FEATS_FILE_SUCCESS) {
+		return -1;
+	}
+	printf("%s - %d features converted\n", path, numOfFeatures);
+	return 0;
+}
+
+/**
+ * Writes the features of the feats files, in order, to a single database file.
+ *
+ * @return 0 on success, -1 otherwise
+ */
+static int buildDatabase(const char* databasePath, char* paths[], int numOfImages, int dim) {
+	SPFeatureStore* store = spFeatureStoreCreate(numOfImages);
+	if (store == NULL) {
+		fprintf(stderr, "%s - allocation failure\n", databasePath);
+		return -1;
+	}
+	SP_FEATS_FILE_MSG msg = SP_FEATS_FILE_SUCCESS;
+	for (int i=0; i<numOfImages && msg==SP_FEATS_FILE_SUCCESS; i++) {
+		int numOfFeatures = 0;
+		SPPoint** features = spFeatsFileRead(paths[i], i, dim, &numOfFeatures, &msg);
+		if (msg != SP_FEATS_FILE_SUCCESS) {
+			fprintf(stderr, "%s - couldn't be read\n", paths[i]);
+		} else if (spFeatureStoreAddImage(store, i, features, numOfFeatures) != SP_FEATURE_STORE_SUCCESS) {
+			fprintf(stderr, "%s - allocation failure\n", paths[i]);
+			for (int j=0; j<numOfFeatures; j++) {
+				spPointDestroy(features[j]);
+			}
+			free(features);
+			msg = SP_FEATS_FILE_OUT_OF_MEMORY;
+		}
+	}
+	if (msg == SP_FEATS_FILE_SUCCESS) {
+		msg = spFeatsFileWriteDatabase(databasePath, store, dim);
+		if (msg != SP_FEATS_FILE_SUCCESS) {
+			fprintf(stderr, "%s - couldn't be written\n", databasePath);
+			remove(databasePath);
+		}
+	}
+	if (msg == SP_FEATS_FILE_SUCCESS) {
+		printf("%s - %d images, %d features written\n", databasePath, numOfImages, spFeatureStoreGetSize(store));
+	}
+	spFeatureStoreDestroy(store);
+	return (msg == SP_FEATS_FILE_SUCCESS) ? 0 : -1;
+}
+
+int main(int argc, char* argv[]) {
+	int dim = (argc > 2) ? atoi(argv[1]) : 0;
+	if (dim <= 0) {
+		printf(USAGE, argv[0]);
+		return -1;
+	}
+	if (strcmp(argv[2], DATABASE_OPTION) == 0) {
+		if (argc < 5) {
+			printf(USAGE, argv[0]);
+			return -1;
+		}
+		return buildDatabase(argv[3], argv + 4, argc - 4, dim);
+	}
+	int result = 0;
+	for (int i=2; i<argc; i++) {
+		if (convertFile(argv[i], dim) != 0) {
+			result = -1;
+		}
+	}
+	return result;
+}
@@ -0,0 +1,548 @@
+#define _POSIX_C_SOURCE 200809L
+#include "SPFeatsFile.h"
+#include "SPBinaryUtil.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define MAGIC_SIZE 4
+#define MAX_EXACT_DIGITS 15 // any integer of up to 15 digits is exact in a double
+#define MAX_EXACT_POWER 22 // 10^22 is the largest power of 10 exact in a double
+
+static const double powersOf10[MAX_EXACT_POWER+1] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * Checks whether the host stores integers and floats in little-endian byte order.
+ */
+static bool isLittleEndianHost() {
+	uint32_t one = 1;
+	return *((unsigned char*) &one) == 1;
+}
+
+/**
+ * Maps the whole file to memory for sequential reading.
+ *
+ * @return
+ * NULL if the file couldn't be opened or mapped, or is empty
+ * Otherwise, the mapping, of <*size> bytes
+ */
+static const unsigned char* mapFile(const char* path, size_t* size) {
+	int fd = open(path, O_RDONLY);
+	if (fd == -1) {
+		return NULL;
+	}
+	struct stat status;
+	if (fstat(fd, &status) == -1 || status.st_size <= 0) {
+		close(fd);
+		return NULL;
+	}
+	*size = (size_t) status.st_size;
+	void* file = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // the mapping stays valid
+	if (file == MAP_FAILED) {
+		return NULL;
+	}
+	posix_madvise(file, *size, POSIX_MADV_SEQUENTIAL);
+	return (const unsigned char*) file;
+}
+
+/**
+ * Creates the feature <i> of a block of little-endian floats.
+ *
+ * @param block - the block of the features
+ * @param i 	- the index of the feature in the block
+ * @param dim 	- the dimension of the features
+ * @param data 	- a buffer of <dim> doubles
+ * @param index - the index of the created feature
+ *
+ * @return NULL in case of allocation failure, otherwise the feature
+ */
+static SPPoint* createFeature(const unsigned char* block, size_t i, int dim, double* data, int index) {
+	bool littleEndian = isLittleEndianHost();
+	for (int j=0; j<dim; j++) {
+		const unsigned char* value = block + (i*dim + j) * sizeof(float);
+		float coor;
+		if (littleEndian) {
+			memcpy(&coor, value, sizeof(float));
+		} else {
+			uint32_t bits = spBinaryReadLE32(value);
+			memcpy(&coor, &bits, sizeof(float));
+		}
+		data[j] = coor;
+	}
+	return spPointCreate(data, dim, index);
+}
+
+/**
+ * Writes the features as little-endian floats, continuing the checksum of the file.
+ *
+ * @return false if writing failed, true otherwise
+ */
+static bool writeFeatures(FILE* file, SPPoint** features, int numOfFeatures, int dim, uint32_t* hash) {
+	unsigned char value[sizeof(float)];
+	for (int i=0; i<numOfFeatures; i++) {
+		for (int j=0; j<dim; j++) {
+			float coor = (float) spPointGetAxisCoor(features[i], j);
+			uint32_t bits;
+			memcpy(&bits, &coor, sizeof(float));
+			spBinaryWriteLE32(value, bits);
+			*hash = spBinaryChecksum(*hash, value, sizeof(float));
+			if (fwrite(value, 1, sizeof(float), file) != sizeof(float)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * Reads the whole file to a NUL-terminated buffer, in a single read where possible.
+ *
+ * @return NULL if the file couldn't be opened, read or allocated for, otherwise the buffer
+ */
+static char* readFile(const char* path) {
+	int fd = open(path, O_RDONLY);
+	if (fd == -1) {
+		return NULL;
+	}
+	struct stat status;
+	char* buffer = NULL;
+	if (fstat(fd, &status) == 0 && status.st_size >= 0) {
+		buffer = (char*) malloc((size_t) status.st_size + 1);
+	}
+	size_t size = 0;
+	while (buffer != NULL && size < (size_t) status.st_size) {
+		ssize_t bytes = read(fd, buffer + size, (size_t) status.st_size - size);
+		if (bytes <= 0) { // a read error, or the file was truncated meanwhile
+			if (bytes < 0) {
+				free(buffer);
+				buffer = NULL;
+			}
+			break;
+		}
+		size += (size_t) bytes;
+	}
+	close(fd);
+	if (buffer != NULL) {
+		buffer[size] = '\0';
+	}
+	return buffer;
+}
+
+/**
+ * The white-space characters skipped by a " " of fscanf in the "C" locale.
+ */
+static bool isSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static bool isDigit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+/**
+ * Parses an int, as " %d" of fscanf does.
+ *
+ * @return NULL if no int (or an int too large) is found, otherwise the end of the int
+ */
+static const char* parseInt(const char* s, int* value) {
+	while (isSpace(*s)) {
+		s++;
+	}
+	bool negative = (*s == '-');
+	if (*s == '-' || *s == '+') {
+		s++;
+	}
+	if (!isDigit(*s)) {
+		return NULL;
+	}
+	long long result = 0;
+	for (; isDigit(*s); s++) {
+		result = result*10 + (*s - '0');
+		if (result > INT_MAX) {
+			return NULL;
+		}
+	}
+	*value = (int) (negative ? -result : result);
+	return s;
+}
+
+/**
+ * Parses a double, as " %lf" of fscanf does.
+ * The plain decimals the feats files are written with, of up to MAX_EXACT_DIGITS significant
+ * digits and a power of 10 up to MAX_EXACT_POWER, are converted by a single exact multiplication
+ * or division, which is correctly rounded just as strtod is. Any other number is left to strtod.
+ *
+ * @return NULL if no double is found, otherwise the end of the double
+ */
+static const char* parseDouble(const char* s, double* value) {
+	while (isSpace(*s)) {
+		s++;
+	}
+	const char* p = s;
+	bool negative = (*p == '-');
+	if (*p == '-' || *p == '+') {
+		p++;
+	}
+	uint64_t mantissa = 0;
+	int digits = 0, significantDigits = 0, exponent = 0;
+	for (; isDigit(*p); p++, digits++) {
+		mantissa = mantissa*10 + (*p - '0');
+		significantDigits += (mantissa != 0);
+		if (significantDigits > MAX_EXACT_DIGITS) {
+			break;
+		}
+	}
+	if (*p == '.') {
+		for (p++; isDigit(*p); p++, digits++, exponent--) {
+			mantissa = mantissa*10 + (*p - '0');
+			significantDigits += (mantissa != 0);
+			if (significantDigits > MAX_EXACT_DIGITS) {
+				break;
+			}
+		}
+	}
+	if ((*p == 'e' || *p == 'E') && digits > 0) {
+		const char* e = p + 1;
+		bool negativeExponent = (*e == '-');
+		if (*e == '-' || *e == '+') {
+			e++;
+		}
+		int power = 0;
+		for (; isDigit(*e) && power <= MAX_EXACT_POWER*2; e++) {
+			power = power*10 + (*e - '0');
+		}
+		if (e != p + 1 && isDigit(e[-1])) {
+			exponent += negativeExponent ? -power : power;
+			p = e;
+		}
+	}
+	if (digits == 0 || significantDigits > MAX_EXACT_DIGITS || isDigit(*p) || *p == 'x' || *p == 'X'
+			|| exponent < -MAX_EXACT_POWER || exponent > MAX_EXACT_POWER) { // not a plain exact decimal
+		char* end = NULL;
+		*value = strtod(s, &end);
+		return (end == s) ? NULL : end;
+	}
+	double result = (double) mantissa;
+	result = (exponent < 0) ? result / powersOf10[-exponent] : result * powersOf10[exponent];
+	*value = negative ? -result : result;
+	return p;
+}
+
+/**
+ * Destroys the first n features, and the array itself.
+ */
+static void destroyFeatures(SPPoint** features, int n) {
+	for (int i=0; i<n; i++) {
+		spPointDestroy(features[i]);
+	}
+	free(features);
+}
+
+bool spFeatsFileIsBinary(const char* path) {
+	if (path == NULL) {
+		return false;
+	}
+	FILE* file = fopen(path, "rb");
+	if (file == NULL) {
+		return false;
+	}
+	char magic[MAGIC_SIZE];
+	bool isBinary = fread(magic, 1, MAGIC_SIZE, file) == MAGIC_SIZE
+			&& memcmp(magic, SP_FEATS_FILE_MAGIC, MAGIC_SIZE) == 0;
+	fclose(file);
+	return isBinary;
+}
+
+SPPoint** spFeatsFileRead(const char* path, int imgIndex, int dim, int* numOfFeatures, SP_FEATS_FILE_MSG* msg) {
+	if (spFeatsFileIsBinary(path)) {
+		return spFeatsFileReadBinary(path, imgIndex, dim, numOfFeatures, msg);
+	}
+	return spFeatsFileReadText(path, imgIndex, dim, numOfFeatures, msg);
+}
+
+SPPoint** spFeatsFileReadText(const char* path, int imgIndex, int dim, int* numOfFeatures, SP_FEATS_FILE_MSG* msg) {
+	if (msg == NULL) {
+		return NULL;
+	}
+	if (path==NULL || imgIndex<0 || dim<=0 || numOfFeatures==NULL) {
+		*msg = SP_FEATS_FILE_INVALID_ARGUMENT;
+		return NULL;
+	}
+	char* file = readFile(path);
+	if (file == NULL) {
+		*msg = SP_FEATS_FILE_CANNOT_OPEN;
+		return NULL;
+	}
+
+	// the number of features is in the first line
+	const char* next = parseInt(file, numOfFeatures);
+	if (next == NULL || *numOfFeatures < 0) {
+		*msg = SP_FEATS_FILE_INVALID_COUNT;
+		free(file);
+		return NULL;
+	}
+
+	// never empty, so a file without features isn't mistaken for a failure
+	SPPoint** features = (SPPoint**) malloc((*numOfFeatures > 0 ? *numOfFeatures : 1)*sizeof(SPPoint*));
+	double* data = (double*) malloc(dim*sizeof(double));
+	if (features==NULL || data==NULL) { //Allocation failure
+		*msg = SP_FEATS_FILE_OUT_OF_MEMORY;
+		free(features);
+		free(data);
+		free(file);
+		return NULL;
+	}
+	for (int i=0; i<(*numOfFeatures); i++) {
+		for (int j=0; j<dim; j++) {
+			next = parseDouble(next, data+j);
+			if (next == NULL) {
+				*msg = SP_FEATS_FILE_INVALID_FORMAT;
+				destroyFeatures(features, i);
+				free(data);
+				free(file);
+				return NULL;
+			}
+		}
+		features[i] = spPointCreate(data, dim, imgIndex);
+		if (features[i] == NULL) { //Allocation failure
+			*msg = SP_FEATS_FILE_OUT_OF_MEMORY;
+			destroyFeatures(features, i);
+			free(data);
+			free(file);
+			return NULL;
+		}
+	}
+	free(data);
+	free(file);
+	*msg = SP_FEATS_FILE_SUCCESS;
+	return features;
+}
+
+SPPoint** spFeatsFileReadBinary(const char* path, int imgIndex, int dim, int* numOfFeatures,
+		SP_FEATS_FILE_MSG* msg) {
+	if (msg == NULL) {
+		return NULL;
+	}
+	if (path==NULL || imgIndex<0 || dim<=0 || numOfFeatures==NULL) {
+		*msg = SP_FEATS_FILE_INVALID_ARGUMENT;
+		return NULL;
+	}
+	size_t fileSize = 0;
+	const unsigned char* file = mapFile(path, &fileSize);
+	if (file == NULL) {
+		*msg = SP_FEATS_FILE_CANNOT_OPEN;
+		return NULL;
+	}
+
+	// verifying the header, and that the feature block is complete and intact
+	*msg = SP_FEATS_FILE_SUCCESS;
+	if (fileSize < SP_FEATS_FILE_HEADER_SIZE) {
+		*msg = SP_FEATS_FILE_CORRUPTED;
+		munmap((void*) file, fileSize);
+		return NULL;
+	}
+	uint32_t version = spBinaryReadLE32(file + MAGIC_SIZE);
+	uint32_t fileDim = spBinaryReadLE32(file + MAGIC_SIZE + 4);
+	uint32_t count = spBinaryReadLE32(file + MAGIC_SIZE + 8);
+	uint32_t dtype = spBinaryReadLE32(file + MAGIC_SIZE + 12);
+	uint32_t fileChecksum = spBinaryReadLE32(file + MAGIC_SIZE + 16);
+	const unsigned char* block = file + SP_FEATS_FILE_HEADER_SIZE;
+	size_t blockSize = (size_t) count * fileDim * sizeof(float);
+	if (memcmp(file, SP_FEATS_FILE_MAGIC, MAGIC_SIZE) != 0 || version != SP_FEATS_FILE_VERSION
+			|| dtype != SP_FEATS_FILE_DTYPE_FLOAT32 || fileDim != (uint32_t) dim || count > INT32_MAX) {
+		*msg = SP_FEATS_FILE_INVALID_FORMAT;
+	} else if (fileSize - SP_FEATS_FILE_HEADER_SIZE != blockSize
+			|| spBinaryChecksum(SP_BINARY_FNV32_OFFSET_BASIS, block, blockSize) != fileChecksum) {
+		*msg = SP_FEATS_FILE_CORRUPTED;
+	}
+	if (*msg != SP_FEATS_FILE_SUCCESS) {
+		*numOfFeatures = 0;
+		munmap((void*) file, fileSize);
+		return NULL;
+	}
+
+	*numOfFeatures = (int) count;
+	SPPoint** features = (SPPoint**) malloc((count > 0 ? count : 1)*sizeof(SPPoint*));
+	double* data = (double*) malloc(dim*sizeof(double));
+	if (features==NULL || data==NULL) { //Allocation failure
+		*msg = SP_FEATS_FILE_OUT_OF_MEMORY;
+		free(features);
+		free(data);
+		munmap((void*) file, fileSize);
+		return NULL;
+	}
+	for (int i=0; i<(int) count; i++) {
+		features[i] = createFeature(block, i, dim, data, imgIndex);
+		if (features[i] == NULL) { //Allocation failure
+			*msg = SP_FEATS_FILE_OUT_OF_MEMORY;
+			destroyFeatures(features, i);
+			free(data);
+			munmap((void*) file, fileSize);
+			return NULL;
+		}
+	}
+	free(data);
+	munmap((void*) file, fileSize);
+	return features;
+}
+
+SP_FEATS_FILE_MSG spFeatsFileWriteBinary(const char* path, SPPoint** features, int numOfFeatures, int dim) {
+	if (path==NULL || dim<=0 || numOfFeatures<0 || (features==NULL && numOfFeatures>0)) {
+		return SP_FEATS_FILE_INVALID_ARGUMENT;
+	}
+	FILE* file = fopen(path, "wb");
+	if (file == NULL) {
+		return SP_FEATS_FILE_CANNOT_OPEN;
+	}
+
+	// the header is written last, once the checksum of the feature block is known
+	unsigned char header[SP_FEATS_FILE_HEADER_SIZE] = { 0 };
+	uint32_t hash = SP_BINARY_FNV32_OFFSET_BASIS;
+	bool written = fwrite(header, 1, SP_FEATS_FILE_HEADER_SIZE, file) == SP_FEATS_FILE_HEADER_SIZE
+			&& writeFeatures(file, features, numOfFeatures, dim, &hash);
+	memcpy(header, SP_FEATS_FILE_MAGIC, MAGIC_SIZE);
+	spBinaryWriteLE32(header + MAGIC_SIZE, SP_FEATS_FILE_VERSION);
+	spBinaryWriteLE32(header + MAGIC_SIZE + 4, (uint32_t) dim);
+	spBinaryWriteLE32(header + MAGIC_SIZE + 8, (uint32_t) numOfFeatures);
+	spBinaryWriteLE32(header + MAGIC_SIZE + 12, SP_FEATS_FILE_DTYPE_FLOAT32);
+	spBinaryWriteLE32(header + MAGIC_SIZE + 16, hash);
+	written = written && fseek(file, 0, SEEK_SET) == 0
+			&& fwrite(header, 1, SP_FEATS_FILE_HEADER_SIZE, file) == SP_FEATS_FILE_HEADER_SIZE;
+	if (fclose(file) != 0 || !written) {
+		return SP_FEATS_FILE_WRITE_ERROR;
+	}
+	return SP_FEATS_FILE_SUCCESS;
+}
+
+SP_FEATS_FILE_MSG spFeatsFileReadDatabase(const char* path, SPFeatureStore* store, int dim) {
+	if (path==NULL || store==NULL || spFeatureStoreGetSize(store)!=0 || dim<=0) {
+		return SP_FEATS_FILE_INVALID_ARGUMENT;
+	}
+	size_t fileSize = 0;
+	const unsigned char* file = mapFile(path, &fileSize);
+	if (file == NULL) {
+		return SP_FEATS_FILE_CANNOT_OPEN;
+	}
+	if (fileSize < SP_FEATS_DATABASE_HEADER_SIZE) {
+		munmap((void*) file, fileSize);
+		return SP_FEATS_FILE_CORRUPTED;
+	}
+
+	// verifying the header, and that the image table and the feature block are complete and intact
+	uint32_t version = spBinaryReadLE32(file + MAGIC_SIZE);
+	uint32_t fileDim = spBinaryReadLE32(file + MAGIC_SIZE + 4);
+	uint32_t numOfImages = spBinaryReadLE32(file + MAGIC_SIZE + 8);
+	uint32_t numOfFeatures = spBinaryReadLE32(file + MAGIC_SIZE + 12);
+	uint32_t dtype = spBinaryReadLE32(file + MAGIC_SIZE + 16);
+	uint32_t fileChecksum = spBinaryReadLE32(file + MAGIC_SIZE + 20);
+	const unsigned char* table = file + SP_FEATS_DATABASE_HEADER_SIZE;
+	size_t tableSize = (size_t) numOfImages * SP_FEATS_DATABASE_ENTRY_SIZE;
+	const unsigned char* block = table + tableSize;
+	size_t blockSize = (size_t) numOfFeatures * fileDim * sizeof(float);
+	if (memcmp(file, SP_FEATS_DATABASE_MAGIC, MAGIC_SIZE) != 0 || version != SP_FEATS_DATABASE_VERSION
+			|| dtype != SP_FEATS_FILE_DTYPE_FLOAT32 || fileDim != (uint32_t) dim
+			|| numOfImages != (uint32_t) spFeatureStoreGetNumOfImages(store) || numOfFeatures > INT32_MAX) {
+		munmap((void*) file, fileSize);
+		return SP_FEATS_FILE_INVALID_FORMAT;
+	}
+	if (fileSize - SP_FEATS_DATABASE_HEADER_SIZE != tableSize + blockSize
+			|| spBinaryChecksum(SP_BINARY_FNV32_OFFSET_BASIS, table, tableSize + blockSize) != fileChecksum) {
+		munmap((void*) file, fileSize);
+		return SP_FEATS_FILE_CORRUPTED;
+	}
+
+	double* data = (double*) malloc(dim*sizeof(double));
+	if (data == NULL) { //Allocation failure
+		munmap((void*) file, fileSize);
+		return SP_FEATS_FILE_OUT_OF_MEMORY;
+	}
+	SP_FEATS_FILE_MSG msg = SP_FEATS_FILE_SUCCESS;
+	for (uint32_t e=0; e<numOfImages && msg==SP_FEATS_FILE_SUCCESS; e++) {
+		const unsigned char* entry = table + (size_t) e * SP_FEATS_DATABASE_ENTRY_SIZE;
+		uint32_t imageId = spBinaryReadLE32(entry);
+		uint32_t offset = spBinaryReadLE32(entry + 4);
+		uint32_t count = spBinaryReadLE32(entry + 8);
+		if (imageId >= numOfImages || offset > numOfFeatures || count > numOfFeatures - offset) {
+			msg = SP_FEATS_FILE_INVALID_FORMAT;
+			break;
+		}
+		SPPoint** features = (SPPoint**) malloc((count > 0 ? count : 1)*sizeof(SPPoint*));
+		if (features == NULL) { //Allocation failure
+			msg = SP_FEATS_FILE_OUT_OF_MEMORY;
+			break;
+		}
+		uint32_t created = 0;
+		while (created < count
+				&& (features[created] = createFeature(block, (size_t) offset + created, dim, data, imageId)) != NULL) {
+			created++;
+		}
+		if (created < count) { //Allocation failure
+			msg = SP_FEATS_FILE_OUT_OF_MEMORY;
+		} else {
+			SP_FEATURE_STORE_MSG added = spFeatureStoreAddImage(store, imageId, features, count);
+			if (added == SP_FEATURE_STORE_SUCCESS) {
+				continue;
+			}
+			msg = (added == SP_FEATURE_STORE_OUT_OF_MEMORY) ? SP_FEATS_FILE_OUT_OF_MEMORY
+					: SP_FEATS_FILE_INVALID_FORMAT; // an image appearing twice
+		}
+		destroyFeatures(features, created);
+	}
+	free(data);
+	munmap((void*) file, fileSize);
+	return msg;
+}
+
+SP_FEATS_FILE_MSG spFeatsFileWriteDatabase(const char* path, SPFeatureStore* store, int dim) {
+	if (path==NULL || store==NULL || !spFeatureStoreIsComplete(store) || dim<=0) {
+		return SP_FEATS_FILE_INVALID_ARGUMENT;
+	}
+	FILE* file = fopen(path, "wb");
+	if (file == NULL) {
+		return SP_FEATS_FILE_CANNOT_OPEN;
+	}
+
+	// the header is written last, once the checksum of the image table and feature block is known
+	int numOfImages = spFeatureStoreGetNumOfImages(store);
+	unsigned char header[SP_FEATS_DATABASE_HEADER_SIZE] = { 0 };
+	unsigned char entry[SP_FEATS_DATABASE_ENTRY_SIZE];
+	uint32_t hash = SP_BINARY_FNV32_OFFSET_BASIS;
+	uint32_t offset = 0;
+	bool written = fwrite(header, 1, SP_FEATS_DATABASE_HEADER_SIZE, file) == SP_FEATS_DATABASE_HEADER_SIZE;
+	for (int i=0; i<numOfImages && written; i++) {
+		uint32_t count = (uint32_t) spFeatureStoreGetImageSize(store, i);
+		spBinaryWriteLE32(entry, (uint32_t) i);
+		spBinaryWriteLE32(entry + 4, offset);
+		spBinaryWriteLE32(entry + 8, count);
+		hash = spBinaryChecksum(hash, entry, SP_FEATS_DATABASE_ENTRY_SIZE);
+		written = fwrite(entry, 1, SP_FEATS_DATABASE_ENTRY_SIZE, file) == SP_FEATS_DATABASE_ENTRY_SIZE;
+		offset += count;
+	}
+	for (int i=0; i<numOfImages && written; i++) {
+		written = writeFeatures(file, spFeatureStoreGetImageFeatures(store, i), spFeatureStoreGetImageSize(store, i),
+				dim, &hash);
+	}
+	memcpy(header, SP_FEATS_DATABASE_MAGIC, MAGIC_SIZE);
+	spBinaryWriteLE32(header + MAGIC_SIZE, SP_FEATS_DATABASE_VERSION);
+	spBinaryWriteLE32(header + MAGIC_SIZE + 4, (uint32_t) dim);
+	spBinaryWriteLE32(header + MAGIC_SIZE + 8, (uint32_t) numOfImages);
+	spBinaryWriteLE32(header + MAGIC_SIZE + 12, offset);
+	spBinaryWriteLE32(header + MAGIC_SIZE + 16, SP_FEATS_FILE_DTYPE_FLOAT32);
+	spBinaryWriteLE32(header + MAGIC_SIZE + 20, hash);
+	written = written && fseek(file, 0, SEEK_SET) == 0
+			&& fwrite(header, 1, SP_FEATS_DATABASE_HEADER_SIZE, file) == SP_FEATS_DATABASE_HEADER_SIZE;
+	if (fclose(file) != 0 || !written) {
+		return SP_FEATS_FILE_WRITE_ERROR;
+	}
+	return SP_FEATS_FILE_SUCCESS;
+}
@@ -0,0 +1,159 @@
+#ifndef SPFEATSFILE_H_
+#define SPFEATSFILE_H_
+#include <stdbool.h>
+#include "SPPoint.h"
+#include "SPFeatureStore.h"
+
+/**
+ * SP Feats File summary
+ * Reads and writes the ".feats" files which store the features of an image, in one of two formats:
+ *
+ * TEXT 	- the number of features in the first line, followed by a line of <dim> doubles per feature.
+ * BINARY 	- a header followed by a packed block of the features, <dim> little-endian floats per feature.
+ * 			  The header is made of the magic "SPFT" and five little-endian 32-bit unsigned integers:
+ * 			  version, dim, count, dtype and a checksum (32-bit FNV-1a) of the feature block.
+ * 			  The file is mapped to memory when read, so no value is parsed.
+ *
+ * The features of all the images may also be packed in a single database file, made of:
+ * - a header of the magic "SPDB" and seven little-endian 32-bit unsigned integers: version, dim,
+ *   number of images, number of features, dtype, a checksum (32-bit FNV-1a) of the image table and
+ *   the feature block, and a reserved 0.
+ * - the image table - for each image, its index (the image id), the offset of its first feature in
+ *   the feature block, and its number of features, as little-endian 32-bit unsigned integers.
+ * - the feature block - the features of all the images, <dim> little-endian floats per feature.
+ *
+ * The following functions are supported:
+ *
+ * spFeatsFileIsBinary	- Checks whether a file is a binary feats file
+ * spFeatsFileRead		- Reads the features of a feats file of either format
+ * spFeatsFileReadText	- Reads the features of a text feats file
+ * spFeatsFileReadBinary	- Reads the features of a binary feats file
+ * spFeatsFileWriteBinary	- Writes features to a binary feats file
+ * spFeatsFileReadDatabase	- Reads the features of all the images from a database file into a feature store
+ * spFeatsFileWriteDatabase	- Writes the features of a feature store to a database file
+ */
+
+#define SP_FEATS_FILE_MAGIC "SPFT"
+#define SP_FEATS_FILE_VERSION 1
+#define SP_FEATS_FILE_DTYPE_FLOAT32 1
+#define SP_FEATS_FILE_HEADER_SIZE 24
+#define SP_FEATS_DATABASE_MAGIC "SPDB"
+#define SP_FEATS_DATABASE_VERSION 1
+#define SP_FEATS_DATABASE_HEADER_SIZE 32
+#define SP_FEATS_DATABASE_ENTRY_SIZE 12
+
+/** type for error reporting **/
+typedef enum sp_feats_file_msg_t {
+	SP_FEATS_FILE_CANNOT_OPEN,
+	SP_FEATS_FILE_INVALID_COUNT,		// the number of features couldn't be read, or is negative
+	SP_FEATS_FILE_INVALID_FORMAT,		// a value couldn't be read, or an unsupported version, dtype or dim
+	SP_FEATS_FILE_CORRUPTED,			// the file is truncated, or its checksum doesn't match
+	SP_FEATS_FILE_WRITE_ERROR,
+	SP_FEATS_FILE_OUT_OF_MEMORY,
+	SP_FEATS_FILE_INVALID_ARGUMENT,
+	SP_FEATS_FILE_SUCCESS
+} SP_FEATS_FILE_MSG;
+
+/**
+ * Checks whether the file is a binary feats file, by its magic.
+ *
+ * @return
+ * true if the file starts with SP_FEATS_FILE_MAGIC, false otherwise (or if it couldn't be opened)
+ */
+bool spFeatsFileIsBinary(const char* path);
+
+/**
+ * Reads the features of a feats file of either format (see spFeatsFileIsBinary).
+ * The arguments and the result are those of spFeatsFileReadText and spFeatsFileReadBinary.
+ */
+SPPoint** spFeatsFileRead(const char* path, int imgIndex, int dim, int* numOfFeatures, SP_FEATS_FILE_MSG* msg);
+
+/**
+ * Reads the features of a text feats file.
+ * The whole file is read at once, and parsed as by fscanf in the "C" locale, without its per-value overhead.
+ *
+ * @param path 			- the path of the file
+ * @param imgIndex 		- the index given to the features
+ * @param dim 			- the dimension of the features
+ * @param numOfFeatures	- pointer in which the number of features is stored
+ * @param msg 			- pointer in which the msg returned by the function is stored
+ *
+ * @return
+ * NULL in case of failure (see msg)
+ * Otherwise, the array of the features (allocated even if the file has no features)
+ */
+SPPoint** spFeatsFileReadText(const char* path, int imgIndex, int dim, int* numOfFeatures, SP_FEATS_FILE_MSG* msg);
+
+/**
+ * Reads the features of a binary feats file. The file is mapped to memory, its header and
+ * checksum are verified, and the features are created from the feature block.
+ *
+ * @param path 			- the path of the file
+ * @param imgIndex 		- the index given to the features
+ * @param dim 			- the dimension of the features, which must match the dim of the file
+ * @param numOfFeatures	- pointer in which the number of features is stored
+ * @param msg 			- pointer in which the msg returned by the function is stored
+ *
+ * @return
+ * NULL in case of failure (see msg)
+ * Otherwise, the array of the features (allocated even if the file has no features)
+ */
+SPPoint** spFeatsFileReadBinary(const char* path, int imgIndex, int dim, int* numOfFeatures,
+		SP_FEATS_FILE_MSG* msg);
+
+/**
+ * Writes the features to a binary feats file, replacing it if it exists.
+ * The coordinates are stored as floats.
+ *
+ * @param path 			- the path of the file
+ * @param features 		- the features to write
+ * @param numOfFeatures	- the number of features
+ * @param dim 			- the dimension of the features
+ *
+ * @return
+ * SP_FEATS_FILE_INVALID_ARGUMENT if path==NULL or dim<=0 or numOfFeatures<0 or features==NULL while numOfFeatures>0
+ * SP_FEATS_FILE_OUT_OF_MEMORY in case of allocation failure
+ * SP_FEATS_FILE_CANNOT_OPEN if the file couldn't be created
+ * SP_FEATS_FILE_WRITE_ERROR if writing failed
+ * SP_FEATS_FILE_SUCCESS otherwise
+ */
+SP_FEATS_FILE_MSG spFeatsFileWriteBinary(const char* path, SPPoint** features, int numOfFeatures, int dim);
+
+/**
+ * Reads the features of all the images from a database file into an empty feature store.
+ * The file is mapped to memory and read sequentially, its header, image table and checksum are
+ * verified, and the features of each image are created from the feature block, with the image id
+ * as their index.
+ *
+ * @param path 	- the path of the file
+ * @param store - an empty feature store, for the number of images of the file
+ * @param dim 	- the dimension of the features, which must match the dim of the file
+ *
+ * @return
+ * SP_FEATS_FILE_INVALID_ARGUMENT if path==NULL or store==NULL or the store isn't empty or dim<=0
+ * SP_FEATS_FILE_CANNOT_OPEN if the file couldn't be opened
+ * SP_FEATS_FILE_INVALID_FORMAT if the magic, version, dtype, dim or number of images don't match,
+ * 								 or the image table is inconsistent
+ * SP_FEATS_FILE_CORRUPTED if the file is truncated, or its checksum doesn't match
+ * SP_FEATS_FILE_OUT_OF_MEMORY in case of allocation failure
+ * SP_FEATS_FILE_SUCCESS otherwise, the store then holds the features of every image
+ */
+SP_FEATS_FILE_MSG spFeatsFileReadDatabase(const char* path, SPFeatureStore* store, int dim);
+
+/**
+ * Writes the features of all the images of the store to a database file, replacing it if it exists.
+ * The coordinates are stored as floats.
+ *
+ * @param path 	- the path of the file
+ * @param store - a feature store holding the features of every image
+ * @param dim 	- the dimension of the features
+ *
+ * @return
+ * SP_FEATS_FILE_INVALID_ARGUMENT if path==NULL or store==NULL or an image is missing or dim<=0
+ * SP_FEATS_FILE_CANNOT_OPEN if the file couldn't be created
+ * SP_FEATS_FILE_WRITE_ERROR if writing failed
+ * SP_FEATS_FILE_SUCCESS otherwise
+ */
+SP_FEATS_FILE_MSG spFeatsFileWriteDatabase(const char* path, SPFeatureStore* store, int dim);
+
+#endif /* SPFEATSFILE_H_ */
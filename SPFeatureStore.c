@@ -0,0 +1,129 @@
+#include "SPFeatureStore.h"
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+#define NOT_ADDED -1
+
+struct sp_feature_store_t {
+	SPPoint** features;			//all the features, the features of each image one after another
+	int size;					//number of features
+	int capacity;				//allocated length of features
+	int numOfImages;
+	int* imageOffsets;			//index in features of the first feature of each image
+	int* imageSizes;			//number of features of each image, NOT_ADDED if not added yet
+	int numOfAdded;				//number of images added
+};
+
+SPFeatureStore* spFeatureStoreCreate(int numOfImages) {
+	if (numOfImages <= 0) {
+		return NULL;
+	}
+	SPFeatureStore* store = (SPFeatureStore*) malloc(sizeof(SPFeatureStore));
+	if (store == NULL) { //Allocation failure
+		return NULL;
+	}
+	store->imageOffsets = (int*) malloc(numOfImages*sizeof(int));
+	store->imageSizes = (int*) malloc(numOfImages*sizeof(int));
+	if (store->imageOffsets==NULL || store->imageSizes==NULL) { //Allocation failure
+		free(store->imageOffsets);
+		free(store->imageSizes);
+		free(store);
+		return NULL;
+	}
+	for (int i=0; i<numOfImages; i++) {
+		store->imageOffsets[i] = 0;
+		store->imageSizes[i] = NOT_ADDED;
+	}
+	store->features = NULL;
+	store->size = 0;
+	store->capacity = 0;
+	store->numOfImages = numOfImages;
+	store->numOfAdded = 0;
+	return store;
+}
+
+void spFeatureStoreDestroy(SPFeatureStore* store) {
+	if (store == NULL) {
+		return;
+	}
+	for (int i=0; i<store->size; i++) {
+		spPointDestroy(store->features[i]);
+	}
+	free(store->features);
+	free(store->imageOffsets);
+	free(store->imageSizes);
+	free(store);
+}
+
+SP_FEATURE_STORE_MSG spFeatureStoreAddImage(SPFeatureStore* store, int imgIndex, SPPoint** features,
+		int numOfFeatures) {
+	if (store==NULL || imgIndex<0 || imgIndex>=store->numOfImages || numOfFeatures<0
+			|| (features==NULL && numOfFeatures>0)) {
+		return SP_FEATURE_STORE_INVALID_ARGUMENT;
+	}
+	if (store->imageSizes[imgIndex] != NOT_ADDED) {
+		return SP_FEATURE_STORE_IMAGE_EXISTS;
+	}
+	if (store->size + numOfFeatures > store->capacity) { // growing at least twice as large
+		int capacity = (store->capacity*2 > store->size + numOfFeatures) ?
+				store->capacity*2 : store->size + numOfFeatures;
+		SPPoint** grown = (SPPoint**) realloc(store->features, capacity*sizeof(SPPoint*));
+		if (grown == NULL) { //Allocation failure
+			return SP_FEATURE_STORE_OUT_OF_MEMORY;
+		}
+		store->features = grown;
+		store->capacity = capacity;
+	}
+	if (numOfFeatures > 0) {
+		memcpy(store->features + store->size, features, numOfFeatures*sizeof(SPPoint*));
+	}
+	free(features);
+	store->imageOffsets[imgIndex] = store->size;
+	store->imageSizes[imgIndex] = numOfFeatures;
+	store->size += numOfFeatures;
+	store->numOfAdded++;
+	return SP_FEATURE_STORE_SUCCESS;
+}
+
+SPPoint** spFeatureStoreGetFeatures(SPFeatureStore* store) {
+	if (store == NULL || store->size == 0) {
+		return NULL;
+	}
+	return store->features;
+}
+
+int spFeatureStoreGetSize(SPFeatureStore* store) {
+	if (store == NULL) {
+		return -1;
+	}
+	return store->size;
+}
+
+int spFeatureStoreGetNumOfImages(SPFeatureStore* store) {
+	if (store == NULL) {
+		return -1;
+	}
+	return store->numOfImages;
+}
+
+SPPoint** spFeatureStoreGetImageFeatures(SPFeatureStore* store, int imgIndex) {
+	if (store==NULL || imgIndex<0 || imgIndex>=store->numOfImages || store->imageSizes[imgIndex] <= 0) {
+		return NULL;
+	}
+	return store->features + store->imageOffsets[imgIndex];
+}
+
+int spFeatureStoreGetImageSize(SPFeatureStore* store, int imgIndex) {
+	if (store==NULL || imgIndex<0 || imgIndex>=store->numOfImages) {
+		return -1;
+	}
+	return store->imageSizes[imgIndex];
+}
+
+bool spFeatureStoreIsComplete(SPFeatureStore* store) {
+	if (store == NULL) {
+		return false;
+	}
+	return store->numOfAdded == store->numOfImages;
+}
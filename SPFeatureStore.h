@@ -0,0 +1,127 @@
+#ifndef SPFEATURESTORE_H_
+#define SPFEATURESTORE_H_
+#include <stdbool.h>
+#include "SPPoint.h"
+
+/**
+ * SP Feature Store summary
+ * Owns the features of all the images of the database - the only copy of them kept in memory.
+ * The features of each image are kept one after another, so the whole database is available
+ * as a single array (used to build the KDTree, which references the features rather than
+ * copying them) and the features of an image are found by their offset in that array.
+ *
+ * The following functions are supported:
+ *
+ * spFeatureStoreCreate			- Creates a new empty store
+ * spFeatureStoreDestroy		- Free all resources associated with a store, including the features
+ * spFeatureStoreAddImage		- Moves the features of an image into the store
+ * spFeatureStoreGetFeatures	- A getter of all the features
+ * spFeatureStoreGetSize		- A getter of the number of features
+ * spFeatureStoreGetNumOfImages	- A getter of the number of images
+ * spFeatureStoreGetImageFeatures - A getter of the features of an image
+ * spFeatureStoreGetImageSize	- A getter of the number of features of an image
+ * spFeatureStoreIsComplete		- Checks whether the features of all the images were added
+ */
+
+/** type used to define the feature store **/
+typedef struct sp_feature_store_t SPFeatureStore;
+
+/** type for error reporting **/
+typedef enum sp_feature_store_msg_t {
+	SP_FEATURE_STORE_OUT_OF_MEMORY,
+	SP_FEATURE_STORE_INVALID_ARGUMENT,
+	SP_FEATURE_STORE_IMAGE_EXISTS,
+	SP_FEATURE_STORE_SUCCESS
+} SP_FEATURE_STORE_MSG;
+
+/**
+ * Allocates a new empty store in the memory, for the features of numOfImages images.
+ *
+ * @return
+ * NULL in case allocation failure occurred OR numOfImages <= 0
+ * Otherwise, the new store is returned
+ */
+SPFeatureStore* spFeatureStoreCreate(int numOfImages);
+
+/**
+ * Free all memory allocation associated with the store, the features included.
+ * The features given by the getters are no longer valid afterwards.
+ * If store is NULL nothing happens.
+ */
+void spFeatureStoreDestroy(SPFeatureStore* store);
+
+/**
+ * Moves the features of the image imgIndex into the store. The images may be added in
+ * any order. On success the store owns the points, and the array <features> itself is freed,
+ * so neither may be used by the caller anymore. On failure nothing changes hands.
+ *
+ * @param store 		- the target store
+ * @param imgIndex 		- the index of the image
+ * @param features 		- the features of the image (may be NULL if numOfFeatures == 0)
+ * @param numOfFeatures - the number of features of the image
+ *
+ * @return
+ * SP_FEATURE_STORE_INVALID_ARGUMENT in case store==NULL OR imgIndex is out of range OR numOfFeatures<0
+ * 									 OR features==NULL while numOfFeatures>0
+ * SP_FEATURE_STORE_IMAGE_EXISTS in case the features of imgIndex were already added
+ * SP_FEATURE_STORE_OUT_OF_MEMORY in case the store couldn't grow
+ * SP_FEATURE_STORE_SUCCESS otherwise
+ */
+SP_FEATURE_STORE_MSG spFeatureStoreAddImage(SPFeatureStore* store, int imgIndex, SPPoint** features,
+		int numOfFeatures);
+
+/**
+ * A getter of all the features in the store, the features of each image one after another.
+ * The array is owned by the store, and is valid until the next spFeatureStoreAddImage.
+ *
+ * @return
+ * NULL if store==NULL or the store is empty
+ * Otherwise, the array of all the features
+ */
+SPPoint** spFeatureStoreGetFeatures(SPFeatureStore* store);
+
+/**
+ * A getter of the number of features in the store.
+ *
+ * @return
+ * -1 if store==NULL
+ * Otherwise, the number of features
+ */
+int spFeatureStoreGetSize(SPFeatureStore* store);
+
+/**
+ * A getter of the number of images the store was created for.
+ *
+ * @return
+ * -1 if store==NULL
+ * Otherwise, the number of images
+ */
+int spFeatureStoreGetNumOfImages(SPFeatureStore* store);
+
+/**
+ * A getter of the features of the image imgIndex, a part of the array of all the features.
+ *
+ * @return
+ * NULL if store==NULL, imgIndex is out of range, or the image has no features
+ * Otherwise, the features of the image
+ */
+SPPoint** spFeatureStoreGetImageFeatures(SPFeatureStore* store, int imgIndex);
+
+/**
+ * A getter of the number of features of the image imgIndex.
+ *
+ * @return
+ * -1 if store==NULL, imgIndex is out of range, or the image wasn't added
+ * Otherwise, the number of features of the image
+ */
+int spFeatureStoreGetImageSize(SPFeatureStore* store, int imgIndex);
+
+/**
+ * Checks whether the features of all the images were added.
+ *
+ * @return
+ * false if store==NULL or an image is missing, true otherwise
+ */
+bool spFeatureStoreIsComplete(SPFeatureStore* store);
+
+#endif /* SPFEATURESTORE_H_ */
@@ -0,0 +1,105 @@
+#include <cstdio>
+#include "SPFeatureWriter.h"
+extern "C" {
+#include "SPLogger.h"
+#include "SPFeatsFile.h"
+}
+
+#define FEATURE_WRITER_ERROR "Write to feat file failed\n"
+#define COORDINATE_MAX_LENGTH 512 // "%lf " of any double, up to DBL_MAX
+
+using namespace std;
+
+sp::FeatureWriter::FeatureWriter(int queueSize) :
+		jobs(queueSize > 0 ? queueSize : 1), failed(false), started(false) {
+}
+
+sp::FeatureWriter::~FeatureWriter() {
+	finish();
+}
+
+bool sp::FeatureWriter::start() {
+	if (started) {
+		return true;
+	}
+	try {
+		writer = thread(&FeatureWriter::run, this);
+	} catch (exception& ex) { // thread creation failed
+		spLoggerPrintError(FUNCTION_ERROR, __FILE__, __func__, __LINE__);
+		return false;
+	}
+	started = true;
+	return true;
+}
+
+bool sp::FeatureWriter::write(const char* path, SPPoint** features, int numOfFeatures, int dim, bool binary) {
+	if (!started || failed || path==NULL || numOfFeatures<0 || (features==NULL && numOfFeatures>0) || dim<1) {
+		return false;
+	}
+	Job* job = new Job();
+	job->path = path;
+	job->features.assign(features, features + numOfFeatures);
+	job->dim = dim;
+	job->binary = binary;
+	if (!jobs.push(job)) {
+		delete job;
+		return false;
+	}
+	return true;
+}
+
+bool sp::FeatureWriter::finish() {
+	if (started) {
+		jobs.close();
+		writer.join();
+		started = false;
+	}
+	return !failed;
+}
+
+void sp::FeatureWriter::run() {
+	string buffer;
+	Job* job = NULL;
+	while (jobs.pop(job)) {
+		// once a file failed the rest are dropped, the extraction is failing anyway
+		if (!failed) {
+			bool written;
+			if (job->binary) {
+				written = spFeatsFileWriteBinary(job->path.c_str(), job->features.data(),
+						(int) job->features.size(), job->dim) == SP_FEATS_FILE_SUCCESS;
+			} else {
+				written = writeText(*job, buffer);
+			}
+			if (!written) {
+				spLoggerPrintError(FEATURE_WRITER_ERROR, __FILE__, __func__, __LINE__);
+				failed = true;
+			}
+		}
+		delete job;
+	}
+}
+
+bool sp::FeatureWriter::writeText(const Job& job, string& buffer) {
+	// the number of features in the first line, then a line of "%lf " per feature
+	char coordinate[COORDINATE_MAX_LENGTH];
+	buffer.clear();
+	int length = snprintf(coordinate, sizeof(coordinate), "%d\n", (int) job.features.size());
+	buffer.append(coordinate, length);
+	for (size_t i=0; i<job.features.size(); i++) {
+		for (int j=0; j<job.dim; j++) {
+			length = snprintf(coordinate, sizeof(coordinate), "%lf ", spPointGetAxisCoor(job.features[i], j));
+			if (length < 0 || length >= (int) sizeof(coordinate)) {
+				return false;
+			}
+			buffer.append(coordinate, length);
+		}
+		buffer.push_back('\n');
+	}
+
+	FILE* featsFile = fopen(job.path.c_str(), "w");
+	if (featsFile == NULL) {
+		return false;
+	}
+	bool written = fwrite(buffer.data(), 1, buffer.size(), featsFile) == buffer.size();
+	return (fclose(featsFile) == 0) && written;
+}
@@ -0,0 +1,84 @@
+#ifndef SPFEATUREWRITER_H_
+#define SPFEATUREWRITER_H_
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SPQueryPipeline.h"
+
+extern "C" {
+#include "SPPoint.h"
+}
+
+namespace sp {
+
+/**
+ * Writes the feats files of extraction mode on a background thread, so the features of the
+ * next image are extracted while the previous image's file is written.
+ * Each file is formatted (text) or packed (binary, see SPFeatsFile.h) into a single buffer,
+ * and written with a single write, rather than with a stdio call per coordinate.
+ *
+ * write may be called by several producer threads at once, while start and finish are called
+ * by the thread owning the writer.
+ */
+class FeatureWriter {
+private:
+	struct Job {
+		std::string path;
+		std::vector<SPPoint*> features; // referenced, must outlive the job
+		int dim;
+		bool binary;
+	};
+
+	BoundedQueue<Job*> jobs;
+	std::thread writer;
+	std::atomic<bool> failed;
+	bool started;
+
+	void run();
+	static bool writeText(const Job& job, std::string& buffer);
+public:
+
+	/**
+	 * Creates a writer, which isn't started yet.
+	 * @param queueSize - the maximal number of files waiting to be written
+	 */
+	explicit FeatureWriter(int queueSize);
+
+	/**
+	 * Finishes the writer, see finish.
+	 */
+	~FeatureWriter();
+
+	/**
+	 * Starts the background thread.
+	 * @return false if the thread couldn't be created.
+	 */
+	bool start();
+
+	/**
+	 * Queues the features of an image to be written to path, waiting while the queue is full.
+	 * The features are referenced, not copied, so they must be kept until finish returns.
+	 *
+	 * @param path 			- the path of the feats file
+	 * @param features 		- the features of the image
+	 * @param numOfFeatures - the number of features
+	 * @param dim 			- the dimension of the features
+	 * @param binary 		- true for the binary format, false for the text format
+	 *
+	 * @return
+	 * false if the writer isn't started, or a previous file couldn't be written
+	 */
+	bool write(const char* path, SPPoint** features, int numOfFeatures, int dim, bool binary);
+
+	/**
+	 * Waits until all the queued files were written, and stops the background thread.
+	 * @return false if one of the files couldn't be written.
+	 */
+	bool finish();
+};
+
+}
+
+#endif /* SPFEATUREWRITER_H_ */
@@ -0,0 +1,253 @@
+#include "SPHammingIndex.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include <string.h>
+
+#define SUBSTRING_BITS 16
+#define NUM_OF_BUCKETS (1 << SUBSTRING_BITS)
+#define SUBSTRINGS_PER_WORD 4				//16-bit substrings, i.e coordinates, in each 64-bit word
+#define MAX_COORDINATE 65535.0				//the largest 16-bit word
+
+struct sp_hamming_index_t {
+	int size;					//number of features
+	int dim;					//number of 16-bit substrings of each code, each with its table
+	int numOfWords;				//number of 64-bit words of each code
+	uint64_t* codes;			//the code of each feature
+	int* imageIndexes;			//the image index of each feature
+	int* bucketStarts;			//by table, where each bucket starts in bucketFeatures (NUM_OF_BUCKETS+1 each)
+	int* bucketFeatures;		//by table, the features ordered by the value of their substring
+};
+
+/**
+ * Returns the number of bits set in x.
+ */
+static int spHammingIndexPopcount(uint64_t x) {
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (int) ((x * 0x0101010101010101ULL) >> 56);
+}
+
+/**
+ * Stores the coordinate of point at axis in word, returns false if it isn't a 16-bit word.
+ */
+static bool spHammingIndexGetWord(SPPoint* point, int axis, uint64_t* word) {
+	double coor = spPointGetAxisCoor(point, axis);
+	if (!(coor >= 0 && coor <= MAX_COORDINATE) || coor != (double) (uint64_t) coor) { //NaN fails too
+		return false;
+	}
+	*word = (uint64_t) coor;
+	return true;
+}
+
+/**
+ * Packs the coordinates of point into code, four 16-bit words in each 64-bit word.
+ * Returns false if a coordinate isn't a 16-bit word.
+ */
+static bool spHammingIndexPack(SPPoint* point, int dim, uint64_t* code) {
+	memset(code, 0, ((dim + SUBSTRINGS_PER_WORD - 1) / SUBSTRINGS_PER_WORD) * sizeof(uint64_t));
+	for (int i=0; i<dim; i++) {
+		uint64_t word;
+		if (!spHammingIndexGetWord(point, i, &word)) {
+			return false;
+		}
+		code[i / SUBSTRINGS_PER_WORD] |= word << (SUBSTRING_BITS * (i % SUBSTRINGS_PER_WORD));
+	}
+	return true;
+}
+
+/**
+ * Returns the 16-bit substring of code which table indexes, i.e its coordinate.
+ */
+static unsigned int spHammingIndexSubstring(const uint64_t* code, int table) {
+	return (unsigned int) ((code[table / SUBSTRINGS_PER_WORD] >> (SUBSTRING_BITS * (table % SUBSTRINGS_PER_WORD)))
+			& (NUM_OF_BUCKETS - 1));
+}
+
+/**
+ * Returns the number of ways to choose k of n bits.
+ */
+static long long spHammingIndexBinomial(int n, int k) {
+	long long res = 1;
+	for (int i=1; i<=k; i++) {
+		res = res * (n - k + i) / i;
+	}
+	return res;
+}
+
+SPHammingIndex* spHammingIndexBuild(SPPoint** points, int size, int dim) {
+	if (points==NULL || size<=0 || dim<=0) {
+		return NULL;
+	}
+	SPHammingIndex* index = (SPHammingIndex*) calloc(1, sizeof(SPHammingIndex));
+	if (index == NULL) {
+		return NULL;
+	}
+	index->size = size;
+	index->dim = dim;
+	index->numOfWords = (dim + SUBSTRINGS_PER_WORD - 1) / SUBSTRINGS_PER_WORD;
+	index->codes = (uint64_t*) malloc((size_t) size * index->numOfWords * sizeof(uint64_t));
+	index->imageIndexes = (int*) malloc(size * sizeof(int));
+	index->bucketStarts = (int*) calloc((size_t) index->dim * (NUM_OF_BUCKETS + 1), sizeof(int));
+	index->bucketFeatures = (int*) malloc((size_t) index->dim * size * sizeof(int));
+	if (index->codes==NULL || index->imageIndexes==NULL || index->bucketStarts==NULL
+			|| index->bucketFeatures==NULL) { //memory allocation failure
+		spHammingIndexDestroy(index);
+		return NULL;
+	}
+	for (int i=0; i<size; i++) {
+		if (points[i]==NULL || spPointGetDimension(points[i]) != dim
+				|| !spHammingIndexPack(points[i], dim, index->codes + (size_t) i * index->numOfWords)) {
+			spHammingIndexDestroy(index);
+			return NULL;
+		}
+		index->imageIndexes[i] = spPointGetIndex(points[i]);
+	}
+
+	//counting sort of the features by the substring of each table
+	for (int t=0; t<index->dim; t++) {
+		int* starts = index->bucketStarts + (size_t) t * (NUM_OF_BUCKETS + 1);
+		int* features = index->bucketFeatures + (size_t) t * size;
+		for (int i=0; i<size; i++) {
+			starts[spHammingIndexSubstring(index->codes + (size_t) i * index->numOfWords, t) + 1]++;
+		}
+		for (int b=0; b<NUM_OF_BUCKETS; b++) {
+			starts[b+1] += starts[b];
+		}
+		for (int i=0; i<size; i++) { //each bucket start is moved to the next bucket's
+			features[starts[spHammingIndexSubstring(index->codes + (size_t) i * index->numOfWords, t)]++] = i;
+		}
+		for (int b=NUM_OF_BUCKETS; b>0; b--) {
+			starts[b] = starts[b-1];
+		}
+		starts[0] = 0;
+	}
+	return index;
+}
+
+void spHammingIndexDestroy(SPHammingIndex* index) {
+	if (index == NULL) {
+		return;
+	}
+	free(index->codes);
+	free(index->imageIndexes);
+	free(index->bucketStarts);
+	free(index->bucketFeatures);
+	free(index);
+}
+
+int spHammingIndexGetSize(SPHammingIndex* index) {
+	return (index == NULL) ? -1 : index->size;
+}
+
+/**
+ * Returns true if a feature probed in table at substring distance radius was already checked,
+ * i.e if one of its substrings is closer to the query's, or as close in an earlier table.
+ */
+static bool spHammingIndexIsChecked(SPHammingIndex* index, const uint64_t* code, const uint64_t* query, int table,
+		int radius) {
+	for (int t=0; t<index->dim; t++) {
+		int distance = spHammingIndexPopcount(spHammingIndexSubstring(code, t) ^ spHammingIndexSubstring(query, t));
+		if (distance < radius || (distance == radius && t < table)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Adds the image index of feature to bpq, by its Hamming distance from the query.
+ * Returns false in case of allocation failure.
+ */
+static bool spHammingIndexCheck(SPHammingIndex* index, SPBPQueue* bpq, int feature, const uint64_t* query) {
+	const uint64_t* code = index->codes + (size_t) feature * index->numOfWords;
+	int distance = 0;
+	for (int w=0; w<index->numOfWords; w++) {
+		distance += spHammingIndexPopcount(code[w] ^ query[w]);
+	}
+	return spBPQueueEnqueue(bpq, index->imageIndexes[feature], (double) distance) != SP_BPQUEUE_OUT_OF_MEMORY;
+}
+
+/**
+ * The search of spHammingIndexGetKNN and spHammingIndexGetKNNBounded, maxChecks is 0 for an exact search.
+ */
+static int spHammingIndexSearch(SPHammingIndex* index, SPBPQueue* bpq, SPPoint* point, int maxChecks) {
+	if (index==NULL || bpq==NULL || point==NULL || spPointGetDimension(point) != index->dim) {
+		return -1;
+	}
+	uint64_t* query = (uint64_t*) malloc(index->numOfWords * sizeof(uint64_t));
+	if (query == NULL || !spHammingIndexPack(point, index->dim, query)) {
+		free(query);
+		return -1;
+	}
+	bool success = true;
+	int checks = 0;
+	for (int radius=0; radius<=SUBSTRING_BITS && success; radius++) {
+		//probing a distance costs a bucket for each mask of radius bits in each table, so once that's more
+		//than the features, the features which weren't checked yet are scanned instead
+		if (spHammingIndexBinomial(SUBSTRING_BITS, radius) * index->dim > index->size) {
+			for (int i=0; i<index->size && success; i++) {
+				const uint64_t* code = index->codes + (size_t) i * index->numOfWords;
+				if (radius == 0 || !spHammingIndexIsChecked(index, code, query, 0, radius)) {
+					success = spHammingIndexCheck(index, bpq, i, query);
+				}
+			}
+			break;
+		}
+		for (int t=0; t<index->dim && success; t++) {
+			unsigned int substring = spHammingIndexSubstring(query, t);
+			const int* starts = index->bucketStarts + (size_t) t * (NUM_OF_BUCKETS + 1);
+			const int* features = index->bucketFeatures + (size_t) t * index->size;
+			unsigned int mask = (1u << radius) - 1; //the smallest mask of radius bits
+			while (mask < NUM_OF_BUCKETS && success) {
+				unsigned int bucket = substring ^ mask;
+				for (int j=starts[bucket]; j<starts[bucket+1] && success; j++) {
+					const uint64_t* code = index->codes + (size_t) features[j] * index->numOfWords;
+					if (!spHammingIndexIsChecked(index, code, query, t, radius)) {
+						success = spHammingIndexCheck(index, bpq, features[j], query);
+						checks++;
+					}
+				}
+				if (mask == 0) {
+					break;
+				}
+				//the next mask of radius bits (Gosper's hack)
+				unsigned int lowest = mask & (~mask + 1);
+				unsigned int ripple = mask + lowest;
+				mask = (((ripple ^ mask) >> 2) / lowest) | ripple;
+			}
+		}
+		//every feature within distance dim*(radius+1)-1 of the query was checked
+		if (success && spBPQueueIsFull(bpq) && (spBPQueueMaxValue(bpq) < index->dim * (radius + 1)
+				|| (maxChecks > 0 && checks >= maxChecks))) {
+			break;
+		}
+	}
+	free(query);
+	return success ? 1 : -1;
+}
+
+int spHammingIndexGetKNN(SPHammingIndex* index, SPBPQueue* bpq, SPPoint* point) {
+	return spHammingIndexSearch(index, bpq, point, 0);
+}
+
+int spHammingIndexGetKNNBounded(SPHammingIndex* index, SPBPQueue* bpq, SPPoint* point, int maxChecks) {
+	if (maxChecks < 1) {
+		return -1;
+	}
+	return spHammingIndexSearch(index, bpq, point, maxChecks);
+}
+
+int spHammingIndexDistance(SPPoint* p, SPPoint* q) {
+	assert(p!=NULL && q!=NULL && spPointGetDimension(p)==spPointGetDimension(q));
+	int distance = 0;
+	for (int i=0; i<spPointGetDimension(p); i++) {
+		uint64_t pWord, qWord;
+		if (!spHammingIndexGetWord(p, i, &pWord) || !spHammingIndexGetWord(q, i, &qWord)) {
+			return -1;
+		}
+		distance += spHammingIndexPopcount(pWord ^ qWord);
+	}
+	return distance;
+}
@@ -0,0 +1,103 @@
+#ifndef SPHAMMINGINDEX_H_
+#define SPHAMMINGINDEX_H_
+#include <stdbool.h>
+#include "SPPoint.h"
+#include "SPBPriorityQueue.h"
+
+/**
+ * SP Hamming Index summary
+ * Indexes binary features (e.g ORB descriptors) for K-Nearest Neighbors search by Hamming distance.
+ * A binary feature is an SPPoint each of whose coordinates holds 16 bits of the descriptor, as an
+ * integer in [0, 2^16) - exactly representable by the floats of the feats files and the database.
+ * The codes are kept bit-packed, 64 bits per word, and compared by popcount.
+ *
+ * The index is a multi-index hash: each coordinate is a 16-bit substring of the code, and each
+ * coordinate has a table of the features by the value of their substring. A search probes the buckets
+ * of the tables in growing Hamming distance r from the substrings of the query. A code within distance
+ * m*(r+1)-1 of the query (m substrings) has a substring within distance r of the query's, so the search
+ * ends once the K nearest features found are closer than that. The result is the same as a linear
+ * scan's, which the search falls back to when probing a distance would cost more.
+ *
+ * The following functions are supported:
+ *
+ * spHammingIndexBuild			- Builds the index of binary features
+ * spHammingIndexDestroy		- Free all resources associated with an index
+ * spHammingIndexGetSize		- A getter of the number of features
+ * spHammingIndexGetKNN			- K-Nearest Neighbors search
+ * spHammingIndexGetKNNBounded	- Approximate K-Nearest Neighbors search with a bounded number of checks
+ * spHammingIndexDistance		- The Hamming distance of two binary features
+ */
+
+/** type used to define the index **/
+typedef struct sp_hamming_index_t SPHammingIndex;
+
+/**
+ * Allocates a new index of the binary features in the memory.
+ * The codes of the features are copied, so the points needn't outlive the index.
+ *
+ * @param points - the binary features, all of dimension dim
+ * @param size	 - the number of features
+ * @param dim	 - the number of 16-bit words of each feature
+ *
+ * @return
+ * NULL in case of allocation failure, or points==NULL or size<=0 or dim<=0,
+ * or a point whose dimension isn't dim or whose coordinates aren't 16-bit words
+ * Otherwise, the new index is returned
+ */
+SPHammingIndex* spHammingIndexBuild(SPPoint** points, int size, int dim);
+
+/**
+ * Frees all memory allocation associated with the index,
+ * if index is NULL nothing happens.
+ */
+void spHammingIndexDestroy(SPHammingIndex* index);
+
+/**
+ * A getter of the number of features in the index.
+ *
+ * @return
+ * -1 if index==NULL, otherwise the number of features
+ */
+int spHammingIndexGetSize(SPHammingIndex* index);
+
+/**
+ * K-Nearest Neighbors Search by Hamming distance. The image index of each of the spKNN nearest
+ * features is stored in bpq, with its Hamming distance from point as the value.
+ *
+ * @param index - the index to search in
+ * @param bpq 	- the BPQueue used to store the K-Nearest Neighbors in, its maximal size is K
+ * @param point - the binary feature used to search the K-Nearest Neighbors for
+ *
+ * @return
+ * -1 if the search failed, or point isn't a binary feature of the dimension of the index
+ * Otherwise, 1
+ */
+int spHammingIndexGetKNN(SPHammingIndex* index, SPBPQueue* bpq, SPPoint* point);
+
+/**
+ * Approximate K-Nearest Neighbors Search with a bounded number of checks.
+ * Like spHammingIndexGetKNN, except that once <maxChecks> features were checked, the search stops
+ * at the end of the current distance as long as the BPQueue is full.
+ * The result may thus miss some of the true K-Nearest Neighbors, in exchange for a bounded search time.
+ *
+ * @param index 	- the index to search in
+ * @param bpq 		- the BPQueue used to store the K-Nearest Neighbors in
+ * @param point 	- the binary feature used to search the K-Nearest Neighbors for
+ * @param maxChecks - the number of features checked before the search may stop
+ *
+ * @return
+ * -1 if the search failed, or maxChecks<1
+ * Otherwise, 1
+ */
+int spHammingIndexGetKNNBounded(SPHammingIndex* index, SPBPQueue* bpq, SPPoint* point, int maxChecks);
+
+/**
+ * The Hamming distance of two binary features, i.e the number of bits they differ in.
+ *
+ * @assert p != NULL AND q != NULL AND p and q are of the same dimension
+ * @return
+ * The Hamming distance, or -1 if the coordinates of p or q aren't 16-bit words
+ */
+int spHammingIndexDistance(SPPoint* p, SPPoint* q);
+
+#endif /* SPHAMMINGINDEX_H_ */
@@ -0,0 +1,223 @@
+#include "SPImageCatalogue.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#define COMMENT_CHAR '#'
+#define INITIAL_CAPACITY 64
+
+/**
+ * An image as read from the catalogue file, before the images are ordered by id.
+ */
+typedef struct catalogue_entry_t {
+	int id;
+	size_t offset;
+} CatalogueEntry;
+
+struct sp_image_catalogue_t {
+	int numOfImages;
+	char* paths;		// the paths, each terminated by '\0', one after another
+	size_t* offsets;	// the offset of the path of each image in paths, by id
+};
+
+static bool isBlank(char c) {
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/**
+ * Grows a buffer to hold at least <needed> elements of <size> bytes, doubling its capacity.
+ *
+ * @return
+ * false in case of allocation failure (the buffer is left as is), true otherwise
+ */
+static bool reserve(void** buffer, size_t* capacity, size_t needed, size_t size) {
+	if (needed <= *capacity) {
+		return true;
+	}
+	size_t newCapacity = (*capacity > 0) ? *capacity : INITIAL_CAPACITY;
+	while (newCapacity < needed) {
+		newCapacity *= 2;
+	}
+	void* grown = realloc(*buffer, newCapacity * size);
+	if (grown == NULL) { //Allocation failure
+		return false;
+	}
+	*buffer = grown;
+	*capacity = newCapacity;
+	return true;
+}
+
+/**
+ * Parses a catalogue line into its id and path, trimming the whitespace around the path.
+ *
+ * @return
+ * false if the line has no valid id followed by whitespace and a path, true otherwise
+ */
+static bool parseLine(char* line, int* id, char** path) {
+	char* position = line;
+	while (isBlank(*position)) {
+		position++;
+	}
+	if (*position < '0' || *position > '9') {
+		return false;
+	}
+	long value = 0;
+	while (*position >= '0' && *position <= '9') {
+		value = value*10 + (*position - '0');
+		if (value > INT_MAX) {
+			return false;
+		}
+		position++;
+	}
+	if (*position != ' ' && *position != '\t') {
+		return false;
+	}
+	while (isBlank(*position)) {
+		position++;
+	}
+	size_t length = strlen(position);
+	while (length > 0 && isBlank(position[length-1])) {
+		length--;
+	}
+	if (length == 0) {
+		return false;
+	}
+	position[length] = '\0';
+	*id = (int) value;
+	*path = position;
+	return true;
+}
+
+SPImageCatalogue* spImageCatalogueLoad(const char* path, const char* baseDirectory, int maxPathLength,
+		int* lineNumber, SP_IMAGE_CATALOGUE_MSG* msg) {
+	if (msg == NULL) {
+		return NULL;
+	}
+	if (path==NULL || baseDirectory==NULL || maxPathLength<=0 || lineNumber==NULL) {
+		*msg = SP_IMAGE_CATALOGUE_INVALID_ARGUMENT;
+		return NULL;
+	}
+	*lineNumber = 0;
+	FILE* file = fopen(path, "r");
+	if (file == NULL) {
+		*msg = SP_IMAGE_CATALOGUE_CANNOT_OPEN;
+		return NULL;
+	}
+
+	// a line holds an id, whitespace and a path, anything longer is invalid anyway
+	size_t lineSize = (size_t) maxPathLength + 64;
+	char* line = (char*) malloc(lineSize);
+	size_t baseLength = strlen(baseDirectory);
+	char* paths = NULL;
+	size_t pathsSize = 0, pathsCapacity = 0;
+	CatalogueEntry* entries = NULL;
+	size_t numOfEntries = 0, entriesCapacity = 0;
+	*msg = (line == NULL) ? SP_IMAGE_CATALOGUE_OUT_OF_MEMORY : SP_IMAGE_CATALOGUE_SUCCESS;
+
+	// streaming the lines, appending each path to the paths buffer
+	while (*msg == SP_IMAGE_CATALOGUE_SUCCESS && fgets(line, (int) lineSize, file) != NULL) {
+		(*lineNumber)++;
+		size_t length = strlen(line);
+		if (length == lineSize - 1 && line[length-1] != '\n' && !feof(file)) { // the line didn't fit
+			*msg = SP_IMAGE_CATALOGUE_INVALID_LINE;
+			break;
+		}
+		char* start = line;
+		while (isBlank(*start)) {
+			start++;
+		}
+		if (*start == '\0' || *start == COMMENT_CHAR) {
+			continue;
+		}
+		int id;
+		char* imagePath;
+		if (!parseLine(line, &id, &imagePath)) {
+			*msg = SP_IMAGE_CATALOGUE_INVALID_LINE;
+			break;
+		}
+		bool isRelative = imagePath[0] != '/';
+		size_t pathLength = strlen(imagePath) + (isRelative ? baseLength : 0);
+		if (pathLength > (size_t) maxPathLength) {
+			*msg = SP_IMAGE_CATALOGUE_INVALID_LINE;
+			break;
+		}
+		if (!reserve((void**) &paths, &pathsCapacity, pathsSize + pathLength + 1, sizeof(char))
+				|| !reserve((void**) &entries, &entriesCapacity, numOfEntries + 1, sizeof(CatalogueEntry))) {
+			*msg = SP_IMAGE_CATALOGUE_OUT_OF_MEMORY;
+			break;
+		}
+		entries[numOfEntries].id = id;
+		entries[numOfEntries].offset = pathsSize;
+		numOfEntries++;
+		if (isRelative) {
+			memcpy(paths + pathsSize, baseDirectory, baseLength);
+			pathsSize += baseLength;
+		}
+		strcpy(paths + pathsSize, imagePath);
+		pathsSize += strlen(imagePath) + 1;
+	}
+	free(line);
+	fclose(file);
+
+	// ordering the paths by id, each id 0 to numOfEntries-1 exactly once
+	SPImageCatalogue* catalogue = NULL;
+	if (*msg == SP_IMAGE_CATALOGUE_SUCCESS) {
+		*lineNumber = 0;
+		catalogue = (SPImageCatalogue*) malloc(sizeof(*catalogue));
+		size_t* offsets = (numOfEntries > 0 && numOfEntries <= INT_MAX)
+				? (size_t*) malloc(numOfEntries * sizeof(size_t)) : NULL;
+		bool* seen = (offsets != NULL) ? (bool*) calloc(numOfEntries, sizeof(bool)) : NULL;
+		if (numOfEntries == 0 || numOfEntries > INT_MAX) {
+			*msg = SP_IMAGE_CATALOGUE_MISSING_ID;
+		} else if (catalogue == NULL || offsets == NULL || seen == NULL) { //Allocation failure
+			*msg = SP_IMAGE_CATALOGUE_OUT_OF_MEMORY;
+		}
+		for (size_t i=0; i<numOfEntries && *msg == SP_IMAGE_CATALOGUE_SUCCESS; i++) {
+			size_t id = (size_t) entries[i].id;
+			if (id >= numOfEntries) { // with numOfEntries entries, a larger id means another is missing
+				*msg = SP_IMAGE_CATALOGUE_MISSING_ID;
+			} else if (seen[id]) {
+				*msg = SP_IMAGE_CATALOGUE_DUPLICATE_ID;
+			} else {
+				seen[id] = true;
+				offsets[id] = entries[i].offset;
+			}
+		}
+		free(seen);
+		if (*msg == SP_IMAGE_CATALOGUE_SUCCESS) {
+			catalogue->numOfImages = (int) numOfEntries;
+			catalogue->offsets = offsets;
+			catalogue->paths = paths;
+			paths = NULL;
+		} else {
+			free(offsets);
+			free(catalogue);
+			catalogue = NULL;
+		}
+	}
+	free(entries);
+	free(paths);
+	return catalogue;
+}
+
+void spImageCatalogueDestroy(SPImageCatalogue* catalogue) {
+	if (catalogue == NULL) {
+		return;
+	}
+	free(catalogue->paths);
+	free(catalogue->offsets);
+	free(catalogue);
+}
+
+int spImageCatalogueGetNumOfImages(const SPImageCatalogue* catalogue) {
+	return (catalogue == NULL) ? -1 : catalogue->numOfImages;
+}
+
+const char* spImageCatalogueGetPath(const SPImageCatalogue* catalogue, int id) {
+	if (catalogue == NULL || id < 0 || id >= catalogue->numOfImages) {
+		return NULL;
+	}
+	return catalogue->paths + catalogue->offsets[id];
+}
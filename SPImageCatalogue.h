@@ -0,0 +1,82 @@
+#ifndef SPIMAGECATALOGUE_H_
+#define SPIMAGECATALOGUE_H_
+
+/**
+ * SP Image Catalogue summary
+ * Maps the ids of the images (0 to the number of images - 1) to their paths, which may be spread
+ * over any directories, e.g. hash-sharded subdirectories, instead of following a single
+ * prefix<id>suffix naming scheme in one flat directory.
+ *
+ * The catalogue file is a text file with a line per image - its id, whitespace, and its path (the
+ * rest of the line, so it may contain spaces). A path which doesn't start with '/' is relative to
+ * the base directory given when loading. Blank lines and lines starting with '#' are skipped, and
+ * the lines may come in any order, but each id must appear exactly once.
+ *
+ * The file is streamed a line at a time, and the paths are kept one after another in a single
+ * buffer, so a catalogue of millions of images costs about the length of its paths.
+ *
+ * The following functions are supported:
+ *
+ * spImageCatalogueLoad				- Loads a catalogue file
+ * spImageCatalogueDestroy			- Free all resources associated with a catalogue
+ * spImageCatalogueGetNumOfImages	- A getter of the number of images
+ * spImageCatalogueGetPath			- A getter of the path of an image
+ */
+
+/** type used to define the catalogue **/
+typedef struct sp_image_catalogue_t SPImageCatalogue;
+
+/** type for error reporting **/
+typedef enum sp_image_catalogue_msg_t {
+	SP_IMAGE_CATALOGUE_CANNOT_OPEN,
+	SP_IMAGE_CATALOGUE_INVALID_LINE,		// a line without an id and a path, or a path which is too long
+	SP_IMAGE_CATALOGUE_DUPLICATE_ID,
+	SP_IMAGE_CATALOGUE_MISSING_ID,			// the ids aren't 0 to the number of images - 1, or there are none
+	SP_IMAGE_CATALOGUE_OUT_OF_MEMORY,
+	SP_IMAGE_CATALOGUE_INVALID_ARGUMENT,
+	SP_IMAGE_CATALOGUE_SUCCESS
+} SP_IMAGE_CATALOGUE_MSG;
+
+/**
+ * Loads a catalogue file.
+ *
+ * @param path 			- the path of the catalogue file
+ * @param baseDirectory - the directory the relative paths are relative to, ending with '/'
+ * @param maxPathLength - the maximal length of a path, once the base directory is prepended
+ * @param lineNumber 	- pointer in which the line of the error is stored (0 if it isn't a line's)
+ * @param msg 			- pointer in which the msg returned by the function is stored
+ *
+ * @return
+ * NULL in case of failure (see msg and lineNumber)
+ * Otherwise, the loaded catalogue
+ */
+SPImageCatalogue* spImageCatalogueLoad(const char* path, const char* baseDirectory, int maxPathLength,
+		int* lineNumber, SP_IMAGE_CATALOGUE_MSG* msg);
+
+/**
+ * Frees all memory allocation associated with the catalogue.
+ * If catalogue is NULL nothing happens.
+ */
+void spImageCatalogueDestroy(SPImageCatalogue* catalogue);
+
+/**
+ * A getter of the number of images of the catalogue.
+ *
+ * @return
+ * -1 if catalogue == NULL, otherwise the number of images
+ */
+int spImageCatalogueGetNumOfImages(const SPImageCatalogue* catalogue);
+
+/**
+ * A getter of the path of an image, with the base directory prepended if it's relative.
+ *
+ * @param catalogue - the catalogue
+ * @param id 		- the id of the image
+ *
+ * @return
+ * NULL if catalogue == NULL or id is out of range
+ * Otherwise, the path of the image, owned by the catalogue
+ */
+const char* spImageCatalogueGetPath(const SPImageCatalogue* catalogue, int id);
+
+#endif /* SPIMAGECATALOGUE_H_ */
@@ -2,11 +2,15 @@
 #include <cassert>
 #include <cstring>
 #include <opencv2/xfeatures2d.hpp>
+#include <opencv2/features2d.hpp>
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/highgui.hpp>
 #include <cstdio>
+#include <algorithm>
+#include <condition_variable>
+#include <thread>
 #include "SPImageProc.h"
 extern "C" {
 #include "SPLogger.h"
@@ -33,6 +37,137 @@ using namespace std;
 #define MINIMAL_GUI_NOT_SET_WARNING "Cannot display images in non-Minimal-GUI mode"
 #define ALLOC_ERROR_MSG "Allocation error"
 #define INVALID_ARG_ERROR "Invalid arguments"
+#define PCA_PROJECTION_ERROR "The PCA doesn't project to the PCA dimension"
+#define NUM_OF_THREADS_ERROR "Number of extraction threads couldn't be resolved"
+#define MAX_IMAGE_DIMENSION_ERROR "Maximal image dimension couldn't be resolved"
+#define FEATURE_TYPE_ERROR "Feature type couldn't be resolved"
+#define ORB_DESCRIPTOR_ERROR "The ORB descriptors aren't of 256 bits"
+#define THREAD_ERROR "Couldn't create an extraction thread"
+#define NO_DESCRIPTORS_ERROR "No SIFT descriptors were extracted to train the PCA"
+#define SPILL_CREATE_WARNING "Couldn't create a temporary file for the training descriptors, the images will be extracted again"
+#define SPILL_WRITE_WARNING "Couldn't write the training descriptors, the images will be extracted again"
+
+struct sp::ImageProc::Extractor {
+	//The SIFT or ORB feature extractor and descriptor
+	Ptr<Feature2D> detector;
+	//To store the keypoints that will be extracted by the detector
+	vector<KeyPoint> keypoints;
+	//To store the descriptor of current image, and its PCA projection (also in the points' precision)
+	Mat descriptor;
+	Mat projected;
+	Mat coordinates;
+};
+
+struct sp::ImageProc::TrainingDescriptors {
+	//The raw descriptors of the images, one after the other, removed once closed
+	FILE* file;
+	//Where the descriptors of each image start, and their size - no rows if they weren't kept
+	vector<long> offsets;
+	vector<int> rows;
+	vector<int> cols;
+	mutex lock;
+
+	explicit TrainingDescriptors(int numOfImages) :
+			file(tmpfile()), offsets(numOfImages, 0), rows(numOfImages, 0), cols(numOfImages, 0) {
+		if (!file) {
+			spLoggerPrintWarning(SPILL_CREATE_WARNING, __FILE__, __func__, __LINE__);
+		}
+	}
+
+	~TrainingDescriptors() {
+		if (file) {
+			fclose(file);
+		}
+	}
+
+	// Appends the descriptors of image <index>, called in the order of the images
+	void append(int index, const Mat& descriptor) {
+		lock_guard<mutex> guard(lock);
+		if (!file || descriptor.empty() || descriptor.type() != CV_32F || !descriptor.isContinuous()) {
+			return;
+		}
+		size_t count = descriptor.total();
+		long offset = ftell(file);
+		if (offset < 0 || fwrite(descriptor.ptr<float>(0), sizeof(float), count, file) != count) {
+			spLoggerPrintWarning(SPILL_WRITE_WARNING, __FILE__, __func__, __LINE__);
+			fclose(file);
+			file = NULL;
+			return;
+		}
+		offsets[index] = offset;
+		rows[index] = descriptor.rows;
+		cols[index] = descriptor.cols;
+	}
+
+	// Reads the descriptors of image <index>, false if they weren't kept
+	bool read(int index, Mat& descriptor) {
+		lock_guard<mutex> guard(lock);
+		if (!file || index < 0 || index >= static_cast<int>(rows.size()) || rows[index] < 1) {
+			return false;
+		}
+		descriptor.create(rows[index], cols[index], CV_32F);
+		size_t count = descriptor.total();
+		return fseek(file, offsets[index], SEEK_SET) == 0
+				&& fread(descriptor.ptr<float>(0), sizeof(float), count, file) == count;
+	}
+};
+
+struct sp::ImageProc::Training {
+	SPConfig config;
+	atomic<int> nextImage;
+	atomic<bool> failed;
+	//The descriptors of the images are merged in the order of the images, so the trained PCA
+	//doesn't depend on the scheduling of the workers
+	mutex lock;
+	condition_variable turn;
+	int nextMerged;
+	//Where the descriptors are spilled to, so the extraction needn't compute them again
+	TrainingDescriptors* spill;
+	//The number of descriptors merged, their mean and their scatter matrix (the unscaled covariance)
+	double count;
+	Mat mean;
+	Mat scatter;
+
+	Training(const SPConfig config, TrainingDescriptors* spill) :
+			config(config), nextImage(0), failed(false), nextMerged(0), spill(spill), count(0) {
+	}
+
+	// Waits for the turn of image <index>, merges its descriptors (Chan et al.) and spills them
+	bool merge(int index, const Mat& descriptor, const Mat& batchMean, const Mat& batchScatter,
+			int batchCount) {
+		unique_lock<mutex> guard(lock);
+		turn.wait(guard, [&] { return failed || nextMerged == index; });
+		if (failed) {
+			return false;
+		}
+		if (batchCount > 0 && count == 0) {
+			batchMean.copyTo(mean);
+			batchScatter.copyTo(scatter);
+		} else if (batchCount > 0) {
+			double total = count + batchCount;
+			Mat delta = batchMean - mean;
+			Mat outer;
+			gemm(delta, delta, count * batchCount / total, Mat(), 0, outer, GEMM_1_T);
+			scatter += batchScatter;
+			scatter += outer;
+			mean += delta * (batchCount / total);
+		}
+		if (spill && batchCount > 0) {
+			spill->append(index, descriptor);
+		}
+		count += batchCount;
+		nextMerged++;
+		turn.notify_all();
+		return true;
+	}
+
+	// Ends the training, waking the workers waiting for their turn
+	void fail() {
+		lock_guard<mutex> guard(lock);
+		failed = true;
+		turn.notify_all();
+	}
+};
 
 void sp::ImageProc::initFromConfig(const SPConfig config) {
 	SP_CONFIG_MSG msg = SP_CONFIG_SUCCESS;
@@ -56,56 +191,146 @@ void sp::ImageProc::initFromConfig(const SPConfig config) {
 		spLoggerPrintError(MINIMAL_GUI_ERROR, __FILE__, __func__, __LINE__);
 		throw Exception();
 	}
+	numOfThreads = spConfigGetNumOfExtractThreads(config, &msg);
+	if (msg != SP_CONFIG_SUCCESS) {
+		spLoggerPrintError(NUM_OF_THREADS_ERROR, __FILE__, __func__, __LINE__);
+		throw Exception();
+	}
+	maxImageDimension = spConfigGetMaxImageDimension(config, &msg);
+	if (msg != SP_CONFIG_SUCCESS) {
+		spLoggerPrintError(MAX_IMAGE_DIMENSION_ERROR, __FILE__, __func__, __LINE__);
+		throw Exception();
+	}
+	featureType = spConfigGetFeatureType(config, &msg);
+	if (msg != SP_CONFIG_SUCCESS) {
+		spLoggerPrintError(FEATURE_TYPE_ERROR, __FILE__, __func__, __LINE__);
+		throw Exception();
+	}
 }
 
-void sp::ImageProc::getImagesMat(vector<Mat>& images, const SPConfig config) {
-	char warningMSG[WARNING_MSG_LENGTH] = { '\0' };
-	for (int i = 0; i < numOfImages; i++) {
-		char imagePath[STRING_LENGTH + 1] = { '\0' };
-		if (spConfigGetImagePath(imagePath, config, i) != SP_CONFIG_SUCCESS) {
-			spLoggerPrintError(IMAGE_PATH_ERROR, __FILE__, __func__, __LINE__);
-			throw Exception();
-		}
-		Mat img = imread(imagePath, IMREAD_GRAYSCALE);
-		if (img.empty()) {
-			sprintf(warningMSG, "%s %s", imagePath, IMAGE_NOT_EXIST_MSG);
-			spLoggerPrintWarning(warningMSG, __FILE__, __func__, __LINE__);
-			continue;
+Mat sp::ImageProc::decodeImage(const char* imagePath) {
+	Mat img = imread(imagePath, IMREAD_GRAYSCALE);
+	int largest = max(img.rows, img.cols);
+	if (maxImageDimension <= 0 || largest <= maxImageDimension) {
+		return img;
+	}
+	// the largest side is scaled to maxImageDimension, averaging the pixels so the image doesn't alias
+	double scale = (double) maxImageDimension / largest;
+	Size size(max(1, (int) (img.cols * scale + 0.5)), max(1, (int) (img.rows * scale + 0.5)));
+	Mat downscaled;
+	resize(img, downscaled, size, 0, 0, INTER_AREA);
+	return downscaled;
+}
+
+unique_ptr<sp::ImageProc::Extractor> sp::ImageProc::acquireExtractor() {
+	{
+		lock_guard<mutex> lock(extractorsMutex);
+		if (!idleExtractors.empty()) {
+			unique_ptr<Extractor> extractor = move(idleExtractors.back());
+			idleExtractors.pop_back();
+			return extractor;
 		}
-		images.push_back(img);
 	}
+	// all the detectors are in use, so the pool grows by one for this thread
+	unique_ptr<Extractor> extractor(new Extractor());
+	if (featureType == ORB_FEATURES) {
+		extractor->detector = ORB::create(numOfFeatures);
+	} else {
+		extractor->detector = xfeatures2d::SIFT::create(numOfFeatures);
+	}
+	return extractor;
 }
 
-void sp::ImageProc::getFeatures(vector<Mat>& images, Mat& features) {
-	//To store the keypoints that will be extracted by SIFT
-	vector<KeyPoint> keypoints;
-	//To store the SIFT descriptor of current image
-	Mat descriptor;
-	//To store all the descriptors that are extracted from all the images.
+void sp::ImageProc::releaseExtractor(unique_ptr<Extractor> extractor) {
+	if (!extractor) {
+		return;
+	}
+	lock_guard<mutex> lock(extractorsMutex);
+	idleExtractors.push_back(move(extractor));
+}
 
-	//The SIFT feature extractor and descriptor
-	Ptr<xfeatures2d::SiftDescriptorExtractor> detector =
-			xfeatures2d::SIFT::create(numOfFeatures);
+void sp::ImageProc::getFeaturesWorker(Training* training) {
+	char warningMSG[WARNING_MSG_LENGTH] = { '\0' };
+	char imagePath[STRING_LENGTH + 1] = { '\0' };
+	try {
+		unique_ptr<Extractor> extractor = acquireExtractor();
+		for (int i = training->nextImage++; i < numOfImages && !training->failed; i = training->nextImage++) {
+			Mat batchMean, batchScatter;
+			int batchCount = 0;
+			if (spConfigGetImagePath(imagePath, training->config, i) != SP_CONFIG_SUCCESS) {
+				spLoggerPrintError(IMAGE_PATH_ERROR, __FILE__, __func__, __LINE__);
+				training->fail();
+				break;
+			}
+			Mat img = decodeImage(imagePath);
+			if (img.empty()) {
+				sprintf(warningMSG, "%s %s", imagePath, IMAGE_NOT_EXIST_MSG);
+				spLoggerPrintWarning(warningMSG, __FILE__, __func__, __LINE__);
+			} else {
+				computeDescriptors(img, *extractor);
+				batchCount = extractor->descriptor.rows;
+			}
+			//the mean and scatter of the image are computed in parallel, only merging them waits
+			if (batchCount > 0) {
+				calcCovarMatrix(extractor->descriptor, batchScatter, batchMean, COVAR_NORMAL | COVAR_ROWS,
+						CV_64F);
+				batchMean.convertTo(batchMean, CV_64F);
+			}
+			if (!training->merge(i, extractor->descriptor, batchMean, batchScatter, batchCount)) {
+				break;
+			}
+		}
+		releaseExtractor(move(extractor));
+	} catch (...) {
+		training->fail();
+	}
+}
 
-	//feature descriptors and build the vocabulary
-	for (int i = 0; i < static_cast<int>(images.size()); i++) {
-		//detect feature points
-		detector->detect(images[i], keypoints);
-		//compute the descriptors for each keypoint
-		detector->compute(images[i], keypoints, descriptor);
-		//put the all feature descriptors in a single Mat object
-		features.push_back(descriptor);
+void sp::ImageProc::getFeatures(Training* training) {
+	// no point in more workers than images
+	int numOfWorkers = min(numOfThreads, numOfImages);
+	if (numOfWorkers <= 1) { // extracting on the calling thread
+		getFeaturesWorker(training);
+	} else {
+		vector<thread> workers;
+		for (int t = 0; t < numOfWorkers; t++) {
+			try {
+				workers.push_back(thread(&ImageProc::getFeaturesWorker, this, training));
+			} catch (std::exception& ex) { // thread creation failed
+				spLoggerPrintError(THREAD_ERROR, __FILE__, __func__, __LINE__);
+				training->fail();
+				break;
+			}
+		}
+		for (size_t t = 0; t < workers.size(); t++) {
+			workers[t].join();
+		}
+	}
+	if (training->failed) {
+		throw Exception();
+	}
+	if (training->count == 0) {
+		spLoggerPrintError(NO_DESCRIPTORS_ERROR, __FILE__, __func__, __LINE__);
+		throw Exception();
 	}
 }
 
 void sp::ImageProc::preprocess(const SPConfig config) {
 	try {
-		vector<Mat> images;
-		Mat features;
+		trainingDescriptors.reset(new TrainingDescriptors(numOfImages));
+		Training training(config, trainingDescriptors.get());
+		Mat eigenvalues, eigenvectors;
 		char pcaPath[STRING_LENGTH + 1] = { '\0' };
-		getImagesMat(images, config);
-		getFeatures(images, features);
-		pca = PCA(features, Mat(), CV_PCA_DATA_AS_ROW, pcaDim);
+		getFeatures(&training);
+		//the principal components are the eigenvectors of the covariance with the largest eigenvalues,
+		//kept in the type of the descriptors as cv::PCA does. The scatter is scaled by the number of
+		//descriptors first, so the eigenvalues are those of the covariance cv::PCA writes (CV_COVAR_SCALE)
+		training.scatter /= training.count;
+		eigen(training.scatter, eigenvalues, eigenvectors);
+		int numOfComponents = min(pcaDim, eigenvectors.rows);
+		eigenvectors.rowRange(0, numOfComponents).convertTo(pca.eigenvectors, CV_32F);
+		eigenvalues.rowRange(0, numOfComponents).convertTo(pca.eigenvalues, CV_32F);
+		training.mean.convertTo(pca.mean, CV_32F);
 		if (spConfigGetPCAPath(pcaPath, config) != SP_CONFIG_SUCCESS) {
 			spLoggerPrintError(PCA_FILE_NOT_RESOLVED, __FILE__, __func__,
 			__LINE__);
@@ -143,16 +368,27 @@ void sp::ImageProc::initPCAFromFile(const SPConfig config) {
 	fs.release();
 }
 
-sp::ImageProc::ImageProc(const SPConfig config) {
+// the PCA is trained in extraction mode, and loaded from the PCA file otherwise
+static bool isExtractionMode(const SPConfig config) {
+	SP_CONFIG_MSG msg;
+	return config && spConfigIsExtractionMode(config, &msg);
+}
+
+sp::ImageProc::ImageProc(const SPConfig config) :
+		ImageProc(config, isExtractionMode(config)) {
+}
+
+sp::ImageProc::ImageProc(const SPConfig config, bool trainPCA) {
 	try {
 		if (!config) {
 			spLoggerPrintError(INVALID_ARG_ERROR, __FILE__, __func__, __LINE__);
 			throw Exception();
 		}
-		SP_CONFIG_MSG msg;
-		bool preprocMode = false;
 		initFromConfig(config);
-		if ((preprocMode = spConfigIsExtractionMode(config, &msg))) {
+		if (featureType == ORB_FEATURES) { // the binary descriptors aren't projected
+			return;
+		}
+		if (trainPCA) {
 			preprocess(config);
 		} else {
 			initPCAFromFile(config);
@@ -163,49 +399,149 @@ sp::ImageProc::ImageProc(const SPConfig config) {
 	}
 }
 
+sp::ImageProc::~ImageProc() {
+}
+
 SPPoint** sp::ImageProc::getImageFeatures(const char* imagePath, int index,
 		int* numOfFeats) {
-	vector<KeyPoint> keypoints;
-	Mat descriptor, img, points;
-	double* pcaSift = NULL;
-	char errorMSG[STRING_LENGTH * 2];
-	Ptr<xfeatures2d::SiftDescriptorExtractor> detector;
 	if (!imagePath || !numOfFeats) {
 		spLoggerPrintError(INVALID_ARG_ERROR, __FILE__, __func__, __LINE__);
 		return NULL;
 	}
-	img = imread(imagePath, IMREAD_GRAYSCALE);
+	Mat img = loadImage(imagePath);
+	if (img.empty()) {
+		return NULL;
+	}
+	return getImageFeatures(img, index, numOfFeats);
+}
+
+Mat sp::ImageProc::loadImage(const char* imagePath) {
+	char errorMSG[STRING_LENGTH * 2];
+	if (!imagePath) {
+		spLoggerPrintError(INVALID_ARG_ERROR, __FILE__, __func__, __LINE__);
+		return Mat();
+	}
+	Mat img = decodeImage(imagePath);
 	if (img.empty()) {
 		sprintf(errorMSG, "%s %s", imagePath, IMAGE_NOT_EXIST_MSG);
 		spLoggerPrintError(errorMSG, __FILE__, __func__, __LINE__);
+	}
+	return img;
+}
+
+void sp::ImageProc::computeDescriptors(const Mat& img, Extractor& extractor) {
+	//detect feature points
+	extractor.detector->detect(img, extractor.keypoints);
+	// strongest keypoints first, so the query search can be decided by its leading features
+	stable_sort(extractor.keypoints.begin(), extractor.keypoints.end(),
+			[](const KeyPoint& a, const KeyPoint& b) {
+		return a.response > b.response;
+	});
+	//compute the descriptors for each keypoint
+	extractor.detector->compute(img, extractor.keypoints, extractor.descriptor);
+}
+
+SPPoint** sp::ImageProc::projectDescriptors(Extractor& extractor, int index, int* numOfFeats) {
+	Mat& descriptor = extractor.descriptor;
+	// the projection of pca.project, in the buffers of the extractor rather than in temporaries:
+	// the mean is subtracted from the descriptors in place, and all of them are projected by a single
+	// matrix multiply, converted to the precision of the points at once
+	for (int i = 0; i < descriptor.rows; i++) {
+		Mat row = descriptor.row(i);
+		subtract(row, pca.mean, row);
+	}
+	gemm(descriptor, pca.eigenvectors, 1, noArray(), 0, extractor.projected, GEMM_2_T);
+	extractor.projected.convertTo(extractor.coordinates, CV_64F);
+	Mat& points = extractor.coordinates;
+	if (points.cols != pcaDim) {
+		spLoggerPrintError(PCA_PROJECTION_ERROR, __FILE__, __func__, __LINE__);
 		return NULL;
 	}
-	detector = xfeatures2d::SIFT::create(numOfFeatures);
-	detector->detect(img, keypoints);
-	detector->compute(img, keypoints, descriptor);
-	points = pca.project(descriptor);
-	pcaSift = (double*) malloc(sizeof(double) * pcaDim);
-	if (!pcaSift) {
+	SPPoint** resPoints = (SPPoint**) malloc(sizeof(*resPoints) * points.rows);
+	if (!resPoints) {
 		spLoggerPrintError(ALLOC_ERROR_MSG, __FILE__, __func__, __LINE__);
 		return NULL;
 	}
+	// each point is created straight from its row of the projection
+	for (int i = 0; i < points.rows; i++) {
+		resPoints[i] = spPointCreate(points.ptr<double>(i), pcaDim, index);
+		if (!resPoints[i]) {
+			for (int j = 0; j < i; j++) {
+				spPointDestroy(resPoints[j]);
+			}
+			free(resPoints);
+			spLoggerPrintError(ALLOC_ERROR_MSG, __FILE__, __func__, __LINE__);
+			return NULL;
+		}
+	}
 	*numOfFeats = points.rows;
-	SPPoint** resPoints = (SPPoint**) malloc(sizeof(*resPoints) * points.rows);
+	return resPoints;
+}
+
+SPPoint** sp::ImageProc::packDescriptors(Extractor& extractor, int index, int* numOfFeats) {
+	Mat& descriptor = extractor.descriptor;
+	if (descriptor.rows > 0 && (descriptor.type() != CV_8U || descriptor.cols != ORB_FEATURE_DIM * 2)) {
+		spLoggerPrintError(ORB_DESCRIPTOR_ERROR, __FILE__, __func__, __LINE__);
+		return NULL;
+	}
+	SPPoint** resPoints = (SPPoint**) malloc(sizeof(*resPoints) * descriptor.rows);
 	if (!resPoints) {
-		free(pcaSift);
 		spLoggerPrintError(ALLOC_ERROR_MSG, __FILE__, __func__, __LINE__);
 		return NULL;
 	}
-	for (int i = 0; i < points.rows; i++) {
-		for (int j = 0; j < points.cols; j++) {
-			pcaSift[j] = (double) points.at<float>(i, j);
+	// every 2 bytes of a descriptor make a 16-bit word, which even the float feats files keep exactly
+	double words[ORB_FEATURE_DIM];
+	for (int i = 0; i < descriptor.rows; i++) {
+		const uchar* bytes = descriptor.ptr<uchar>(i);
+		for (int w = 0; w < ORB_FEATURE_DIM; w++) {
+			words[w] = (double) (bytes[2 * w] | bytes[2 * w + 1] << 8);
+		}
+		resPoints[i] = spPointCreate(words, ORB_FEATURE_DIM, index);
+		if (!resPoints[i]) {
+			for (int j = 0; j < i; j++) {
+				spPointDestroy(resPoints[j]);
+			}
+			free(resPoints);
+			spLoggerPrintError(ALLOC_ERROR_MSG, __FILE__, __func__, __LINE__);
+			return NULL;
 		}
-		resPoints[i] = spPointCreate(pcaSift, pcaDim, index);
 	}
-	free(pcaSift);
+	*numOfFeats = descriptor.rows;
 	return resPoints;
 }
 
+SPPoint** sp::ImageProc::getImageFeatures(const Mat& img, int index,
+		int* numOfFeats) {
+	if (img.empty() || !numOfFeats) {
+		spLoggerPrintError(INVALID_ARG_ERROR, __FILE__, __func__, __LINE__);
+		return NULL;
+	}
+	// a detector of its own for this thread, dropped rather than reused if an exception is thrown
+	unique_ptr<Extractor> extractor = acquireExtractor();
+	computeDescriptors(img, *extractor);
+	SPPoint** resPoints = (featureType == ORB_FEATURES) ? packDescriptors(*extractor, index, numOfFeats)
+			: projectDescriptors(*extractor, index, numOfFeats);
+	releaseExtractor(move(extractor));
+	return resPoints;
+}
+
+SPPoint** sp::ImageProc::getTrainingImageFeatures(int index, int* numOfFeats) {
+	if (!trainingDescriptors || !numOfFeats) {
+		return NULL;
+	}
+	SPPoint** resPoints = NULL;
+	unique_ptr<Extractor> extractor = acquireExtractor();
+	if (trainingDescriptors->read(index, extractor->descriptor)) {
+		resPoints = projectDescriptors(*extractor, index, numOfFeats);
+	}
+	releaseExtractor(move(extractor));
+	return resPoints;
+}
+
+void sp::ImageProc::releaseTrainingDescriptors() {
+	trainingDescriptors.reset();
+}
+
 void sp::ImageProc::showImage(const char* imgPath) {
 	if (minimalGui) {
 		Mat img = imread(imgPath, cv::IMREAD_COLOR);
@@ -2,6 +2,9 @@
 #define SPIMAGEPROC_H_
 #include <opencv2/core.hpp>
 #include <opencv2/imgcodecs.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 extern "C" {
@@ -20,12 +23,26 @@ private:
 	int pcaDim;
 	int numOfImages;
 	int numOfFeatures;
+	int numOfThreads;
+	int maxImageDimension;
+	SP_FEATURE_TYPE featureType;
 	cv::PCA pca;
 	bool minimalGui;
+	struct Extractor; // a SIFT or ORB detector with its keypoints, descriptor and projection buffers
+	std::mutex extractorsMutex;
+	std::vector<std::unique_ptr<Extractor>> idleExtractors;
+	std::unique_ptr<Extractor> acquireExtractor();
+	void releaseExtractor(std::unique_ptr<Extractor> extractor);
 	void initFromConfig(const SPConfig);
-	void getImagesMat(std::vector<cv::Mat>&, const SPConfig);
-	void getFeatures(std::vector<cv::Mat>&,
-			cv::Mat&);
+	cv::Mat decodeImage(const char* imagePath);
+	struct Training; // the running mean and scatter matrix of the descriptors the PCA is trained on
+	struct TrainingDescriptors; // the descriptors computed while training, spilled to a temporary file
+	std::unique_ptr<TrainingDescriptors> trainingDescriptors;
+	void computeDescriptors(const cv::Mat& img, Extractor& extractor);
+	SPPoint** projectDescriptors(Extractor& extractor, int index, int* numOfFeats);
+	SPPoint** packDescriptors(Extractor& extractor, int index, int* numOfFeats);
+	void getFeaturesWorker(Training* training);
+	void getFeatures(Training* training);
 	void preprocess(const SPConfig config);
 	void initPCAFromFile(const SPConfig config);
 public:
@@ -33,14 +50,40 @@ public:
 	/**
 	 * Creates a new object for the purpose of image processing based
 	 * on the configuration file.
+	 * When the PCA is trained, the images are decoded and their SIFT descriptors
+	 * computed by spNumOfExtractThreads workers. The descriptors of each image are
+	 * merged into a running mean and covariance, so the training memory depends on
+	 * the descriptor dimension rather than on the number of images.
+	 * The descriptors are also spilled to a temporary file, see getTrainingImageFeatures.
+	 * With ORB features (spFeatureType) there is no PCA, so it is neither trained nor loaded.
 	 * @param config - the configuration file from which the object is created
 	 */
 	ImageProc(const SPConfig config);
 
+	/**
+	 * Same as the constructor above, except that the PCA is trained from the
+	 * images (and saved to the PCA file) only if trainPCA is true, and is
+	 * loaded from the PCA file otherwise, regardless of the extraction mode.
+	 * @param config - the configuration file from which the object is created
+	 * @param trainPCA - whether to train the PCA rather than load it
+	 */
+	ImageProc(const SPConfig config, bool trainPCA);
+
+	/**
+	 * Frees the detectors kept for reuse.
+	 */
+	~ImageProc();
+
 	/**
 	 * Returns an array of features for the image imagePath. All SPPoint elements
 	 * will have the index given by index. The actual number of features extracted
 	 * for this image will be stored in the pointer given by numOfFeats.
+	 * The features are ordered by keypoint response, strongest first.
+	 * SIFT descriptors are projected by the PCA, while the 256 bits of each ORB
+	 * descriptor are kept as ORB_FEATURE_DIM coordinates of 16-bit words, so the
+	 * points are compared by their Hamming distance (see SPHammingIndex).
+	 * It may be called by several threads at once, each using its own detector,
+	 * which is kept for the next call rather than created for every image.
 	 *
 	 * @param imagePath - the target imagePath
 	 * @param index - the index  of the image in the database
@@ -52,6 +95,54 @@ public:
 	 */
 	SPPoint** getImageFeatures(const char* imagePath,int index,int* numOfFeats);
 
+	/**
+	 * Decodes the image imagePath as a grayscale image, the first step of
+	 * getImageFeatures. An image wider or taller than spMaxImageDimension is
+	 * downscaled to it, so the cost of SIFT is bounded for large images. Together with the overload of getImageFeatures below,
+	 * it allows decoding and feature extraction to run on different threads.
+	 *
+	 * @param imagePath - the target imagePath
+	 * @return
+	 * The decoded image. An empty image is returned in case of an error.
+	 */
+	cv::Mat loadImage(const char* imagePath);
+
+	/**
+	 * Same as getImageFeatures above, for an image which was already decoded
+	 * by loadImage.
+	 *
+	 * @param img - the decoded image
+	 * @param index - the index  of the image in the database
+	 * @param numOfFeats - a pointer in which the actual number of feats extracted
+	 * 					   will be stored
+	 * @return
+	 * An array of the actual features extracted. NULL is returned in case of
+	 * an error.
+	 */
+	SPPoint** getImageFeatures(const cv::Mat& img,int index,int* numOfFeats);
+
+	/**
+	 * Same as getImageFeatures above, for the image at index index of the database,
+	 * projecting the SIFT descriptors computed while training the PCA rather than
+	 * decoding the image and computing them again. It may be called by several
+	 * threads at once.
+	 *
+	 * @param index - the index  of the image in the database
+	 * @param numOfFeats - a pointer in which the actual number of feats extracted
+	 * 					   will be stored
+	 * @return
+	 * An array of the features of the image. NULL is returned if the PCA wasn't
+	 * trained (as with ORB features), the descriptors of the image weren't kept or were released, or in
+	 * case of an error - getImageFeatures should be used then.
+	 */
+	SPPoint** getTrainingImageFeatures(int index,int* numOfFeats);
+
+	/**
+	 * Releases the descriptors kept by the PCA training (and their temporary file),
+	 * once the features of the database images were extracted.
+	 */
+	void releaseTrainingDescriptors();
+
 	/**
 	 *	Displays the image given by imagePath. Notice that this function works
 	 *	only in MinimalGUI mode (otherwise a warnning message is printed).
@@ -1,6 +1,7 @@
 #include "SPKDArray.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 struct sp_kd_array_t {
@@ -100,46 +101,27 @@ SPKDArray** spKDArraySplit(SPKDArray* arr, int coor) {
 			X[k] = RIGHT;
 	}
 
-	// creating the two arrays of points
+	// creating the two arrays of points (referencing the same points)
 	for (int i=0; i<n; i++) {
 		if (X[i] == LEFT) { // point belongs to left array
-			arrLeft[cLeft] = spPointCopy(arr->points[i]);
-			if (arrLeft[cLeft] == NULL) { // Allocation failure
-				break;
-			}
+			arrLeft[cLeft] = arr->points[i];
 			map[i] = cLeft; // map the cLeft-th order point of the left side
 			cLeft++;
 		}
 		else { // point belongs to right array
-			arrRight[cRight] = spPointCopy(arr->points[i]);
-			if (arrRight[cRight] == NULL) { // Allocation failure
-				break;
-			}
+			arrRight[cRight] = arr->points[i];
 			map[i] = cRight; // map the cRight-th order point of the left side
 			cRight++;
 		}
 	}
 
-	// Allocation failure occurred in a copy point from the loop above, releasing all memory allocations
-	if ((cLeft != nLeft) || (cRight != nRight)) {
-		spLoggerPrintError(ALLOCATION_ERROR, __FILE__, __func__, __LINE__);
-		spPoint1DDestroy(arrLeft, cLeft);
-		spPoint1DDestroy(arrRight, cRight);
-		spKDArrayDestroy(splittedArrays[LEFT]);
-		spKDArrayDestroy(splittedArrays[RIGHT]);
-		free(splittedArrays);
-		free(X);
-		free(map);
-		return NULL;
-	}
-
 	// allocating the KDArrays of left and right arrays
 	splittedArrays[LEFT] = spKDArrayAlloc(arrLeft, nLeft, dim);
 	splittedArrays[RIGHT] = spKDArrayAlloc(arrRight, nRight, dim);
 	if (splittedArrays[LEFT]==NULL || splittedArrays[RIGHT]==NULL) { //Allocation failure
 		spLoggerPrintError(ALLOCATION_ERROR, __FILE__, __func__, __LINE__);
-		spPoint1DDestroy(arrLeft, nLeft);
-		spPoint1DDestroy(arrRight, nRight);
+		free(arrLeft);
+		free(arrRight);
 		spKDArrayDestroy(splittedArrays[LEFT]);
 		spKDArrayDestroy(splittedArrays[RIGHT]);
 		free(splittedArrays);
@@ -166,8 +148,8 @@ SPKDArray** spKDArraySplit(SPKDArray* arr, int coor) {
 	}
 
 	// free all memory allocations used
-	spPoint1DDestroy(arrLeft, nLeft);
-	spPoint1DDestroy(arrRight, nRight);
+	free(arrLeft);
+	free(arrRight);
 	free(X);
 	free(map);
 
@@ -195,41 +177,19 @@ SPKDArray* spKDArrayAlloc(SPPoint** points, int n, int dim) {
 		return NULL;
 	}
 
-	// coping the points to arr->points
-	int successCopies = spDKArrayPointsCopy(arr->points, points, n);
-	if (successCopies != n) {
-		spLoggerPrintError(FUNCTION_ERROR, __FILE__, __func__, __LINE__);
-		spPoint1DDestroy(arr->points, successCopies); //destroying all the points until index i=successCopies
-		free(arr);
-		return NULL;
-	}
+	// referencing the points, they are not copied
+	memcpy(arr->points, points, n*sizeof(SPPoint*));
 
 	arr->sortedMatrix = spKDArrayMatrixAlloc(dim, n); // matrix memory allocation
 	if (arr->sortedMatrix == NULL) { //Allocation failure
 		spLoggerPrintError(ALLOCATION_ERROR, __FILE__, __func__, __LINE__);
-		spPoint1DDestroy(arr->points, n);
+		free(arr->points);
 		free(arr);
 		return NULL;
 	}
 	return arr;
 }
 
-int spDKArrayPointsCopy(SPPoint** dest, SPPoint** src, int n) {
-	if (dest == NULL || src == NULL || n <= 0) {
-		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
-		return 0;
-	}
-
-	for (int i=0; i<n; i++) {
-		dest[i] = spPointCopy(src[i]);
-		if (dest[i] == NULL) { //Allocation failure
-			spLoggerPrintError(ALLOCATION_ERROR, __FILE__, __func__, __LINE__);
-			return i;
-		}
-	}
-	return n;
-}
-
 int spKDArrayCompareValuesByDim(const void *a, const void *b) {
 	BPQueueElement* e1 = (BPQueueElement*)a; // casting pointer types
 	BPQueueElement* e2 = (BPQueueElement*)b; // casting pointer types
@@ -305,7 +265,7 @@ void spKDArrayDestroy(SPKDArray* arr) {
 	}
 
 	spKDArrayMatrixDestroy(arr->sortedMatrix, arr->dim, arr->size);
-	spPoint1DDestroy(arr->points, arr->size);
+	free(arr->points); // the points themselves are owned by the caller of spKDArrayInit
 
 	free(arr);
 }
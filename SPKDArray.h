@@ -18,7 +18,8 @@ typedef struct sp_kd_array_t SPKDArray;
  * such that the following holds:
  *
  * using spKDArrayAlloc function to:
- * - KDArray points - the points array is copied (in order) to the KDArray points array (allocation needed)
+ * - KDArray points - the pointers of the points array are copied (in order) to the KDArray points array
+ *   (the points themselves are not copied - they must outlive the KDArray and anything built from it)
  * - KDArray sortedMatrix - only allocates 2d int array of (d x n) (d = PCA Dimension)
  * - KDArray size - set to be <n>
  * - KDArray dim - set to be <dim> (spPCADimension from the config)
@@ -27,7 +28,7 @@ typedef struct sp_kd_array_t SPKDArray;
  * each i-th row is the indexes of the points in <points> sorted according to their i-th dimension, that is,
  * sortedMatrix[i][j] = the index of the j-th point with respect to the i-th coordinate
  *
- * @param points 	- array of spPoints to copy
+ * @param points 	- array of spPoints to reference
  * @param n 		- size of <points>
  * @param dim 		- spPCADimension from the config
  *
@@ -40,7 +41,7 @@ SPKDArray* spKDArrayInit(SPPoint** points, int n, int dim);
 /**
  * Splits the KDArray to two KDArrays (kdLeft, kdRight) such that:
  * the first ceiling(n/2) points with respect to <coor> are in kdLeft, and the rest
- * of the points are in kdRight
+ * of the points are in kdRight (both referencing the points of <arr>)
  *
  * @param arr - the KDArray to split
  * @param coor - the dimension to split by
@@ -56,11 +57,11 @@ SPKDArray** spKDArraySplit(SPKDArray* arr, int coor);
  * Given points array and a size of the array.
  * such that the following holds:
  *
- * - KDArray points - the points array is copied (in order) to the KDArray points array (allocation needed)
+ * - KDArray points - the pointers of the points array are copied (in order) to the KDArray points array
  * - KDArray size - set to be n
  * - KDArray sortedMatrix - only allocates 2d int array of (d x n) (d is the dim of a point)
  *
- * @param points 	- array of spPoints to copy
+ * @param points 	- array of spPoints to reference
  * @param n 		- size of <points>
  * @param dim 		- spPCADimension from the config
  *
@@ -70,20 +71,6 @@ SPKDArray** spKDArraySplit(SPKDArray* arr, int coor);
  */
 SPKDArray* spKDArrayAlloc(SPPoint** points, int n, int dim);
 
-/**
- * Copies the point array src to dest.
- *
- * @param dest - the destination array where the points are to be copied
- * @param src  - the points array to be copied
- *
- * @return
- * returns the number of points which were copied to dest
- * 0 - if (dest == NULL || src == NULL || n <= 0)
- * i - in case of allocation failure in the i-th point copy
- * n - all the points were copied
- */
-int spDKArrayPointsCopy(SPPoint** dest, SPPoint** src, int n);
-
 /**
  * Frees all memory allocation associated with a points array.
  *
@@ -119,6 +106,7 @@ void spKDArrayMatrixDestroy(int** mat, int n, int m);
 
 /**
  * Frees all memory allocation associated with KDArray.
+ * The points it references are not destroyed.
  *
  * @param arr 	- the KDArray to destroy
  *
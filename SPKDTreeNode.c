@@ -86,6 +86,27 @@ SPKDTreeNode* spKDTreeNodeCreate(SPKDArray* arr, int dim, SP_KD_TREE_SPLIT_METHO
 	return node;
 }
 
+SPKDTreeNode* spKDTreeNodeAssemble(int dim, double val, SPKDTreeNode* left, SPKDTreeNode* right, SPPoint* point) {
+	if ((dim == INVALID && point == NULL) || (dim != INVALID && (dim < 1 || left == NULL || right == NULL))) {
+		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
+		return NULL;
+	}
+
+	SPKDTreeNode* node = (SPKDTreeNode*) malloc(sizeof(SPKDTreeNode));
+	if (node == NULL) { //Allocation failure
+		spLoggerPrintError(ALLOCATION_ERROR, __FILE__, __func__, __LINE__);
+		return NULL;
+	}
+
+	node->dim = dim;
+	node->val = val;
+	node->left = (dim == INVALID) ? NULL : left;
+	node->right = (dim == INVALID) ? NULL : right;
+	node->point = (dim == INVALID) ? point : NULL;
+
+	return node;
+}
+
 SPKDTreeNode* spKDTreeNodeCreateLeaf(SPKDArray* arr) {
 	if (arr == NULL) {
 		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
@@ -103,13 +124,7 @@ SPKDTreeNode* spKDTreeNodeCreateLeaf(SPKDArray* arr) {
 	node->val = INVALID;
 	node->left = NULL;
 	node->right = NULL;
-	node->point = spPointCopy(spKDArrayGetPoints(arr)[0]);
-
-	if (node->point == NULL) { //Allocation failure
-		spLoggerPrintError(ALLOCATION_ERROR, __FILE__, __func__, __LINE__);
-		free(node);
-		return NULL;
-	}
+	node->point = spKDArrayGetPoints(arr)[0]; // referenced, owned by the caller of spKDTreeBuild
 
 	return node;
 }
@@ -167,7 +182,6 @@ void spKDTreeNodeDestroy(SPKDTreeNode* root) {
 	spKDTreeNodeDestroy(root->left);
 	spKDTreeNodeDestroy(root->right);
 
-	spPointDestroy(root->point);
 	free(root);
 	root = NULL;
 }
@@ -230,6 +244,66 @@ bool spKDTreeNodeSearchKNN(SPBPQueue* bpq, SPKDTreeNode* curr, SPPoint* point) {
 	return true;
 }
 
+int spKDTreeNodeGetKNNBounded(SPKDTreeNode* root, SPBPQueue* bpq, SPPoint* point, int maxChecks) {
+	if (root==NULL || bpq==NULL || point==NULL || maxChecks<1) {
+		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
+		return -1;
+	}
+
+	int checksLeft = maxChecks;
+	if(!spKDTreeNodeSearchKNNBounded(bpq, root, point, &checksLeft)) { // search failed, spLogger msg inside
+		return -1;
+	}
+	else
+		return 1;
+}
+
+bool spKDTreeNodeSearchKNNBounded(SPBPQueue* bpq, SPKDTreeNode* curr, SPPoint* point, int* checksLeft) {
+	if (bpq==NULL || curr==NULL || point==NULL || checksLeft==NULL) {
+		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
+		return false;
+	}
+
+	if (curr->dim == INVALID) { // if curr is a leaf
+		(*checksLeft)--;
+		if (spBPQueueEnqueue(bpq, spPointGetIndex(curr->point), spPointL2SquaredDistance(curr->point, point))
+				== SP_BPQUEUE_OUT_OF_MEMORY) {
+			spLoggerPrintError(ALLOCATION_ERROR, __FILE__, __func__, __LINE__);
+			return false;
+		}
+		else
+			return true;
+	}
+
+	bool searchedSide; // side searched
+	if (spPointGetAxisCoor(point, curr->dim-1) <= curr->val) { // search left subtree
+		if (!spKDTreeNodeSearchKNNBounded(bpq, curr->left, point, checksLeft)) {
+			return false;
+		}
+		searchedSide = LEFT;
+	}
+	else { 													// search right subtree
+		if (!spKDTreeNodeSearchKNNBounded(bpq, curr->right, point, checksLeft)) {
+			return false;
+		}
+		searchedSide = RIGHT;
+	}
+
+	// the other side is searched only while checks are left, or to fill the BPQueue
+	if (!spBPQueueIsFull(bpq)
+			|| (*checksLeft > 0 && pow((curr->val - spPointGetAxisCoor(point, curr->dim-1)), 2)
+					< spBPQueueMaxValue(bpq))) {
+		if (searchedSide == LEFT) { // searching right side
+			return spKDTreeNodeSearchKNNBounded(bpq, curr->right, point, checksLeft);
+		}
+		else { 					// searching left side
+			return spKDTreeNodeSearchKNNBounded(bpq, curr->left, point, checksLeft);
+		}
+	}
+
+	return true;
+}
+
 SPKDTreeNode* spKDTreeGetLeftNode(SPKDTreeNode* tree) {
 	if (tree == NULL) {
 		return NULL;
@@ -253,3 +327,19 @@ SPPoint* spKDTreeGetNodePoint(SPKDTreeNode* node) {
 
 	return node->point;
 }
+
+int spKDTreeGetNodeDim(SPKDTreeNode* node) {
+	if (node == NULL) {
+		return INVALID;
+	}
+
+	return node->dim;
+}
+
+double spKDTreeGetNodeVal(SPKDTreeNode* node) {
+	if (node == NULL) {
+		return INVALID;
+	}
+
+	return node->val;
+}
@@ -14,6 +14,7 @@ typedef struct sp_kdtree_node_t SPKDTreeNode;
  * Allocates a new KDTree in the memory.
  * Given points array, size of the array and split method.
  * Creating a new KDArray from the points array and using spKDTreeNodeCreate to build the KDTree
+ * The leaves reference the points rather than copy them, so the points must outlive the KDTree.
  *
  * @param points		- array of points to build the KDArray from
  * @param size			- the size of points array
@@ -49,6 +50,21 @@ SPKDTreeNode* spKDTreeBuild(SPPoint** points, int size, int dim, SP_KD_TREE_SPLI
  */
 SPKDTreeNode* spKDTreeNodeCreate(SPKDArray* arr, int dim, SP_KD_TREE_SPLIT_METHOD splitMethod);
 
+/**
+ * Assembles a KDTreeNode from its fields, e.g. when a KDTree is loaded rather than built.
+ *
+ * @param dim 	- the dimension the node splits by (1-based), or INVALID for a leaf
+ * @param val 	- the split value
+ * @param left 	- the left subtree, NULL for a leaf
+ * @param right - the right subtree, NULL for a leaf
+ * @param point - the point of a leaf (referenced, not copied), NULL otherwise
+ *
+ * @return
+ * NULL in case of allocation failure, or an inner node without two subtrees, or a leaf without a point
+ * Otherwise, the new KDTreeNode, which owns <left> and <right>
+ */
+SPKDTreeNode* spKDTreeNodeAssemble(int dim, double val, SPKDTreeNode* left, SPKDTreeNode* right, SPPoint* point);
+
 /**
  * Creates a new KDTreeNode leaf.
  *
@@ -61,7 +77,7 @@ SPKDTreeNode* spKDTreeNodeCreate(SPKDArray* arr, int dim, SP_KD_TREE_SPLIT_METHO
  * value = -1
  * left = NULL
  * right = NULL
- * point = the only point in the KDArray <arr>
+ * point = the only point in the KDArray <arr> (referenced, not copied)
  */
 SPKDTreeNode* spKDTreeNodeCreateLeaf(SPKDArray* arr);
 
@@ -96,6 +112,7 @@ int spKDTreeNodeGetMaxSpreadDim(SPKDArray* arr);
 
 /**
  * Frees all memory allocation associated with KDTree.
+ * The points referenced by its leaves are not destroyed.
  *
  * @param root 	- the KDTree root to destroy
  *
@@ -131,6 +148,37 @@ int spKDTreeNodeGetKNN(SPKDTreeNode* root, SPBPQueue* bpq, SPPoint* point);
  */
 bool spKDTreeNodeSearchKNN(SPBPQueue* bpq, SPKDTreeNode* curr, SPPoint* point);
 
+/**
+ * Approximate K-Nearest Neighbors Search with a bounded number of checks.
+ * Like spKDTreeNodeGetKNN, except that once <maxChecks> leaves were checked, the other sides of
+ * the nodes on the way back up are only searched while the BPQueue isn't full.
+ * The result may thus miss some of the true K-Nearest Neighbors, in exchange for a bounded search time.
+ *
+ * @param root 		- the KDTree root to search in
+ * @param bpq 		- the BPQueue used to store the K-Nearest Neighbors in
+ * @param point 	- the point used to search the K-Nearest Neighbors for
+ * @param maxChecks - the number of leaves checked before the search stops backtracking
+ *
+ * @return
+ * -1 if the search failed, or maxChecks<1
+ * Otherwise, 1
+ */
+int spKDTreeNodeGetKNNBounded(SPKDTreeNode* root, SPBPQueue* bpq, SPPoint* point, int maxChecks);
+
+/**
+ * Searches for approximate K-Nearest Neighbors of a given point in the given KDTree,
+ * and stores them in the given BPQueue (see spKDTreeNodeGetKNNBounded).
+ *
+ * @param bpq			- the BPQueue used to store the K-Nearest Neighbors in
+ * @param curr			- the current KDTreeNode used for the recursive search (starting from the root)
+ * @param point 		- the point used to search the K-Nearest Neighbors for
+ * @param checksLeft 	- the number of leaves which may still be checked, decremented for each checked leaf
+ *
+ * @return
+ * True if the search succeeded, False if an error occurred.
+ */
+bool spKDTreeNodeSearchKNNBounded(SPBPQueue* bpq, SPKDTreeNode* curr, SPPoint* point, int* checksLeft);
+
 /*Getters for the unit test*/
 //simple getter of Left
 SPKDTreeNode* spKDTreeGetLeftNode(SPKDTreeNode* tree);
@@ -140,4 +188,10 @@ SPKDTreeNode* spKDTreeGetRightNode(SPKDTreeNode* tree);
 
 //simple getter of point in a node
 SPPoint* spKDTreeGetNodePoint(SPKDTreeNode* node);
+
+//simple getter of the split dimension of a node, INVALID for a leaf (or NULL)
+int spKDTreeGetNodeDim(SPKDTreeNode* node);
+
+//simple getter of the split value of a node
+double spKDTreeGetNodeVal(SPKDTreeNode* node);
 #endif /* SPKDTREENODE_H_ */
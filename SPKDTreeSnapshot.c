@@ -0,0 +1,273 @@
+#define _POSIX_C_SOURCE 200809L
+#include "SPKDTreeSnapshot.h"
+#include "SPBinaryUtil.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define MAGIC_SIZE 4
+#define LEAF_DIM 0xFFFFFFFFu // INVALID as an unsigned 32-bit integer
+
+/**
+ * A point of the points array, by address, used to find the position of the point of a leaf.
+ */
+typedef struct point_position_t {
+	uintptr_t address;
+	uint32_t position;
+} PointPosition;
+
+static int comparePositions(const void* a, const void* b) {
+	uintptr_t first = ((const PointPosition*) a)->address;
+	uintptr_t second = ((const PointPosition*) b)->address;
+	return (first > second) - (first < second);
+}
+
+unsigned long long spKDTreeSnapshotHash(SPPoint** points, int size, int dim, SP_KD_TREE_SPLIT_METHOD splitMethod) {
+	if (points==NULL || size<=0 || dim<=0) {
+		return 0;
+	}
+	unsigned long long hash = SP_BINARY_FNV64_OFFSET_BASIS;
+	hash = spBinaryHashValue(hash, (uint64_t) dim);
+	hash = spBinaryHashValue(hash, (uint64_t) splitMethod);
+	hash = spBinaryHashValue(hash, (uint64_t) size);
+	for (int i=0; i<size; i++) {
+		hash = spBinaryHashValue(hash, (uint64_t) spPointGetIndex(points[i]));
+		for (int j=0; j<dim; j++) {
+			double coor = spPointGetAxisCoor(points[i], j);
+			uint64_t bits;
+			memcpy(&bits, &coor, sizeof(double));
+			hash = spBinaryHashValue(hash, bits);
+		}
+	}
+	return hash;
+}
+
+/**
+ * Writes the nodes of the subtree in preorder, continuing the checksum of the nodes.
+ *
+ * @return
+ * SP_KD_TREE_SNAPSHOT_SUCCESS, or the error of the first node which couldn't be written
+ */
+static SP_KD_TREE_SNAPSHOT_MSG writeNode(FILE* file, SPKDTreeNode* node, const PointPosition* positions, int size,
+		uint32_t* hash, uint32_t* numOfNodes) {
+	unsigned char record[SP_KD_TREE_SNAPSHOT_NODE_SIZE];
+	int dim = spKDTreeGetNodeDim(node);
+	double val = spKDTreeGetNodeVal(node);
+	uint64_t bits;
+	memcpy(&bits, &val, sizeof(double));
+	spBinaryWriteLE32(record, (dim == INVALID) ? LEAF_DIM : (uint32_t) dim);
+	spBinaryWriteLE32(record + 4, 0);
+	spBinaryWriteLE64(record + 8, bits);
+	if (dim == INVALID) { // a leaf, finding the position of its point
+		PointPosition key = { (uintptr_t) spKDTreeGetNodePoint(node), 0 };
+		const PointPosition* found = (const PointPosition*) bsearch(&key, positions, size, sizeof(PointPosition),
+				comparePositions);
+		if (found == NULL) {
+			return SP_KD_TREE_SNAPSHOT_INVALID_ARGUMENT;
+		}
+		spBinaryWriteLE32(record + 4, found->position);
+	}
+	*hash = spBinaryChecksum(*hash, record, SP_KD_TREE_SNAPSHOT_NODE_SIZE);
+	(*numOfNodes)++;
+	if (fwrite(record, 1, SP_KD_TREE_SNAPSHOT_NODE_SIZE, file) != SP_KD_TREE_SNAPSHOT_NODE_SIZE) {
+		return SP_KD_TREE_SNAPSHOT_WRITE_ERROR;
+	}
+	if (dim == INVALID) {
+		return SP_KD_TREE_SNAPSHOT_SUCCESS;
+	}
+	SP_KD_TREE_SNAPSHOT_MSG msg = writeNode(file, spKDTreeGetLeftNode(node), positions, size, hash, numOfNodes);
+	if (msg != SP_KD_TREE_SNAPSHOT_SUCCESS) {
+		return msg;
+	}
+	return writeNode(file, spKDTreeGetRightNode(node), positions, size, hash, numOfNodes);
+}
+
+SP_KD_TREE_SNAPSHOT_MSG spKDTreeSnapshotWrite(const char* path, SPKDTreeNode* root, SPPoint** points, int size,
+		int dim, unsigned long long sourceHash) {
+	if (path==NULL || root==NULL || points==NULL || size<=0 || dim<=0) {
+		return SP_KD_TREE_SNAPSHOT_INVALID_ARGUMENT;
+	}
+	// the positions of the points, sorted by address for the lookups of the leaves
+	PointPosition* positions = (PointPosition*) malloc(size*sizeof(PointPosition));
+	if (positions == NULL) { //Allocation failure
+		return SP_KD_TREE_SNAPSHOT_OUT_OF_MEMORY;
+	}
+	for (int i=0; i<size; i++) {
+		positions[i].address = (uintptr_t) points[i];
+		positions[i].position = (uint32_t) i;
+	}
+	qsort(positions, size, sizeof(PointPosition), comparePositions);
+
+	FILE* file = fopen(path, "wb");
+	if (file == NULL) {
+		free(positions);
+		return SP_KD_TREE_SNAPSHOT_CANNOT_OPEN;
+	}
+
+	// the header is written last, once the checksum of the nodes is known
+	unsigned char header[SP_KD_TREE_SNAPSHOT_HEADER_SIZE] = { 0 };
+	uint32_t hash = SP_BINARY_FNV32_OFFSET_BASIS;
+	uint32_t numOfNodes = 0;
+	SP_KD_TREE_SNAPSHOT_MSG msg = SP_KD_TREE_SNAPSHOT_WRITE_ERROR;
+	if (fwrite(header, 1, SP_KD_TREE_SNAPSHOT_HEADER_SIZE, file) == SP_KD_TREE_SNAPSHOT_HEADER_SIZE) {
+		msg = writeNode(file, root, positions, size, &hash, &numOfNodes);
+	}
+	free(positions);
+	memcpy(header, SP_KD_TREE_SNAPSHOT_MAGIC, MAGIC_SIZE);
+	spBinaryWriteLE32(header + MAGIC_SIZE, SP_KD_TREE_SNAPSHOT_VERSION);
+	spBinaryWriteLE32(header + MAGIC_SIZE + 4, (uint32_t) dim);
+	spBinaryWriteLE32(header + MAGIC_SIZE + 8, (uint32_t) size);
+	spBinaryWriteLE32(header + MAGIC_SIZE + 12, numOfNodes);
+	spBinaryWriteLE32(header + MAGIC_SIZE + 16, hash);
+	spBinaryWriteLE64(header + MAGIC_SIZE + 20, (uint64_t) sourceHash);
+	if (msg == SP_KD_TREE_SNAPSHOT_SUCCESS && (fseek(file, 0, SEEK_SET) != 0
+			|| fwrite(header, 1, SP_KD_TREE_SNAPSHOT_HEADER_SIZE, file) != SP_KD_TREE_SNAPSHOT_HEADER_SIZE)) {
+		msg = SP_KD_TREE_SNAPSHOT_WRITE_ERROR;
+	}
+	if (fclose(file) != 0 && msg == SP_KD_TREE_SNAPSHOT_SUCCESS) {
+		msg = SP_KD_TREE_SNAPSHOT_WRITE_ERROR;
+	}
+	if (msg != SP_KD_TREE_SNAPSHOT_SUCCESS) { // never leaving a partial snapshot behind
+		remove(path);
+	}
+	return msg;
+}
+
+/**
+ * Rebuilds the subtree whose root is the next node record, in preorder.
+ * Each point may be referenced by a single leaf, which <usedPoints> keeps track of.
+ *
+ * @return
+ * NULL if the records are inconsistent (<*msg> = SP_KD_TREE_SNAPSHOT_INVALID_FORMAT),
+ * or in case of allocation failure (<*msg> = SP_KD_TREE_SNAPSHOT_OUT_OF_MEMORY)
+ * Otherwise, the subtree
+ */
+static SPKDTreeNode* readNode(const unsigned char* records, uint32_t numOfNodes, uint32_t* next,
+		SPPoint** points, int size, int dim, bool* usedPoints, SP_KD_TREE_SNAPSHOT_MSG* msg) {
+	if (*next >= numOfNodes) {
+		*msg = SP_KD_TREE_SNAPSHOT_INVALID_FORMAT;
+		return NULL;
+	}
+	const unsigned char* record = records + (size_t) (*next) * SP_KD_TREE_SNAPSHOT_NODE_SIZE;
+	(*next)++;
+	uint32_t nodeDim = spBinaryReadLE32(record);
+	uint32_t position = spBinaryReadLE32(record + 4);
+	uint64_t bits = spBinaryReadLE64(record + 8);
+	double val;
+	memcpy(&val, &bits, sizeof(double));
+
+	SPKDTreeNode* node = NULL;
+	if (nodeDim == LEAF_DIM) {
+		if (position >= (uint32_t) size || usedPoints[position]) {
+			*msg = SP_KD_TREE_SNAPSHOT_INVALID_FORMAT;
+			return NULL;
+		}
+		usedPoints[position] = true;
+		node = spKDTreeNodeAssemble(INVALID, val, NULL, NULL, points[position]);
+	} else {
+		if (nodeDim < 1 || nodeDim > (uint32_t) dim) {
+			*msg = SP_KD_TREE_SNAPSHOT_INVALID_FORMAT;
+			return NULL;
+		}
+		SPKDTreeNode* left = readNode(records, numOfNodes, next, points, size, dim, usedPoints, msg);
+		SPKDTreeNode* right = (left == NULL) ? NULL
+				: readNode(records, numOfNodes, next, points, size, dim, usedPoints, msg);
+		if (right == NULL) {
+			spKDTreeNodeDestroy(left);
+			return NULL;
+		}
+		node = spKDTreeNodeAssemble((int) nodeDim, val, left, right, NULL);
+		if (node == NULL) {
+			spKDTreeNodeDestroy(left);
+			spKDTreeNodeDestroy(right);
+		}
+	}
+	if (node == NULL) { //Allocation failure
+		*msg = SP_KD_TREE_SNAPSHOT_OUT_OF_MEMORY;
+	}
+	return node;
+}
+
+SPKDTreeNode* spKDTreeSnapshotRead(const char* path, SPPoint** points, int size, int dim,
+		unsigned long long sourceHash, SP_KD_TREE_SNAPSHOT_MSG* msg) {
+	if (msg == NULL) {
+		return NULL;
+	}
+	if (path==NULL || points==NULL || size<=0 || dim<=0) {
+		*msg = SP_KD_TREE_SNAPSHOT_INVALID_ARGUMENT;
+		return NULL;
+	}
+	int fd = open(path, O_RDONLY);
+	if (fd == -1) {
+		*msg = SP_KD_TREE_SNAPSHOT_CANNOT_OPEN;
+		return NULL;
+	}
+	struct stat status;
+	if (fstat(fd, &status) == -1) {
+		*msg = SP_KD_TREE_SNAPSHOT_CANNOT_OPEN;
+		close(fd);
+		return NULL;
+	}
+	if (status.st_size < SP_KD_TREE_SNAPSHOT_HEADER_SIZE) {
+		*msg = SP_KD_TREE_SNAPSHOT_CORRUPTED;
+		close(fd);
+		return NULL;
+	}
+	size_t fileSize = (size_t) status.st_size;
+	void* mapping = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // the mapping stays valid
+	if (mapping == MAP_FAILED) {
+		*msg = SP_KD_TREE_SNAPSHOT_CANNOT_OPEN;
+		return NULL;
+	}
+	posix_madvise(mapping, fileSize, POSIX_MADV_SEQUENTIAL);
+	const unsigned char* file = (const unsigned char*) mapping;
+
+	// verifying the header, and that the nodes are complete and intact
+	uint32_t version = spBinaryReadLE32(file + MAGIC_SIZE);
+	uint32_t fileDim = spBinaryReadLE32(file + MAGIC_SIZE + 4);
+	uint32_t numOfPoints = spBinaryReadLE32(file + MAGIC_SIZE + 8);
+	uint32_t numOfNodes = spBinaryReadLE32(file + MAGIC_SIZE + 12);
+	uint32_t fileChecksum = spBinaryReadLE32(file + MAGIC_SIZE + 16);
+	uint64_t fileSourceHash = spBinaryReadLE64(file + MAGIC_SIZE + 20);
+	const unsigned char* records = file + SP_KD_TREE_SNAPSHOT_HEADER_SIZE;
+	size_t recordsSize = (size_t) numOfNodes * SP_KD_TREE_SNAPSHOT_NODE_SIZE;
+	*msg = SP_KD_TREE_SNAPSHOT_SUCCESS;
+	if (memcmp(file, SP_KD_TREE_SNAPSHOT_MAGIC, MAGIC_SIZE) != 0 || version != SP_KD_TREE_SNAPSHOT_VERSION) {
+		*msg = SP_KD_TREE_SNAPSHOT_INVALID_FORMAT;
+	} else if (fileDim != (uint32_t) dim || numOfPoints != (uint32_t) size
+			|| fileSourceHash != (uint64_t) sourceHash) {
+		*msg = SP_KD_TREE_SNAPSHOT_STALE;
+	} else if (fileSize - SP_KD_TREE_SNAPSHOT_HEADER_SIZE != recordsSize
+			|| spBinaryChecksum(SP_BINARY_FNV32_OFFSET_BASIS, records, recordsSize) != fileChecksum) {
+		*msg = SP_KD_TREE_SNAPSHOT_CORRUPTED;
+	} else if (numOfNodes != 2*numOfPoints - 1) { // every inner node has two subtrees
+		*msg = SP_KD_TREE_SNAPSHOT_INVALID_FORMAT;
+	}
+	if (*msg != SP_KD_TREE_SNAPSHOT_SUCCESS) {
+		munmap(mapping, fileSize);
+		return NULL;
+	}
+
+	bool* usedPoints = (bool*) calloc(size, sizeof(bool));
+	if (usedPoints == NULL) { //Allocation failure
+		*msg = SP_KD_TREE_SNAPSHOT_OUT_OF_MEMORY;
+		munmap(mapping, fileSize);
+		return NULL;
+	}
+	uint32_t next = 0;
+	SPKDTreeNode* root = readNode(records, numOfNodes, &next, points, size, dim, usedPoints, msg);
+	if (root != NULL && next != numOfNodes) { // records left over
+		*msg = SP_KD_TREE_SNAPSHOT_INVALID_FORMAT;
+		spKDTreeNodeDestroy(root);
+		root = NULL;
+	}
+	free(usedPoints);
+	munmap(mapping, fileSize);
+	return root;
+}
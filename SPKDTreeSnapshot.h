@@ -0,0 +1,100 @@
+#ifndef SPKDTREESNAPSHOT_H_
+#define SPKDTREESNAPSHOT_H_
+
+#include <stdbool.h>
+#include "SPKDTreeNode.h"
+#include "SPPoint.h"
+
+/**
+ * SP KDTree Snapshot summary
+ * Saves a built KDTree to a file, and loads it back without building it again.
+ *
+ * The snapshot is made of a header and the nodes of the tree in preorder. The header is the magic
+ * "SPKT" and seven little-endian 32-bit unsigned integers: version, dim, number of points,
+ * number of nodes, a checksum (32-bit FNV-1a) of the nodes, and the low and high halves of the
+ * source hash. Each node is its split dimension (-1 for a leaf) and, for a leaf, the position of
+ * its point in the points array the tree was built from, as little-endian 32-bit integers,
+ * followed by its split value as a little-endian IEEE double. Nothing in the file is an address,
+ * so the tree is rebuilt in a single pass over the mapped file, pointing at the caller's points.
+ *
+ * The source hash sums up what the tree was built from (see spKDTreeSnapshotHash), so a snapshot
+ * of other features or another configuration is never loaded.
+ *
+ * The following functions are supported:
+ *
+ * spKDTreeSnapshotHash		- Hashes the points and the parameters a KDTree is built from
+ * spKDTreeSnapshotWrite	- Saves a KDTree
+ * spKDTreeSnapshotRead		- Loads a KDTree
+ */
+
+#define SP_KD_TREE_SNAPSHOT_MAGIC "SPKT"
+#define SP_KD_TREE_SNAPSHOT_VERSION 1
+#define SP_KD_TREE_SNAPSHOT_HEADER_SIZE 32
+#define SP_KD_TREE_SNAPSHOT_NODE_SIZE 16
+
+/** type for error reporting **/
+typedef enum sp_kd_tree_snapshot_msg_t {
+	SP_KD_TREE_SNAPSHOT_CANNOT_OPEN,
+	SP_KD_TREE_SNAPSHOT_STALE,				// built from other points, or with other parameters
+	SP_KD_TREE_SNAPSHOT_INVALID_FORMAT,		// not a snapshot, an unsupported version, or an inconsistent tree
+	SP_KD_TREE_SNAPSHOT_CORRUPTED,			// the file is truncated, or its checksum doesn't match
+	SP_KD_TREE_SNAPSHOT_WRITE_ERROR,
+	SP_KD_TREE_SNAPSHOT_OUT_OF_MEMORY,
+	SP_KD_TREE_SNAPSHOT_INVALID_ARGUMENT,
+	SP_KD_TREE_SNAPSHOT_SUCCESS
+} SP_KD_TREE_SNAPSHOT_MSG;
+
+/**
+ * Hashes (64-bit FNV-1a) the points a KDTree is built from - their coordinates and indexes,
+ * in order - together with the dimension and the split method.
+ *
+ * @param points 		- the points array the KDTree is built from
+ * @param size 			- the size of points array
+ * @param dim 			- spPCADimension from the config
+ * @param splitMethod 	- the KDTree split method
+ *
+ * @return
+ * 0 if points==NULL or size<=0 or dim<=0, otherwise the source hash
+ */
+unsigned long long spKDTreeSnapshotHash(SPPoint** points, int size, int dim, SP_KD_TREE_SPLIT_METHOD splitMethod);
+
+/**
+ * Saves the KDTree built from <points> to a snapshot file.
+ *
+ * @param path 		 - the path of the snapshot file
+ * @param root 		 - the KDTree root
+ * @param points 	 - the points array the KDTree was built from
+ * @param size 		 - the size of points array
+ * @param dim 		 - spPCADimension from the config
+ * @param sourceHash - the source hash of the KDTree (see spKDTreeSnapshotHash)
+ *
+ * @return
+ * SP_KD_TREE_SNAPSHOT_INVALID_ARGUMENT if an argument is invalid, or a leaf of the tree
+ * 									    references a point which isn't in <points>
+ * SP_KD_TREE_SNAPSHOT_CANNOT_OPEN or SP_KD_TREE_SNAPSHOT_WRITE_ERROR if the file couldn't be written
+ * SP_KD_TREE_SNAPSHOT_OUT_OF_MEMORY in case of allocation failure
+ * SP_KD_TREE_SNAPSHOT_SUCCESS otherwise
+ */
+SP_KD_TREE_SNAPSHOT_MSG spKDTreeSnapshotWrite(const char* path, SPKDTreeNode* root, SPPoint** points, int size,
+		int dim, unsigned long long sourceHash);
+
+/**
+ * Loads a KDTree from a snapshot file. The file is mapped to memory, its header and checksum are
+ * verified, and the nodes are rebuilt in preorder, the leaves referencing the points of <points>.
+ *
+ * @param path 		 - the path of the snapshot file
+ * @param points 	 - the points array the KDTree was built from, which must outlive the KDTree
+ * @param size 		 - the size of points array
+ * @param dim 		 - spPCADimension from the config
+ * @param sourceHash - the source hash of <points> and the config (see spKDTreeSnapshotHash)
+ * @param msg 		 - pointer in which the msg returned by the function is stored
+ *
+ * @return
+ * NULL in case of failure (see msg), SP_KD_TREE_SNAPSHOT_STALE if the snapshot doesn't match
+ * <dim>, <size> and <sourceHash>
+ * Otherwise, the loaded KDTree
+ */
+SPKDTreeNode* spKDTreeSnapshotRead(const char* path, SPPoint** points, int size, int dim,
+		unsigned long long sourceHash, SP_KD_TREE_SNAPSHOT_MSG* msg);
+
+#endif /* SPKDTREESNAPSHOT_H_ */
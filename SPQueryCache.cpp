@@ -0,0 +1,190 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include "SPQueryCache.h"
+extern "C" {
+#include "SPLogger.h"
+#include "SPKDArray.h"
+}
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+#define CHECK_MULTIPLIER 0x9E3779B97F4A7C15ULL // the golden ratio, an odd 64 bit multiplier
+#define CHECK_ROTATION 5
+#define HASH_BUFFER_SIZE 65536
+#define ENTRY_OVERHEAD 128 // the list node, the map node and the Entry itself
+
+using namespace std;
+
+sp::QueryCache::QueryCache(size_t memoryBudget, unsigned long long rankingContext) :
+		memoryBudget(memoryBudget), usedMemory(0), rankingContext(rankingContext) {
+}
+
+unsigned long long sp::QueryCache::hashBytes(const void* data, size_t size, unsigned long long seed) {
+	const unsigned char* bytes = (const unsigned char*) data;
+	unsigned long long hash = seed;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+bool sp::QueryCache::hashFile(const char* path, QueryContentKey* contentKey) {
+	if (path == NULL || contentKey == NULL) {
+		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
+		return false;
+	}
+	FILE* file = fopen(path, "rb");
+	if (file == NULL) { // reported by whoever reads the query next
+		return false;
+	}
+	vector<char> buffer(HASH_BUFFER_SIZE);
+	unsigned long long hash = FNV_OFFSET_BASIS, check = 0, length = 0;
+	size_t n;
+	while ((n = fread(buffer.data(), 1, buffer.size(), file)) > 0) {
+		hash = hashBytes(buffer.data(), n, hash);
+		for (size_t i = 0; i < n; i++) { // a rotate-xor-multiply hash, unrelated to FNV-1a
+			check = (check << CHECK_ROTATION) | (check >> (64 - CHECK_ROTATION));
+			check = (check ^ (unsigned char) buffer[i]) * CHECK_MULTIPLIER;
+		}
+		length += n;
+	}
+	bool succeeded = !ferror(file);
+	fclose(file);
+	contentKey->hash = hash;
+	contentKey->check = check;
+	contentKey->length = length;
+	return succeeded;
+}
+
+unsigned long long sp::QueryCache::rankingKey(unsigned long long contentHash) const {
+	return hashBytes(&rankingContext, sizeof(rankingContext), contentHash);
+}
+
+list<sp::QueryCache::Entry>::iterator sp::QueryCache::find(unordered_map<unsigned long long, list<Entry>::iterator>& index,
+		unsigned long long key, const QueryContentKey& contentKey) {
+	unordered_map<unsigned long long, list<Entry>::iterator>::iterator found = index.find(key);
+	if (found == index.end() || found->second->check != contentKey.check
+			|| found->second->length != contentKey.length) { // a hash collision is a miss
+		return entries.end();
+	}
+	return found->second;
+}
+
+SPPoint** sp::QueryCache::getFeatures(const QueryContentKey& contentKey, int* numOfFeatures) {
+	if (numOfFeatures == NULL) {
+		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
+		return NULL;
+	}
+	lock_guard<mutex> lock(cacheMutex);
+	list<Entry>::iterator found = find(features, contentKey.hash, contentKey);
+	if (found == entries.end()) {
+		return NULL;
+	}
+	entries.splice(entries.begin(), entries, found);
+	const Entry& entry = *found;
+	SPPoint** copy = (SPPoint**) malloc(entry.count * sizeof(SPPoint*));
+	if (copy == NULL) {
+		spLoggerPrintError(ALLOCATION_ERROR, __FILE__, __func__, __LINE__);
+		return NULL;
+	}
+	for (int i = 0; i < entry.count; i++) {
+		copy[i] = spPointCreate((double*) &entry.values[(size_t) i * entry.dim], entry.dim, 0);
+		if (copy[i] == NULL) {
+			spLoggerPrintError(ALLOCATION_ERROR, __FILE__, __func__, __LINE__);
+			for (int j = 0; j < i; j++) {
+				spPointDestroy(copy[j]);
+			}
+			free(copy);
+			return NULL;
+		}
+	}
+	*numOfFeatures = entry.count;
+	return copy;
+}
+
+void sp::QueryCache::putFeatures(const QueryContentKey& contentKey, SPPoint** queryFeatures, int numOfFeatures) {
+	if (queryFeatures == NULL || numOfFeatures < 1) {
+		return;
+	}
+	Entry entry;
+	entry.key = contentKey.hash;
+	entry.check = contentKey.check;
+	entry.length = contentKey.length;
+	entry.isRanking = false;
+	entry.count = numOfFeatures;
+	entry.dim = spPointGetDimension(queryFeatures[0]);
+	entry.bytes = ENTRY_OVERHEAD + (size_t) numOfFeatures * entry.dim * sizeof(double);
+	if (entry.bytes > memoryBudget) {
+		return;
+	}
+	entry.values.resize((size_t) numOfFeatures * entry.dim);
+	for (int i = 0; i < numOfFeatures; i++) {
+		for (int j = 0; j < entry.dim; j++) {
+			entry.values[(size_t) i * entry.dim + j] = spPointGetAxisCoor(queryFeatures[i], j);
+		}
+	}
+	lock_guard<mutex> lock(cacheMutex);
+	insert(entry);
+}
+
+BPQueueElement* sp::QueryCache::getRanking(const QueryContentKey& contentKey, int numOfResults) {
+	lock_guard<mutex> lock(cacheMutex);
+	list<Entry>::iterator found = find(rankings, rankingKey(contentKey.hash), contentKey);
+	if (found == entries.end() || numOfResults < 1 || found->count < numOfResults) {
+		return NULL;
+	}
+	entries.splice(entries.begin(), entries, found);
+	BPQueueElement* copy = (BPQueueElement*) malloc(numOfResults * sizeof(BPQueueElement));
+	if (copy == NULL) {
+		spLoggerPrintError(ALLOCATION_ERROR, __FILE__, __func__, __LINE__);
+		return NULL;
+	}
+	memcpy(copy, found->ranking.data(), numOfResults * sizeof(BPQueueElement));
+	return copy;
+}
+
+void sp::QueryCache::putRanking(const QueryContentKey& contentKey, const BPQueueElement* ranking, int numOfResults) {
+	if (ranking == NULL || numOfResults < 1) {
+		return;
+	}
+	Entry entry;
+	entry.key = rankingKey(contentKey.hash);
+	entry.check = contentKey.check;
+	entry.length = contentKey.length;
+	entry.isRanking = true;
+	entry.count = numOfResults;
+	entry.dim = 0;
+	entry.bytes = ENTRY_OVERHEAD + numOfResults * sizeof(BPQueueElement);
+	if (entry.bytes > memoryBudget) {
+		return;
+	}
+	entry.ranking.assign(ranking, ranking + numOfResults);
+	lock_guard<mutex> lock(cacheMutex);
+	insert(entry);
+}
+
+void sp::QueryCache::insert(Entry& entry) {
+	unordered_map<unsigned long long, list<Entry>::iterator>& index = entry.isRanking ? rankings : features;
+	unordered_map<unsigned long long, list<Entry>::iterator>::iterator found = index.find(entry.key);
+	if (found != index.end()) { // cached meanwhile by another query, or a colliding one, replacing it
+		usedMemory -= found->second->bytes;
+		entries.erase(found->second);
+		index.erase(found);
+	}
+	usedMemory += entry.bytes;
+	entries.push_front(std::move(entry));
+	index[entries.front().key] = entries.begin();
+	evict();
+}
+
+void sp::QueryCache::evict() {
+	while (usedMemory > memoryBudget && !entries.empty()) {
+		Entry& last = entries.back();
+		(last.isRanking ? rankings : features).erase(last.key);
+		usedMemory -= last.bytes;
+		entries.pop_back();
+	}
+}
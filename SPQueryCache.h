@@ -0,0 +1,116 @@
+#ifndef SPQUERYCACHE_H_
+#define SPQUERYCACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include "SPPoint.h"
+#include "SPBPriorityQueue.h"
+}
+
+namespace sp {
+
+/**
+ * Identifies the content of a query file. hash indexes the cache, and check and length are
+ * compared on every lookup, so two files whose hashes collide never share cached results.
+ */
+struct QueryContentKey {
+	unsigned long long hash;	// the 64 bit FNV-1a hash of the content
+	unsigned long long check;	// a second hash of the content, independent of hash
+	unsigned long long length;	// the number of bytes of the content
+};
+
+/**
+ * An in-process LRU cache of query results, keyed by the content of the query file, so a
+ * repeated query skips feature extraction, and usually the KNN search as well.
+ * Two kinds of entries share a single memory budget:
+ *
+ * features - the PCA projected features of the query
+ * ranking  - the sorted best images of the query
+ *
+ * The rankings are only valid for the search parameters and the index they were computed
+ * with, which are summed up by the ranking context given on creation. A ranking is looked up
+ * by both the content key and the context, so rankings of another context are never returned.
+ *
+ * All the functions may be called concurrently.
+ */
+class QueryCache {
+private:
+	struct Entry {
+		unsigned long long key;
+		unsigned long long check;			// the check of the content key
+		unsigned long long length;			// the length of the content key
+		bool isRanking;
+		int count;							// the number of features, or of ranked images
+		int dim;							// the dimension of the features
+		std::vector<double> values;			// the features, one after another
+		std::vector<BPQueueElement> ranking;
+		size_t bytes;
+	};
+
+	std::mutex cacheMutex;
+	size_t memoryBudget;
+	size_t usedMemory;
+	unsigned long long rankingContext;
+	std::list<Entry> entries; // the most recently used first
+	std::unordered_map<unsigned long long, std::list<Entry>::iterator> features;
+	std::unordered_map<unsigned long long, std::list<Entry>::iterator> rankings;
+
+	void insert(Entry& entry);
+	void evict();
+	unsigned long long rankingKey(unsigned long long contentHash) const;
+	std::list<Entry>::iterator find(std::unordered_map<unsigned long long, std::list<Entry>::iterator>& index,
+			unsigned long long key, const QueryContentKey& contentKey);
+public:
+
+	/**
+	 * Creates an empty cache.
+	 *
+	 * @param memoryBudget - the maximal number of bytes held by the entries
+	 * @param rankingContext - identifies the search parameters and the index of the rankings
+	 */
+	QueryCache(size_t memoryBudget, unsigned long long rankingContext);
+
+	/**
+	 * Hashes size bytes of data with 64 bit FNV-1a, continuing from seed.
+	 */
+	static unsigned long long hashBytes(const void* data, size_t size, unsigned long long seed);
+
+	/**
+	 * Computes the content key of the file path.
+	 *
+	 * @return
+	 * false if the file couldn't be read. Otherwise, true and the key is stored in contentKey.
+	 */
+	static bool hashFile(const char* path, QueryContentKey* contentKey);
+
+	/**
+	 * Returns a new copy of the cached features of the query, all with index 0, or NULL if they
+	 * aren't cached. The number of features is stored in numOfFeatures.
+	 */
+	SPPoint** getFeatures(const QueryContentKey& contentKey, int* numOfFeatures);
+
+	/**
+	 * Caches a copy of the features of the query. Features larger than the whole budget
+	 * aren't cached.
+	 */
+	void putFeatures(const QueryContentKey& contentKey, SPPoint** queryFeatures, int numOfFeatures);
+
+	/**
+	 * Returns a new copy of the cached ranking of the query, or NULL if it isn't cached with
+	 * at least numOfResults images.
+	 */
+	BPQueueElement* getRanking(const QueryContentKey& contentKey, int numOfResults);
+
+	/**
+	 * Caches a copy of the numOfResults best images of the query.
+	 */
+	void putRanking(const QueryContentKey& contentKey, const BPQueueElement* ranking, int numOfResults);
+};
+
+}
+#endif
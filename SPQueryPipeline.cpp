@@ -0,0 +1,109 @@
+#include <atomic>
+#include <memory>
+#include <thread>
+#include "SPQueryPipeline.h"
+extern "C" {
+#include "SPLogger.h"
+}
+
+#define PIPELINE_WORKER_ERROR "Pipeline worker couldn't be started"
+#define PIPELINE_STAGE_ERROR "Pipeline stage failed"
+
+using namespace std;
+
+namespace {
+
+/**
+ * The body of each worker of stage <stage>: takes the jobs either from the job list
+ * (first stage) or from the queue of the previous stage, processes them and hands them
+ * to the queue of the next stage. The last worker of a stage to finish closes its
+ * output queue, which lets the next stage drain and finish in turn.
+ */
+void stageWorker(size_t stage, const function<void(sp::QueryJob&)>* process, vector<sp::QueryJob>* jobs,
+		atomic<size_t>* nextJob, vector<unique_ptr<sp::BoundedQueue<sp::QueryJob*> > >* queues,
+		atomic<int>* runningWorkers, const atomic<bool>* aborted) {
+	size_t lastStage = queues->size();
+	while (true) {
+		sp::QueryJob* job = NULL;
+		if (stage == 0) {
+			size_t next = (*nextJob)++;
+			if (next >= jobs->size() || *aborted) {
+				break;
+			}
+			job = &(*jobs)[next];
+		} else if (!(*queues)[stage-1]->pop(job)) {
+			break;
+		}
+
+		if (!job->failed) {
+			try {
+				(*process)(*job);
+			} catch (...) {
+				spLoggerPrintError(PIPELINE_STAGE_ERROR, __FILE__, __func__, __LINE__);
+				job->failed = true;
+			}
+		}
+		if (stage < lastStage && !(*queues)[stage]->push(job)) { // aborted
+			job->failed = true;
+		}
+	}
+	if (--(*runningWorkers) == 0 && stage < lastStage) {
+		(*queues)[stage]->close();
+	}
+}
+
+}
+
+sp::QueryPipeline::QueryPipeline(int queueSize) : queueSize(queueSize) {
+}
+
+void sp::QueryPipeline::addStage(function<void(QueryJob&)> process, int numOfWorkers) {
+	Stage stage = { process, numOfWorkers > 0 ? numOfWorkers : 1 };
+	stages.push_back(stage);
+}
+
+bool sp::QueryPipeline::run(vector<QueryJob>& jobs) {
+	if (stages.empty() || jobs.empty()) {
+		return true;
+	}
+	size_t numOfStages = stages.size();
+	vector<unique_ptr<BoundedQueue<QueryJob*> > > queues;
+	for (size_t s = 0; s + 1 < numOfStages; s++) {
+		queues.push_back(unique_ptr<BoundedQueue<QueryJob*> >(new BoundedQueue<QueryJob*>(queueSize)));
+	}
+	unique_ptr<atomic<int>[]> runningWorkers(new atomic<int>[numOfStages]);
+	for (size_t s = 0; s < numOfStages; s++) {
+		runningWorkers[s] = stages[s].numOfWorkers;
+	}
+	atomic<size_t> nextJob(0);
+	atomic<bool> aborted(false);
+
+	vector<thread> workers;
+	try {
+		for (size_t s = 0; s < numOfStages; s++) {
+			for (int w = 0; w < stages[s].numOfWorkers; w++) {
+				workers.push_back(thread(stageWorker, s, &stages[s].process, &jobs, &nextJob, &queues,
+						&runningWorkers[s], &aborted));
+			}
+		}
+	} catch (...) { // a stage may be left without workers - stopping the whole pipeline
+		spLoggerPrintError(PIPELINE_WORKER_ERROR, __FILE__, __func__, __LINE__);
+		aborted = true;
+		for (size_t s = 0; s < queues.size(); s++) {
+			queues[s]->close();
+		}
+	}
+	for (size_t w = 0; w < workers.size(); w++) {
+		workers[w].join();
+	}
+
+	if (aborted) {
+		for (size_t j = 0; j < jobs.size(); j++) {
+			if (jobs[j].result == NULL) {
+				jobs[j].failed = true;
+			}
+		}
+		return false;
+	}
+	return true;
+}
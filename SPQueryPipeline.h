@@ -0,0 +1,140 @@
+#ifndef SPQUERYPIPELINE_H_
+#define SPQUERYPIPELINE_H_
+
+#include <opencv2/core.hpp>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "SPQueryCache.h"
+
+extern "C" {
+#include "SPPoint.h"
+#include "SPBPriorityQueue.h"
+}
+
+namespace sp {
+
+/**
+ * A query travelling through the stages of a QueryPipeline. Each stage fills the
+ * fields it is responsible for, and sets failed if the query couldn't be processed,
+ * in which case the rest of the stages skip it.
+ */
+struct QueryJob {
+	const char* queryPath;		// the query path
+	cv::Mat image;				// the decoded query image
+	SPPoint** features;			// the query features
+	int numOfFeatures;			// the number of query features
+	BPQueueElement* result;		// the sorted images of the query
+	bool failed;				// true if one of the stages failed
+	QueryContentKey contentKey;	// the content key of the query file, if cached
+	bool cached;				// true if the query may be looked up in and added to the query cache
+	long long deadline;			// the time at which the query is due, 0 for no deadline
+	bool degraded;				// true if the search was degraded to meet the deadline
+};
+
+/**
+ * A FIFO queue with a maximal capacity, shared by several producer and consumer threads.
+ * push blocks while the queue is full, and pop blocks while it is empty, so a fast
+ * stage can never run more than <capacity> queries ahead of the stage after it.
+ */
+template<typename T>
+class BoundedQueue {
+private:
+	std::mutex mutex;
+	std::condition_variable notFull;
+	std::condition_variable notEmpty;
+	std::deque<T> items;
+	size_t capacity;
+	bool closed;
+public:
+	explicit BoundedQueue(size_t capacity) : capacity(capacity > 0 ? capacity : 1), closed(false) {}
+
+	/**
+	 * Appends item to the queue, waiting until there is room for it.
+	 * @return false if the queue was closed, and item wasn't appended.
+	 */
+	bool push(const T& item) {
+		std::unique_lock<std::mutex> lock(mutex);
+		notFull.wait(lock, [this] { return closed || items.size() < capacity; });
+		if (closed) {
+			return false;
+		}
+		items.push_back(item);
+		notEmpty.notify_one();
+		return true;
+	}
+
+	/**
+	 * Removes the first item of the queue into item, waiting until there is one.
+	 * @return false if the queue was closed and all of its items were already removed.
+	 */
+	bool pop(T& item) {
+		std::unique_lock<std::mutex> lock(mutex);
+		notEmpty.wait(lock, [this] { return closed || !items.empty(); });
+		if (items.empty()) {
+			return false;
+		}
+		item = items.front();
+		items.pop_front();
+		notFull.notify_one();
+		return true;
+	}
+
+	/**
+	 * No more items will be pushed. Consumers drain the remaining items and then stop.
+	 */
+	void close() {
+		std::lock_guard<std::mutex> lock(mutex);
+		closed = true;
+		notFull.notify_all();
+		notEmpty.notify_all();
+	}
+};
+
+/**
+ * A staged executor for queries. Each stage runs on its own pool of workers, and the
+ * stages are connected by BoundedQueues, so several queries are in flight at once
+ * (e.g. one being decoded while another is searched) and the throughput is set by the
+ * slowest stage rather than by the sum of all stages.
+ */
+class QueryPipeline {
+private:
+	struct Stage {
+		std::function<void(QueryJob&)> process;
+		int numOfWorkers;
+	};
+	std::vector<Stage> stages;
+	int queueSize;
+public:
+
+	/**
+	 * Creates an empty pipeline.
+	 * @param queueSize - the capacity of each queue between two stages
+	 */
+	explicit QueryPipeline(int queueSize);
+
+	/**
+	 * Appends a stage to the pipeline.
+	 *
+	 * @param process - processes a single query, setting QueryJob::failed on failure
+	 * @param numOfWorkers - the number of threads running this stage
+	 */
+	void addStage(std::function<void(QueryJob&)> process, int numOfWorkers);
+
+	/**
+	 * Runs all the jobs through all the stages, and returns once every job either
+	 * went through the last stage or failed. The order in which the jobs complete
+	 * isn't defined, so each job keeps its own results.
+	 *
+	 * @param jobs - the queries to process
+	 * @return
+	 * false if the workers couldn't be started, in which case the jobs which
+	 * weren't processed are marked as failed. Otherwise, true.
+	 */
+	bool run(std::vector<QueryJob>& jobs);
+};
+
+}
+#endif
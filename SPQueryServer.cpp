@@ -0,0 +1,417 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "SPQueryServer.h"
+#include "SPQueryPipeline.h"
+extern "C" {
+#include "SPLogger.h"
+#include "SPKDArray.h"
+}
+
+#define SERVER_SOCKET_ERROR "Server socket couldn't be opened"
+#define SERVER_WORKER_ERROR "Server worker couldn't be started"
+#define SERVER_ACCEPT_ERROR "Server couldn't accept clients"
+#define SERVER_ACCEPT_WARNING "Server is out of resources for new clients, pausing accepting them"
+#define SERVER_STARTED "Query server STARTED\n"
+#define SERVER_STOPPED "Query server STOPPED\n"
+#define SERVER_MAX_LINE 2048
+#define SERVER_MAX_FEATURES (1 << 20)
+#define SERVER_QUEUE_SIZE 64
+#define SERVER_READ_TIMEOUT_SEC 10 // a request stalled for longer drops its client
+#define SERVER_IDLE_TIMEOUT_SEC 300 // a client idle for longer is dropped
+#define SERVER_ACCEPT_BACKOFF_MS 100 // the pause of accepting clients when out of resources
+#define SERVER_POLL_INTERVAL_MS 1000
+
+using namespace std;
+
+namespace {
+
+/**
+ * Buffered reading of requests from a client socket.
+ */
+class ClientReader {
+private:
+	int fd;
+	char buffer[SERVER_MAX_LINE];
+	size_t start, end;
+
+	bool fill() {
+		if (start == end) {
+			start = end = 0;
+		}
+		if (end == sizeof(buffer)) { // a full buffer without a complete line
+			return false;
+		}
+		ssize_t n = read(fd, buffer + end, sizeof(buffer) - end);
+		if (n <= 0) {
+			return false;
+		}
+		end += n;
+		return true;
+	}
+public:
+	explicit ClientReader(int fd) : fd(fd), start(0), end(0) {}
+
+	/**
+	 * Reads what the client already sent, without waiting for more. Returns false on EOF or
+	 * error, or if the buffer is full without a complete line.
+	 */
+	bool readAvailable() {
+		if (start > 0) { // making room for the rest of the line
+			memmove(buffer, buffer + start, end - start);
+			end -= start;
+			start = 0;
+		}
+		if (end == sizeof(buffer)) {
+			return false;
+		}
+		ssize_t n = recv(fd, buffer + end, sizeof(buffer) - end, MSG_DONTWAIT);
+		if (n > 0) {
+			end += n;
+			return true;
+		}
+		return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR);
+	}
+
+	/**
+	 * Returns true if a complete line was already read from the socket.
+	 */
+	bool hasLine() const {
+		return memchr(buffer + start, '\n', end - start) != NULL;
+	}
+
+	/**
+	 * Reads the next line without its line break. Returns false on EOF or error.
+	 */
+	bool readLine(string& line) {
+		while (true) {
+			char* newline = (char*) memchr(buffer + start, '\n', end - start);
+			if (newline != NULL) {
+				line.assign(buffer + start, newline - (buffer + start));
+				if (!line.empty() && line[line.size()-1] == '\r') {
+					line.erase(line.size()-1);
+				}
+				start = newline - buffer + 1;
+				return true;
+			}
+			if (start > 0) { // making room for the rest of the line
+				memmove(buffer, buffer + start, end - start);
+				end -= start;
+				start = 0;
+			}
+			if (!fill()) {
+				return false;
+			}
+		}
+	}
+
+	/**
+	 * Reads exactly size bytes into dest. Returns false on EOF or error.
+	 */
+	bool readExact(char* dest, size_t size) {
+		while (size > 0) {
+			if (start == end && !fill()) {
+				return false;
+			}
+			size_t n = (end - start < size) ? end - start : size;
+			memcpy(dest, buffer + start, n);
+			start += n;
+			dest += n;
+			size -= n;
+		}
+		return true;
+	}
+};
+
+bool sendAll(int fd, const string& data) {
+	size_t sent = 0;
+	while (sent < data.size()) {
+		ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+		if (n <= 0) {
+			return false;
+		}
+		sent += n;
+	}
+	return true;
+}
+
+}
+
+struct sp::QueryServer::Client {
+	int fd;
+	ClientReader reader;
+	chrono::steady_clock::time_point lastActive;
+
+	explicit Client(int fd) : fd(fd), reader(fd), lastActive(chrono::steady_clock::now()) {}
+	~Client() {
+		close(fd);
+	}
+};
+
+sp::QueryServer::QueryServer(const char* socketPath, int numOfWorkers, int pcaDim, int numOfResults,
+		PathRanker rankPath, QueryRanker rankImages) :
+		socketPath(socketPath), numOfWorkers(numOfWorkers > 0 ? numOfWorkers : 1), pcaDim(pcaDim),
+		numOfResults(numOfResults), rankPath(rankPath), rankImages(rankImages), listenFd(-1),
+		stopped(false) {
+	wakeFds[0] = wakeFds[1] = -1;
+}
+
+bool sp::QueryServer::run() {
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (socketPath.size() >= sizeof(address.sun_path)) {
+		spLoggerPrintError(SERVER_SOCKET_ERROR, __FILE__, __func__, __LINE__);
+		return false;
+	}
+	strcpy(address.sun_path, socketPath.c_str());
+	unlink(address.sun_path);
+	listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+	// only the user running the server may connect, which is also what allows SHUTDOWN - the mode is
+	// set before listen, so no client can connect while it's still the default one
+	if (listenFd < 0 || bind(listenFd, (struct sockaddr*) &address, sizeof(address)) < 0
+			|| chmod(address.sun_path, S_IRUSR | S_IWUSR) < 0 || listen(listenFd, SOMAXCONN) < 0
+			|| pipe(wakeFds) < 0) {
+		spLoggerPrintError(SERVER_SOCKET_ERROR, __FILE__, __func__, __LINE__);
+		if (listenFd >= 0) {
+			close(listenFd);
+			unlink(address.sun_path);
+		}
+		return false;
+	}
+
+	// the clients with a request wait in <pending> for a free worker
+	BoundedQueue<Client*> pending(SERVER_QUEUE_SIZE);
+	vector<thread> workers;
+	bool started = true;
+	try {
+		for (int w = 0; w < numOfWorkers; w++) {
+			workers.push_back(thread([this, &pending] {
+				Client* client;
+				while (pending.pop(client)) {
+					serveClient(client);
+				}
+			}));
+		}
+	} catch (...) {
+		spLoggerPrintError(SERVER_WORKER_ERROR, __FILE__, __func__, __LINE__);
+		started = false;
+		stopped = true;
+	}
+
+	bool failed = false;
+	if (started) {
+		spLoggerPrintInfo(SERVER_STARTED);
+		dispatch(&pending, &failed);
+	}
+
+	pending.close();
+	for (size_t w = 0; w < workers.size(); w++) {
+		workers[w].join();
+	}
+	Client* client;
+	while (pending.pop(client)) { // clients dispatched after the workers stopped
+		delete client;
+	}
+	for (size_t c = 0; c < returned.size(); c++) {
+		delete returned[c];
+	}
+	returned.clear();
+	close(wakeFds[0]);
+	close(wakeFds[1]);
+	close(listenFd);
+	unlink(socketPath.c_str());
+	spLoggerPrintInfo(SERVER_STOPPED);
+	return started && !failed;
+}
+
+void sp::QueryServer::dispatch(BoundedQueue<Client*>* pending, bool* failed) {
+	vector<Client*> idle;
+	vector<struct pollfd> fds;
+	chrono::steady_clock::time_point acceptResume = chrono::steady_clock::now();
+	while (!stopped) {
+		chrono::steady_clock::time_point now = chrono::steady_clock::now();
+		{
+			lock_guard<mutex> lock(returnedMutex);
+			idle.insert(idle.end(), returned.begin(), returned.end());
+			returned.clear();
+		}
+		// dropping the clients idle for too long
+		size_t kept = 0;
+		for (size_t c = 0; c < idle.size(); c++) {
+			if (now - idle[c]->lastActive > chrono::seconds(SERVER_IDLE_TIMEOUT_SEC)) {
+				delete idle[c];
+			} else {
+				idle[kept++] = idle[c];
+			}
+		}
+		idle.resize(kept);
+
+		// polling the wake pipe, the listening socket (unless accepting is paused) and the idle clients
+		bool accepting = now >= acceptResume;
+		fds.assign(1, pollfd { wakeFds[0], POLLIN, 0 });
+		fds.push_back(pollfd { accepting ? listenFd : -1, POLLIN, 0 });
+		for (size_t c = 0; c < idle.size(); c++) {
+			fds.push_back(pollfd { idle[c]->fd, POLLIN, 0 });
+		}
+		int timeout = accepting ? SERVER_POLL_INTERVAL_MS : SERVER_ACCEPT_BACKOFF_MS;
+		if (poll(fds.data(), fds.size(), timeout) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			spLoggerPrintError(SERVER_ACCEPT_ERROR, __FILE__, __func__, __LINE__);
+			*failed = true;
+			break;
+		}
+		if (fds[0].revents != 0) { // emptying the wake pipe, the returned clients are taken above
+			char wake[64];
+			if (read(wakeFds[0], wake, sizeof(wake)) < 0) {
+				continue;
+			}
+		}
+
+		// each client with a request (or which closed its connection) goes to a worker
+		kept = 0;
+		for (size_t c = 0; c < idle.size(); c++) {
+			if (fds[c + 2].revents == 0) {
+				idle[kept++] = idle[c];
+			} else if (!pending->push(idle[c])) {
+				delete idle[c];
+			}
+		}
+		idle.resize(kept);
+
+		if (fds[1].revents != 0) {
+			int clientFd = accept(listenFd, NULL, NULL);
+			if (clientFd >= 0) {
+				// a client stalling in the middle of its features, or not reading its answer, is dropped
+				struct timeval timeout = { SERVER_READ_TIMEOUT_SEC, 0 };
+				setsockopt(clientFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+				setsockopt(clientFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+				Client* client = new (nothrow) Client(clientFd);
+				if (client == NULL) {
+					close(clientFd);
+				} else {
+					idle.push_back(client);
+				}
+			} else if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+				spLoggerPrintWarning(SERVER_ACCEPT_WARNING, __FILE__, __func__, __LINE__);
+				acceptResume = chrono::steady_clock::now() + chrono::milliseconds(SERVER_ACCEPT_BACKOFF_MS);
+			} else if (errno != EINTR && errno != ECONNABORTED && errno != EAGAIN && errno != EWOULDBLOCK) {
+				spLoggerPrintError(SERVER_ACCEPT_ERROR, __FILE__, __func__, __LINE__);
+				*failed = true;
+				break;
+			}
+		}
+	}
+	stopped = true;
+	for (size_t c = 0; c < idle.size(); c++) {
+		delete idle[c];
+	}
+}
+
+void sp::QueryServer::stop() {
+	stopped = true;
+	if (write(wakeFds[1], "", 1) < 0) { // the dispatcher still stops within the poll interval
+		return;
+	}
+}
+
+void sp::QueryServer::returnClient(Client* client) {
+	client->lastActive = chrono::steady_clock::now();
+	{
+		lock_guard<mutex> lock(returnedMutex);
+		returned.push_back(client);
+	}
+	if (write(wakeFds[1], "", 1) < 0) { // the dispatcher still polls it within the poll interval
+		return;
+	}
+}
+
+void sp::QueryServer::serveClient(Client* client) {
+	// only the complete requests the client already sent are served, so a client which sent part of
+	// a request line doesn't hold the worker, and waits for the rest like an idle one
+	bool open = !stopped && client->reader.readAvailable();
+	while (open && !stopped && client->reader.hasLine()) {
+		open = serveRequest(client);
+	}
+	if (open && !stopped) {
+		returnClient(client);
+	} else {
+		delete client;
+	}
+}
+
+bool sp::QueryServer::serveRequest(Client* client) {
+	int clientFd = client->fd;
+	string line;
+	char path[SERVER_MAX_LINE] = { '\0' };
+	if (!client->reader.readLine(line)) {
+		return false;
+	}
+	int count = 0, dim = 0;
+	bool degraded = false;
+	if (line == "SHUTDOWN") {
+		sendAll(clientFd, "OK 0\n");
+		stop();
+		return false;
+	} else if (sscanf(line.c_str(), "QUERY %2047[^\n]", path) == 1) {
+		BPQueueElement* ranking = rankPath(path, &degraded);
+		return answer(clientFd, ranking, degraded);
+	} else if (sscanf(line.c_str(), "FEATURES %d %d", &count, &dim) == 2) {
+		if (count < 1 || count > SERVER_MAX_FEATURES || dim != pcaDim) {
+			sendAll(clientFd, "ERROR invalid feature count or dimension\n");
+			return false; // the features which follow can't be skipped reliably
+		}
+		vector<double> data((size_t) count * dim);
+		if (!client->reader.readExact((char*) data.data(), data.size() * sizeof(double))) {
+			return false;
+		}
+		SPPoint** features = (SPPoint**) malloc(count * sizeof(SPPoint*));
+		int created = 0;
+		while (features != NULL && created < count
+				&& (features[created] = spPointCreate(&data[(size_t) created * dim], dim, 0)) != NULL) {
+			created++;
+		}
+		bool ok;
+		if (features == NULL || created < count) {
+			spLoggerPrintError(ALLOCATION_ERROR, __FILE__, __func__, __LINE__);
+			ok = sendAll(clientFd, "ERROR allocation failure\n");
+		} else {
+			BPQueueElement* ranking = rankImages(features, count, &degraded);
+			ok = answer(clientFd, ranking, degraded);
+		}
+		if (created > 0) {
+			spPoint1DDestroy(features, created);
+		} else {
+			free(features);
+		}
+		return ok;
+	}
+	return sendAll(clientFd, "ERROR unknown request\n");
+}
+
+bool sp::QueryServer::answer(int clientFd, BPQueueElement* ranking, bool degraded) {
+	if (ranking == NULL) {
+		return sendAll(clientFd, "ERROR query couldn't be answered\n");
+	}
+	char entry[64];
+	sprintf(entry, degraded ? "OK %d DEGRADED\n" : "OK %d\n", numOfResults);
+	string response(entry);
+	for (int i = 0; i < numOfResults; i++) {
+		sprintf(entry, "%d %d\n", ranking[i].index, (int) ranking[i].value);
+		response += entry;
+	}
+	free(ranking);
+	return sendAll(clientFd, response);
+}
@@ -0,0 +1,106 @@
+#ifndef SPQUERYSERVER_H_
+#define SPQUERYSERVER_H_
+
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <atomic>
+
+extern "C" {
+#include "SPPoint.h"
+#include "SPBPriorityQueue.h"
+}
+
+namespace sp {
+
+template<typename T>
+class BoundedQueue;
+
+/**
+ * A query server listening on a local Unix domain socket. The index is loaded once by the
+ * caller, and the server answers the queries of any number of local clients. The connections
+ * are polled by a dispatcher, and each request which arrives is served by one of a fixed pool
+ * of workers once its request line is complete, so idle connections don't hold a worker.
+ * A connection which stalls in the middle of the features of a request, or stays idle for long,
+ * is dropped.
+ *
+ * The socket is only accessible by the user running the server (mode 0600), which is also what
+ * allows a client to send SHUTDOWN.
+ *
+ * The protocol is line based. Each request is one of:
+ *
+ * QUERY <path>\n 				 - query by an image path, or a precomputed ".feats" file path
+ * FEATURES <count> <dim>\n		 - query by raw features, followed by count*dim doubles in the
+ * 								   native byte order of the server
+ * SHUTDOWN\n 					 - stop the server
+ *
+ * Each query is answered by:
+ *
+ * OK <n>\n followed by n lines of <image index> <feature hits>\n, best image first.
+ * 	 The first line is OK <n> DEGRADED\n if the search was degraded to meet the query deadline.
+ * ERROR <reason>\n if the query couldn't be answered
+ *
+ * A connection may send any number of requests, and is closed by the client.
+ */
+class QueryServer {
+public:
+	/**
+	 * Ranks the images by the feature hits of the query path, best image first, and sets
+	 * degraded if the search was degraded to meet the query deadline. Returns NULL on failure.
+	 */
+	typedef std::function<BPQueueElement*(const char* path, bool* degraded)> PathRanker;
+
+	/**
+	 * Ranks the images by the feature hits of the query features, best image first, and sets
+	 * degraded if the search was degraded to meet the query deadline. Returns NULL on failure.
+	 */
+	typedef std::function<BPQueueElement*(SPPoint** features, int numOfFeatures, bool* degraded)> QueryRanker;
+
+private:
+	std::string socketPath;
+	int numOfWorkers;
+	int pcaDim;
+	int numOfResults;
+	PathRanker rankPath;
+	QueryRanker rankImages;
+	int listenFd;
+	int wakeFds[2]; // a pipe waking the dispatcher when a client is returned or the server stops
+	std::atomic<bool> stopped;
+	struct Client; // a connection and its buffered requests
+	std::mutex returnedMutex;
+	std::vector<Client*> returned; // the clients served by the workers, to be polled again
+
+	void dispatch(BoundedQueue<Client*>* pending, bool* failed);
+	void serveClient(Client* client);
+	bool serveRequest(Client* client);
+	bool answer(int clientFd, BPQueueElement* ranking, bool degraded);
+	void returnClient(Client* client);
+	void stop();
+public:
+
+	/**
+	 * Creates a new server. Nothing is opened until run is called.
+	 *
+	 * @param socketPath - the path of the Unix domain socket, replaced if it already exists
+	 * @param numOfWorkers - the number of requests served concurrently
+	 * @param pcaDim - the dimension of the features sent in FEATURES requests
+	 * @param numOfResults - the number of images returned for each query
+	 * @param rankPath - used to answer QUERY requests
+	 * @param rankImages - used to answer FEATURES requests
+	 */
+	QueryServer(const char* socketPath, int numOfWorkers, int pcaDim, int numOfResults,
+			PathRanker rankPath, QueryRanker rankImages);
+
+	/**
+	 * Serves the clients until a SHUTDOWN request is received.
+	 *
+	 * @return
+	 * false if the socket couldn't be opened, the workers couldn't be started or accepting
+	 * the clients failed. Otherwise, true.
+	 */
+	bool run();
+};
+
+}
+#endif
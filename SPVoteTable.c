@@ -0,0 +1,225 @@
+#include "SPVoteTable.h"
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+#define EMPTY_SLOT -1
+
+struct sp_vote_table_t {
+	int* keys;					//image index of each slot, EMPTY_SLOT if unused
+	int* votes;					//votes of each slot
+	int* touched;				//the slots in use, in the order they were taken
+	int capacity;				//number of slots, always a power of 2
+	int size;					//number of slots in use
+};
+
+/**
+ * Returns the slot of index - either the slot holding it, or the empty slot it should go to.
+ */
+static int spVoteTableFindSlot(SPVoteTable* table, int index) {
+	unsigned int mask = (unsigned int) table->capacity - 1;
+	unsigned int slot = ((unsigned int) index * 2654435761u) & mask; // multiplicative hashing
+	while (table->keys[slot] != EMPTY_SLOT && table->keys[slot] != index) {
+		slot = (slot + 1) & mask; // linear probing
+	}
+	return (int) slot;
+}
+
+/**
+ * Allocates the slots of table, for the given power of 2 capacity.
+ */
+static bool spVoteTableAllocSlots(SPVoteTable* table, int capacity) {
+	table->keys = (int*) malloc(capacity*sizeof(int));
+	table->votes = (int*) malloc(capacity*sizeof(int));
+	table->touched = (int*) malloc((capacity/2)*sizeof(int)); //the table never gets more than half full
+	if (table->keys==NULL || table->votes==NULL || table->touched==NULL) {
+		free(table->keys);
+		free(table->votes);
+		free(table->touched);
+		return false;
+	}
+	memset(table->keys, EMPTY_SLOT, capacity*sizeof(int)); //every byte 0xFF, i.e -1
+	table->capacity = capacity;
+	table->size = 0;
+	return true;
+}
+
+/**
+ * Doubles the capacity of table, rehashing the images which received votes.
+ */
+static bool spVoteTableGrow(SPVoteTable* table) {
+	SPVoteTable old = *table;
+	if (!spVoteTableAllocSlots(table, old.capacity*2)) {
+		*table = old;
+		return false;
+	}
+	for (int i=0; i<old.size; i++) {
+		int slot = spVoteTableFindSlot(table, old.keys[old.touched[i]]);
+		table->keys[slot] = old.keys[old.touched[i]];
+		table->votes[slot] = old.votes[old.touched[i]];
+		table->touched[table->size++] = slot;
+	}
+	free(old.keys);
+	free(old.votes);
+	free(old.touched);
+	return true;
+}
+
+/**
+ * Returns true if element a ranks lower than element b, i.e fewer votes, or the same
+ * votes and a higher index.
+ */
+static bool spVoteTableRanksLower(BPQueueElement* a, BPQueueElement* b) {
+	return (a->value < b->value) || (a->value == b->value && a->index > b->index);
+}
+
+/**
+ * Restores the heap property of the min-heap (by rank) heap[0..size) from position i down.
+ */
+static void spVoteTableSiftDown(BPQueueElement* heap, int size, int i) {
+	while (true) {
+		int lowest = i;
+		int left = 2*i+1, right = 2*i+2;
+		if (left < size && spVoteTableRanksLower(&heap[left], &heap[lowest]))
+			lowest = left;
+		if (right < size && spVoteTableRanksLower(&heap[right], &heap[lowest]))
+			lowest = right;
+		if (lowest == i)
+			return;
+		BPQueueElement temp = heap[i];
+		heap[i] = heap[lowest];
+		heap[lowest] = temp;
+		i = lowest;
+	}
+}
+
+SPVoteTable* spVoteTableCreate(int capacity) {
+	if (capacity <= 0)
+		return NULL;
+
+	SPVoteTable* table = (SPVoteTable*) malloc(sizeof(SPVoteTable));
+	if (table == NULL)				//memory allocation failure
+		return NULL;
+
+	int slots = 16;
+	while (slots/2 < capacity && slots < (1 << 30)) {	//keeping the table at most half full
+		slots *= 2;
+	}
+	if (!spVoteTableAllocSlots(table, slots)) {			//memory allocation failure
+		free(table);
+		return NULL;
+	}
+	return table;
+}
+
+void spVoteTableDestroy(SPVoteTable* table) {
+	if (table == NULL)
+		return;
+
+	free(table->keys);
+	free(table->votes);
+	free(table->touched);
+	free(table);
+}
+
+void spVoteTableClear(SPVoteTable* table) {
+	if (table == NULL)
+		return;
+
+	for (int i=0; i<table->size; i++) {		//only the slots in use
+		table->keys[table->touched[i]] = EMPTY_SLOT;
+	}
+	table->size = 0;
+}
+
+SP_VOTE_TABLE_MSG spVoteTableAdd(SPVoteTable* table, int index, int votes) {
+	if (table==NULL || index<0 || votes<=0)		//invalid arguments
+		return SP_VOTE_TABLE_INVALID_ARGUMENT;
+
+	int slot = spVoteTableFindSlot(table, index);
+	if (table->keys[slot] == index) {			//the image already has votes
+		table->votes[slot] += votes;
+		return SP_VOTE_TABLE_SUCCESS;
+	}
+	if (table->size+1 > table->capacity/2) {	//keeping the table at most half full
+		if (!spVoteTableGrow(table))
+			return SP_VOTE_TABLE_OUT_OF_MEMORY;
+		slot = spVoteTableFindSlot(table, index);
+	}
+	table->keys[slot] = index;
+	table->votes[slot] = votes;
+	table->touched[table->size++] = slot;
+	return SP_VOTE_TABLE_SUCCESS;
+}
+
+int spVoteTableGet(SPVoteTable* table, int index) {
+	assert(table!=NULL);
+
+	if (index < 0)
+		return 0;
+	int slot = spVoteTableFindSlot(table, index);
+	return (table->keys[slot] == index) ? table->votes[slot] : 0;
+}
+
+int spVoteTableSize(SPVoteTable* table) {
+	assert(table!=NULL);
+
+	return table->size;
+}
+
+SP_VOTE_TABLE_MSG spVoteTableMerge(SPVoteTable* dest, SPVoteTable* source) {
+	if (dest==NULL || source==NULL)				//invalid arguments
+		return SP_VOTE_TABLE_INVALID_ARGUMENT;
+
+	for (int i=0; i<source->size; i++) {
+		int slot = source->touched[i];
+		SP_VOTE_TABLE_MSG msg = spVoteTableAdd(dest, source->keys[slot], source->votes[slot]);
+		if (msg != SP_VOTE_TABLE_SUCCESS)
+			return msg;
+	}
+	return SP_VOTE_TABLE_SUCCESS;
+}
+
+int spVoteTableTopN(SPVoteTable* table, int n, int numOfImgs, BPQueueElement* res) {
+	if (table==NULL || res==NULL || n<=0 || n>numOfImgs)	//invalid arguments
+		return -1;
+
+	// keeping the best n voted images in a min-heap, its root is the lowest ranked of them
+	int heapSize = 0;
+	for (int i=0; i<table->size; i++) {
+		int slot = table->touched[i];
+		BPQueueElement element = {table->keys[slot], (double) table->votes[slot]};
+		if (heapSize < n) {
+			res[heapSize++] = element;
+			if (heapSize == n) {			//building the heap once it's full
+				for (int j=n/2-1; j>=0; j--)
+					spVoteTableSiftDown(res, n, j);
+			}
+		}
+		else if (spVoteTableRanksLower(&res[0], &element)) {	//element replaces the lowest ranked
+			res[0] = element;
+			spVoteTableSiftDown(res, n, 0);
+		}
+	}
+	if (heapSize < n) {
+		for (int j=heapSize/2-1; j>=0; j--)
+			spVoteTableSiftDown(res, heapSize, j);
+	}
+
+	// sorting the heap, best first, by repeatedly moving its root to the end
+	for (int last=heapSize-1; last>0; last--) {
+		BPQueueElement temp = res[0];
+		res[0] = res[last];
+		res[last] = temp;
+		spVoteTableSiftDown(res, last, 0);
+	}
+
+	// less than n images received votes - the next ones are the lowest indexes without votes
+	for (int index=0; heapSize<n && index<numOfImgs; index++) {
+		if (spVoteTableGet(table, index) == 0) {
+			BPQueueElement element = {index, 0};
+			res[heapSize++] = element;
+		}
+	}
+	return n;
+}
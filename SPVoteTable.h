@@ -0,0 +1,115 @@
+#ifndef SPVOTETABLE_H_
+#define SPVOTETABLE_H_
+#include <stdbool.h>
+#include "SPBPriorityQueue.h"
+
+/**
+ * SP Vote Table summary
+ * Encapsulates a sparse counter of feature hits per image. Only the images which
+ * received votes are stored (in an open addressing hash table), so the memory and the
+ * time needed to clear or rank the table depend on the number of voted images rather
+ * than on the number of images in the database.
+ *
+ * The following functions are supported:
+ *
+ * spVoteTableCreate		- Creates a new table
+ * spVoteTableDestroy		- Free all resources associated with a table
+ * spVoteTableClear			- Removes all the votes of a given table
+ * spVoteTableAdd			- Adds votes to an image
+ * spVoteTableGet			- A getter of the votes of an image
+ * spVoteTableSize			- A getter of the number of images which received votes
+ * spVoteTableMerge			- Adds all the votes of a table to another table
+ * spVoteTableTopN			- Retrieves the images with the most votes
+ */
+
+/** type used to define the vote table **/
+typedef struct sp_vote_table_t SPVoteTable;
+
+/** type for error reporting **/
+typedef enum sp_vote_table_msg_t {
+	SP_VOTE_TABLE_OUT_OF_MEMORY,
+	SP_VOTE_TABLE_INVALID_ARGUMENT,
+	SP_VOTE_TABLE_SUCCESS
+} SP_VOTE_TABLE_MSG;
+
+/**
+ * Allocates a new empty table in the memory.
+ * The table grows as needed, capacity only avoids growing it while
+ * up to capacity images receive votes.
+ *
+ * @return
+ * NULL in case allocation failure occurred OR capacity <= 0
+ * Otherwise, the new table is returned
+ */
+SPVoteTable* spVoteTableCreate(int capacity);
+
+/**
+ * Free all memory allocation associated with the table,
+ * if table is NULL nothing happens.
+ */
+void spVoteTableDestroy(SPVoteTable* table);
+
+/**
+ * Removes all the votes of the table, in time proportional to the number
+ * of images which received votes.
+ * If table is NULL nothing happens.
+ */
+void spVoteTableClear(SPVoteTable* table);
+
+/**
+ * Adds votes to the image index.
+ *
+ * @return
+ * SP_VOTE_TABLE_INVALID_ARGUMENT in case table==NULL OR index<0 OR votes<=0
+ * SP_VOTE_TABLE_OUT_OF_MEMORY in case the table couldn't grow
+ * SP_VOTE_TABLE_SUCCESS otherwise
+ */
+SP_VOTE_TABLE_MSG spVoteTableAdd(SPVoteTable* table, int index, int votes);
+
+/**
+ * A getter of the votes of the image index.
+ *
+ * @assert table != NULL
+ * @return
+ * The votes of the image, 0 if it didn't receive any
+ */
+int spVoteTableGet(SPVoteTable* table, int index);
+
+/**
+ * A getter of the number of images which received votes.
+ *
+ * @assert table != NULL
+ */
+int spVoteTableSize(SPVoteTable* table);
+
+/**
+ * Adds all the votes of source to dest.
+ *
+ * @return
+ * SP_VOTE_TABLE_INVALID_ARGUMENT in case dest==NULL OR source==NULL
+ * SP_VOTE_TABLE_OUT_OF_MEMORY in case dest couldn't grow
+ * SP_VOTE_TABLE_SUCCESS otherwise
+ */
+SP_VOTE_TABLE_MSG spVoteTableMerge(SPVoteTable* dest, SPVoteTable* source);
+
+/**
+ * Retrieves the n images with the most votes into res, sorted by the number of votes,
+ * the best first. Images with the same number of votes are sorted by their index, the
+ * lowest first. If less than n images received votes, the rest of res is filled with the
+ * lowest indexes which didn't receive any, so res is the same as the first n elements of
+ * all the numOfImgs images sorted by their votes.
+ * Runs in O(size * log(n)), without visiting the images which didn't receive votes.
+ *
+ * @param table		- the source table
+ * @param n			- the number of images to retrieve
+ * @param numOfImgs	- the number of images in the database
+ * @param res		- an array of at least n elements, in which the images are stored.
+ * 					  res[i].index is the image index, and res[i].value its votes
+ *
+ * @return
+ * -1 in case table==NULL OR res==NULL OR n<=0 OR n>numOfImgs, or allocation failure
+ * Otherwise, n
+ */
+int spVoteTableTopN(SPVoteTable* table, int n, int numOfImgs, BPQueueElement* res);
+
+#endif /* SPVOTETABLE_H_ */
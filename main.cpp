@@ -2,14 +2,29 @@
 
 int main(int argc, char* argv[]) {
 	char config_filename[STR_MAX_LENGTH+1] = DEFAULT_CONFIG_FILENAME; // default config file
+	char queryListFilename[STR_MAX_LENGTH+1] = {'\0'}; // batch mode query list, empty in interactive mode
+	char resultsFilename[STR_MAX_LENGTH+1] = DEFAULT_RESULTS_FILENAME; // batch mode results file
+	char socketFilename[STR_MAX_LENGTH+1] = {'\0'}; // server mode socket, empty if not in server mode
+	bool configFromCommandLine = false;
 	SPConfig config;
 	SP_CONFIG_MSG msg;
 	ImageProc* imageProc;
 
 	//-------checking command line arguments-------
-	if (argc > 1) { // checks if config file entered?
-		if (argc == 3 && strcmp(argv[1], "-c") == 0) { // correct num of args && -c flag
-			strcpy(config_filename, argv[2]);
+	for (int i=1; i<argc; i+=2) { // every flag is followed by a filename
+		if (i+1 >= argc || strlen(argv[i+1]) > STR_MAX_LENGTH) { //invalid args
+			printf(INVALID_COMMAND_LINE_ERROR, config_filename);
+			return -1;
+		}
+		if (strcmp(argv[i], "-c") == 0) { // config file
+			strcpy(config_filename, argv[i+1]);
+			configFromCommandLine = true;
+		} else if (strcmp(argv[i], "-q") == 0) { // batch mode query list
+			strcpy(queryListFilename, argv[i+1]);
+		} else if (strcmp(argv[i], "-o") == 0) { // batch mode results file
+			strcpy(resultsFilename, argv[i+1]);
+		} else if (strcmp(argv[i], "-s") == 0) { // server mode socket
+			strcpy(socketFilename, argv[i+1]);
 		} else { //invalid args
 			printf(INVALID_COMMAND_LINE_ERROR, config_filename);
 			return -1;
@@ -20,7 +35,7 @@ int main(int argc, char* argv[]) {
 	//-------------creating the config-------------
 	config = spConfigCreate(config_filename, &msg);
 	if (msg == SP_CONFIG_CANNOT_OPEN_FILE) {
-		if (argc > 1) { // used config filename from command line
+		if (configFromCommandLine) { // used config filename from command line
 			printf(CONFIG_CANNOT_OPEN_FILE, "", config_filename);
 		}
 		else {  // used default config filename
@@ -30,7 +45,7 @@ int main(int argc, char* argv[]) {
 
 	if (msg != SP_CONFIG_SUCCESS) { // create fail
 		printf(CONFIG_ERROR);
-		terminate(config,NULL,0,NULL,NULL,0,NULL);
+		terminate(config,NULL,NULL);
 		return -1;
 	}
 	else {
@@ -42,14 +57,14 @@ int main(int argc, char* argv[]) {
 	char* logger_filename = spConfigGetLoggerFilename(config, &msg);
 	if (msg != SP_CONFIG_SUCCESS) {
 		printf("%s %s\n", LOGGER_FILENAME, COULDNT_BE_RESOLVED);
-		terminate(config,NULL,0,NULL,NULL,0,NULL);
+		terminate(config,NULL,NULL);
 		return -1;
 	}
 
 	SP_LOGGER_LEVEL logger_level = spConfigGetLoggerLevel(config, &msg);
 	if (msg != SP_CONFIG_SUCCESS) {
 		printf("%s %s\n", LOGGER_LEVEL, COULDNT_BE_RESOLVED);
-		terminate(config,NULL,0,NULL,NULL,0,NULL);
+		terminate(config,NULL,NULL);
 		return -1;
 	}
 
@@ -58,7 +73,7 @@ int main(int argc, char* argv[]) {
 	}
 	if (spLoggerCreate(logger_filename, logger_level) != SP_LOGGER_SUCCESS) {
 		printf("%s\n", LOGGER_ERROR);
-		terminate(config,NULL,0,NULL,NULL,0,NULL);
+		terminate(config,NULL,NULL);
 		return -1;
 	}
 	spLoggerPrintInfo(LOGGER_CREATED);
@@ -66,12 +81,12 @@ int main(int argc, char* argv[]) {
 
 	//-------------creating the ImageProc-------------
 	try {
-		imageProc = new ImageProc(config);
+		imageProc = new ImageProc(config, isPCATrainingNeeded(config));
 	}
 	catch(std::exception & ex )
 	{
 		spLoggerPrintError(IMAGE_PROC_ERROR,__FILE__,__func__,__LINE__);
-		terminate(config,NULL,0,NULL,NULL,0,NULL);
+		terminate(config,NULL,NULL);
 		return -1;
 	}
 	//------------------------------------------------
@@ -81,108 +96,118 @@ int main(int argc, char* argv[]) {
 	if (numOfImgs == -1) { // fail in spConfigGetNumOfImages function
 		spLoggerPrintError(FUNCTION_ERROR,__FILE__,__func__,__LINE__);
 		delete imageProc;
-		terminate(config,NULL,0,NULL,NULL,0,NULL);
+		terminate(config,NULL,NULL);
 		return -1;
 	}
 
-	// creating the SIFT Database
-	int* numOfFeaturesPerImage = (int*) malloc(numOfImgs*sizeof(int));
-	SPPoint*** siftDB = (SPPoint***) malloc(numOfImgs*sizeof(SPPoint**));
-	if (numOfFeaturesPerImage==NULL || siftDB==NULL) { //Allocation failure
+	// creating the feature store, the only copy of the features of the images
+	SPFeatureStore* store = spFeatureStoreCreate(numOfImgs);
+	if (store == NULL) { //Allocation failure
 		spLoggerPrintError(ALLOCATION_ERROR,__FILE__,__func__,__LINE__);
 		delete imageProc;
-		terminate(config,siftDB,numOfImgs,numOfFeaturesPerImage,NULL,0,NULL);
+		terminate(config,NULL,NULL);
 		return -1;
 	}
-	int numOfAllFeatures=0;
 
-	if (extractFeatures(siftDB, numOfImgs, numOfFeaturesPerImage, &numOfAllFeatures, config, &msg, imageProc) == -1) {
+	if (extractFeatures(store, numOfImgs, config, &msg, imageProc) == -1) {
 		spLoggerPrintError(EXTRACTING_FEATS_ERROR,__FILE__,__func__,__LINE__);
 		delete imageProc;
-		terminate(config,siftDB,numOfImgs,numOfFeaturesPerImage,NULL,0,NULL);
+		terminate(config,store,NULL);
 		return -1;
 	}
-	spLoggerPrintInfo(SIFT_DB_CREATED);
+	spLoggerPrintInfo(FEATURE_STORE_CREATED);
 
-	// converting the SIFT Database to one array of all images features
-	SPPoint** allFeaturesArr = (SPPoint**) malloc(numOfAllFeatures*sizeof(SPPoint*));
-	if (allFeaturesArr == NULL) { //Allocation failure
-		spLoggerPrintError(ALLOCATION_ERROR,__FILE__,__func__,__LINE__);
+	// build KDtree (or the Hamming index of ORB features) from all features
+	FeaturesIndex* featuresIndex = buildFeaturesIndex(store, config, &msg);
+	if (featuresIndex == NULL) { // buildFeaturesIndex failed
+		spLoggerPrintError(KD_TREE_ERROR,__FILE__,__func__,__LINE__);
 		delete imageProc;
-		terminate(config,siftDB,numOfImgs,numOfFeaturesPerImage,NULL,0,NULL);
+		terminate(config,store,featuresIndex);
 		return -1;
 	}
+	spLoggerPrintInfo(KD_TREE_CREATED);
+	//-------------------------------------------------------
 
-	if (createAllFeaturesArray(allFeaturesArr, siftDB, numOfImgs, numOfFeaturesPerImage) == numOfAllFeatures) {
-		spLoggerPrintInfo(ALL_FEATURES_ARRAY_CREATED);
-	}
-	else { 		// createAllFeaturesArray failed
-		spLoggerPrintError(ALL_FEATURES_ARRAY_ERROR,__FILE__,__func__,__LINE__);
+	// results of repeated queries, NULL if spQueryCacheSize is 0
+	QueryCache* cache = createQueryCache(config, numOfImgs, spFeatureStoreGetSize(store));
+
+	//-----------server mode: answering the socket clients------
+	if (socketFilename[0] != '\0') {
+		int res = runQueryServer(featuresIndex, numOfImgs, socketFilename, config, imageProc, cache);
+		if (res == -1) {
+			spLoggerPrintError(QUERY_SERVER_ERROR,__FILE__,__func__,__LINE__);
+		}
+		delete cache;
 		delete imageProc;
-		terminate(config,siftDB,numOfImgs,numOfFeaturesPerImage,allFeaturesArr,numOfAllFeatures,NULL);
-		return -1;
+		terminate(config,store,featuresIndex);
+		return res;
 	}
+	//----------------------------------------------------------
 
-	// build KDtree from all features
-	SPKDTreeNode* featuresTree = buildFeaturesKDTree(allFeaturesArr, numOfAllFeatures, config, &msg);
-	if (featuresTree == NULL) { // buildFeaturesKDTree failed
-		spLoggerPrintError(KD_TREE_ERROR,__FILE__,__func__,__LINE__);
+	//-----------batch mode: answering the query list-----------
+	if (queryListFilename[0] != '\0') {
+		int res = runBatchQueries(featuresIndex, numOfImgs, queryListFilename, resultsFilename, config, imageProc,
+				cache);
+		if (res == -1) {
+			spLoggerPrintError(BATCH_QUERIES_ERROR,__FILE__,__func__,__LINE__);
+		}
+		delete cache;
 		delete imageProc;
-		terminate(config,siftDB,numOfImgs,numOfFeaturesPerImage,allFeaturesArr,numOfAllFeatures,featuresTree);
-		return -1;
+		terminate(config,store,featuresIndex);
+		return res;
 	}
-	spLoggerPrintInfo(KD_TREE_CREATED);
-	//-------------------------------------------------------
+	//----------------------------------------------------------
 
 	//---------------------------------------------
 	//-----------starting the query loop-----------
 	//---------------------------------------------
 	char queryPath[STR_MAX_LENGTH+1] = {'\0'};
+	int numOfThreads = spConfigGetNumOfThreads(config, &msg);
 	while (true) {
 		// getting the query path from user
 		if (getQueryPath(queryPath) < 0) {
 			spLoggerPrintError(QUERY_PATH_ERROR,__FILE__,__func__,__LINE__);
+			delete cache;
 			delete imageProc;
-			terminate(config,siftDB,numOfImgs,numOfFeaturesPerImage,allFeaturesArr,numOfAllFeatures,featuresTree);
+			terminate(config,store,featuresIndex);
 			return -1;
 		}
 
 		// if the user terminates the program
 		if (strcmp(queryPath, TERMINATE) == 0) {
+			delete cache;
 			delete imageProc;
-			terminate(config,siftDB,numOfImgs,numOfFeaturesPerImage,allFeaturesArr,numOfAllFeatures,featuresTree);
+			terminate(config,store,featuresIndex);
 			return 1;
 		}
 
-		// getting the querySift DB, finding KNN for each feature, and counting the feature hits for each image
-		int* counter = countKClosestPerFeature(featuresTree, numOfImgs, queryPath, config, &msg, imageProc);
-		if (counter == NULL) { // countKClosestPerFeature failed
-			spLoggerPrintError(COUNT_K_CLOSEST_ERROR,__FILE__,__func__,__LINE__);
+		// getting the querySift DB, finding KNN for each feature, counting the feature hits for each image,
+		// and sorting the images indexes by the number of feature hits
+		bool degraded = false;
+		BPQueueElement* queryClosestImages = findClosestImages(featuresIndex, numOfImgs, queryPath, config, &msg,
+				imageProc, cache, numOfThreads, &degraded);
+		if (queryClosestImages == NULL) { // findClosestImages failed
+			spLoggerPrintError(FIND_CLOSEST_IMAGES_ERROR,__FILE__,__func__,__LINE__);
+			delete cache;
 			delete imageProc;
-			terminate(config,siftDB,numOfImgs,numOfFeaturesPerImage,allFeaturesArr,numOfAllFeatures,featuresTree);
-			return -1;
-			}
-
-		// sorting the images indexes by the number of feature hits
-		BPQueueElement* queryClosestImages = sortFeaturesCount(counter, numOfImgs);
-		if (queryClosestImages == NULL) { // sortFeaturesCount failed
-			spLoggerPrintError(SORT_FEATURES_COUNT_ERROR,__FILE__,__func__,__LINE__);
-			delete imageProc;
-			terminate(config,siftDB,numOfImgs,numOfFeaturesPerImage,allFeaturesArr,numOfAllFeatures,featuresTree);
+			terminate(config,store,featuresIndex);
 			return -1;
 			}
 
 		// showing the results, i.e the numOfSimilarImages closest images to the query image by feature hits
+		if (degraded) {
+			printf(DEGRADED_RESULTS);
+		}
 		if (!showResults(queryPath, queryClosestImages, config, &msg, imageProc)) {
 			spLoggerPrintError(SHOW_RESULTS_ERROR,__FILE__,__func__,__LINE__);
+			delete cache;
 			delete imageProc;
-			terminate(config,siftDB,numOfImgs,numOfFeaturesPerImage,allFeaturesArr,numOfAllFeatures,featuresTree);
+			terminate(config,store,featuresIndex);
 			return -1;
 			}
 
 		// free allocations in this iteration
 		free(queryClosestImages);
-		free(counter);
 	}
 	// end of query loop
 	//---------------------------------------------
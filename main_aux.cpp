@@ -1,31 +1,530 @@
 #include "main_aux.h"
 #include "unistd.h"
+#include <atomic>
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 /**
- * A comparator which compares two SPPoints by i-th coordinate.
+ * The search of the features of one query, shared by the workers of countKClosestForFeatures.
+ * The workers take the next unsearched feature until the block ending at blockEnd is done, and then
+ * meet at a checkpoint, where the last of them to arrive merges the votes of the block and decides
+ * whether to search the next one. Without early termination the whole query is a single block.
+ */
+struct QuerySearch {
+	FeaturesIndex* featuresIndex;
+	SPPoint** querySift;
+	int nFeaturesQuery;
+	int spKNN;
+	int numOfImgs;
+	int decidedTopN;						// 0 if the search isn't ended early
+	long long deadline;						// 0 for no deadline
+	long long searchStart;
+	int numOfWorkers;
+	int blockSize;
+	int blockEnd;							// one past the last feature of the current block
+	SPVoteTable* votes;						// the votes of the blocks searched so far
+	std::vector<SPVoteTable*> workerVotes;	// the votes of each worker in the current block, worker 0 adds to votes
+	BPQueueElement* leaders;				// the best decidedTopN images and the best one trailing them
+	std::atomic<int> nextFeature;
+	std::atomic<int> searchedFeatures;
+	std::atomic<int> maxChecks;				// 0 for exact search, until the deadline is threatened
+	std::atomic<bool> stopped;				// set once no more features should be searched
+	std::atomic<bool> failed;
+	std::atomic<bool> degraded;
+	std::mutex checkpointMutex;
+	std::condition_variable checkpointPassed;
+	int participants;						// the workers meeting at each checkpoint
+	int arrived;							// the workers waiting at the current checkpoint
+	int checkpoints;						// the number of checkpoints passed
+	bool finished;
+};
+
+/**
+ * Finding KNN for the next query features of the search, and adding the feature hits of each image to
+ * the vote table of the worker, until the search is finished. Before each feature the deadline is
+ * checked, and the search degrades to approximate search, or stops, to meet it.
+ * Used as the body of each countKClosestForFeatures worker.
+ *
+ * @param search 	 	 - the search, its failed flag is set if a feature couldn't be searched
+ * @param worker 	 	 - the index of the worker
+ */
+void countKClosestWorker(QuerySearch* search, int worker);
+
+/**
+ * Waits until all the workers of the search finished the current block, the last of them
+ * merging the votes of the block and moving the search to the next block, if any.
+ *
+ * @param search 	 	 - the search
+ *
+ * @return
+ * true if the next block should be searched, false if the search is finished
+ */
+bool querySearchCheckpoint(QuerySearch* search);
+
+/**
+ * Merges the votes of the workers into the votes of the search, and decides whether the
+ * next block should be searched. Called by the last worker at a checkpoint, with the
+ * checkpoint mutex held.
+ *
+ * @param search 	 	 - the search
+ */
+void querySearchNextBlock(QuerySearch* search);
+
+/**
+ * Returns the number of best images whose ranking ends the search early,
+ * i.e spNumOfSimilarImages in early termination mode and 0 otherwise.
+ *
+ * @param config - the configuration structure
+ *
+ * @return
+ * -1 in case of failure, otherwise the value passed as decidedTopN to countKClosestForFeatures
+ */
+int decidedTopNFromConfig(SPConfig config);
+
+/**
+ * Moves the features of an image into the feature store,
+ * destroying them if the store couldn't take them.
+ *
+ * @param store 		 - the feature store
+ * @param imgIndex 		 - the index of the image
+ * @param features 		 - the features of the image
+ * @param numOfFeatures	 - the number of features of the image
+ *
+ * @return
+ * true if the features were added, false otherwise
+ */
+bool addImageFeatures(SPFeatureStore* store, int imgIndex, SPPoint** features, int numOfFeatures);
+
+/**
+ * Reads the feats files of the images, taking the next unread image until all the images were
+ * read or a worker failed. The features of image i are stored in its own slot <features>[i].
+ *
+ * @param config 		 - the configuration structure
+ * @param numOfImgs 	 - the number of images
+ * @param pcaNumComp 	 - the PCA dimension
+ * @param nextImage 	 - the next unread image, shared by the workers
+ * @param features 		 - the slots of the features of the images
+ * @param numOfFeatures	 - the slots of the number of features of the images
+ * @param failed 	 	 - set to true if reading failed, which stops the other workers
+ */
+void readFeaturesFilesWorker(SPConfig config, int numOfImgs, int pcaNumComp, std::atomic<int>* nextImage,
+		SPPoint*** features, int* numOfFeatures, std::atomic<bool>* failed);
+
+/**
+ * Reads the feats files of all the images on up to <numOfThreads> workers, and moves the features
+ * into the feature store in the order of the images, so the store is the same as a serial load's.
+ *
+ * @param store 		 - the empty feature store
+ * @param numOfImgs 	 - the number of images
+ * @param config 		 - the configuration structure
+ * @param pcaNumComp 	 - the PCA dimension
+ * @param numOfThreads 	 - the maximal number of workers to use
+ *
+ * @return
+ * true if the features of all the images were read, false otherwise
+ */
+bool readFeaturesFiles(SPFeatureStore* store, int numOfImgs, SPConfig config, int pcaNumComp, int numOfThreads);
+
+/**
+ * Hashes the settings the features are extracted with - the content of the PCA file among them
+ * (see spExtractionManifestSettingsHash).
+ *
+ * @param config 		 - the configuration structure
+ * @param settingsHash 	 - pointer in which the hash is stored
+ *
+ * @return
+ * true if the settings were hashed, false otherwise (e.g. there's no PCA file)
+ */
+bool extractionSettingsHash(SPConfig config, unsigned long long* settingsHash);
+
+/**
+ * Reads the extraction manifest of the previous extraction, as long as the features were
+ * extracted with the current settings.
+ *
+ * @param config 		 - the configuration structure
+ * @param manifestPath 	 - the path of the manifest file
+ *
+ * @return
+ * NULL if there's no such manifest, or it doesn't match the current settings
+ * Otherwise, the previous manifest
+ */
+SPExtractionManifest* readPreviousManifest(SPConfig config, const char* manifestPath);
+
+/**
+ * Reuses the features of an image which is unchanged since the previous extraction, copied from
+ * the previous database, or read from its feats file if there's no database.
  *
- * @param a - an element to compare (casted to BPQueueElement*)
- * @param b - an element to compare (casted to BPQueueElement*)
+ * @param imgIndex 		 - the index of the image
+ * @param numOfFeatures	 - pointer in which the number of features is stored
+ * @param config 		 - the configuration structure
+ * @param pcaNumComp 	 - the PCA dimension
+ * @param previousStore	 - the features of the previous database, or NULL
  *
  * @return
- * -1 if a.value > b.value, 1 if a.value < b.value
- * if a.value == b.value, returns -1 if a.index < b.index, 1 if a.index > b.index
+ * NULL if the features couldn't be reused
+ * Otherwise, the features of the image
  */
-int cmpfunc(const void *a, const void *b);
+SPPoint** reuseImageFeatures(int imgIndex, int* numOfFeatures, SPConfig config, int pcaNumComp,
+		SPFeatureStore* previousStore);
 
-int extractFeatures(SPPoint*** siftDB, int numOfImgs, int* numOfFeaturesPerImage, int* numOfAllFeatures,
-		SPConfig config, SP_CONFIG_MSG* msg, ImageProc* imageProc) {
-	if (siftDB==NULL || numOfImgs<1 || numOfFeaturesPerImage==NULL || numOfAllFeatures==NULL
-			|| config==NULL || msg==NULL || imageProc==NULL) {
+/**
+ * The extraction shared by the workers of extractImagesFeatures, see extractImagesFeatures.
+ */
+struct ImagesExtraction {
+	SPConfig config;
+	int numOfImgs;
+	ImageProc* imageProc;
+	sp::FeatureWriter* writer;
+	bool isDatabase;
+	SPExtractionManifest* manifest;
+	const SPExtractionManifest* previous;
+	SPFeatureStore* previousStore;
+	std::vector<SPPoint**> features; 	// the features of each image, added to the store in order
+	std::vector<int> numOfFeatures;
+	std::atomic<int> nextImage;
+	std::atomic<int> numOfReused;
+	std::atomic<bool> failed;
+};
+
+/**
+ * Extracts or reuses the features of the next images of the extraction until none is left, and hands
+ * the features of each extracted image to the writer (unless they're kept in the database).
+ * Used as the body of each extractImagesFeatures worker.
+ *
+ * @param extraction - the extraction, its failed flag is set if an image couldn't be extracted
+ */
+void extractImagesFeaturesWorker(ImagesExtraction* extraction);
+
+/**
+ * Extracts the features of the images into the store, and hands the features of each extracted image
+ * to the writer (unless they're kept in the database). If a manifest is given, each image is
+ * recorded in it, and an image which is unchanged since the previous manifest reuses its features.
+ * The images are split between spNumOfExtractThreads workers, which share the SIFT detectors of the
+ * imageProc, and the features are added to the store in the order of the images.
+ * The writer is finished before returning.
+ *
+ * @param store 		 - the empty feature store
+ * @param numOfImgs 	 - the number of images
+ * @param config 		 - the configuration structure
+ * @param imageProc 	 - imageProc object for using openCV
+ * @param writer 		 - the started feats files writer, unused if isDatabase - written to by all the workers
+ * @param isDatabase 	 - whether the features are kept in the database file
+ * @param manifest 		 - the manifest of this extraction, or NULL
+ * @param previous 		 - the manifest of the previous extraction, or NULL
+ * @param previousStore	 - the features of the previous database, or NULL - with isDatabase,
+ * 						   features are only reused from there
+ *
+ * @return
+ * true if the features of all the images were extracted or reused, false otherwise
+ */
+bool extractImagesFeatures(SPFeatureStore* store, int numOfImgs, SPConfig config, ImageProc* imageProc,
+		sp::FeatureWriter& writer, bool isDatabase, SPExtractionManifest* manifest,
+		const SPExtractionManifest* previous, SPFeatureStore* previousStore);
+
+bool addImageFeatures(SPFeatureStore* store, int imgIndex, SPPoint** features, int numOfFeatures) {
+	if (spFeatureStoreAddImage(store, imgIndex, features, numOfFeatures) != SP_FEATURE_STORE_SUCCESS) {
+		spLoggerPrintError(FEATURE_STORE_ERROR, __FILE__, __func__, __LINE__);
+		spPoint1DDestroy(features, numOfFeatures);
+		return false;
+	}
+	return true;
+}
+
+void readFeaturesFilesWorker(SPConfig config, int numOfImgs, int pcaNumComp, std::atomic<int>* nextImage,
+		SPPoint*** features, int* numOfFeatures, std::atomic<bool>* failed) {
+	char path[STR_MAX_LENGTH+1] = {'\0'};
+	for (int i = (*nextImage)++; i<numOfImgs && !(*failed); i = (*nextImage)++) {
+		//get current image path
+		if (spConfigGetFeatsPath(path, config, i) != SP_CONFIG_SUCCESS) {		// if unsuccessful
+			spLoggerPrintError(IMG_PATH_ERROR,__FILE__,__func__,__LINE__);
+			*failed = true;
+			return;
+		}
+		features[i] = readFeaturesFromFile(i, &numOfFeatures[i], path, pcaNumComp);
+		if (features[i] == NULL) {	// if unsuccessful
+			spLoggerPrintError(FUNCTION_ERROR, __FILE__, __func__, __LINE__);
+			*failed = true;
+			return;
+		}
+	}
+}
+
+bool readFeaturesFiles(SPFeatureStore* store, int numOfImgs, SPConfig config, int pcaNumComp, int numOfThreads) {
+	std::vector<SPPoint**> features(numOfImgs, NULL);
+	std::vector<int> numOfFeatures(numOfImgs, 0);
+	std::atomic<int> nextImage(0);
+	std::atomic<bool> failed(false);
+
+	// no point in more workers than images
+	int numOfWorkers = (numOfThreads < numOfImgs) ? numOfThreads : numOfImgs;
+	if (numOfWorkers <= 1) { // reading on the calling thread
+		readFeaturesFilesWorker(config, numOfImgs, pcaNumComp, &nextImage, features.data(), numOfFeatures.data(),
+				&failed);
+	} else {
+		std::vector<std::thread> workers;
+		for (int t=0; t<numOfWorkers; t++) {
+			try {
+				workers.push_back(std::thread(readFeaturesFilesWorker, config, numOfImgs, pcaNumComp, &nextImage,
+						features.data(), numOfFeatures.data(), &failed));
+			} catch (std::exception& ex) { // thread creation failed
+				spLoggerPrintError(FUNCTION_ERROR,__FILE__,__func__,__LINE__);
+				failed = true;
+				break;
+			}
+		}
+		for (size_t t=0; t<workers.size(); t++) {
+			workers[t].join();
+		}
+	}
+
+	// moving the features into the store in order, or destroying what was read on failure
+	bool succeeded = !failed;
+	for (int i=0; i<numOfImgs; i++) {
+		if (features[i] == NULL) {
+			continue;
+		}
+		if (succeeded) {
+			succeeded = addImageFeatures(store, i, features[i], numOfFeatures[i]);
+		} else {
+			spPoint1DDestroy(features[i], numOfFeatures[i]);
+		}
+	}
+	return succeeded;
+}
+
+bool extractionSettingsHash(SPConfig config, unsigned long long* settingsHash) {
+	SP_CONFIG_MSG msg;
+	char pcaPath[STR_MAX_LENGTH+1] = {'\0'};
+	unsigned long long pcaHash = 0; //ORB features have no PCA file, which tells them apart from SIFT features
+	if (spConfigGetFeatureType(config, &msg) != ORB_FEATURES
+			&& (spConfigGetPCAPath(pcaPath, config) != SP_CONFIG_SUCCESS
+			|| spExtractionManifestHashFile(pcaPath, &pcaHash) != SP_EXTRACTION_MANIFEST_SUCCESS)) {
+		return false;
+	}
+	*settingsHash = spExtractionManifestSettingsHash(pcaHash, spConfigGetFeatureDim(config, &msg),
+			spConfigGetNumOfFeatures(config, &msg), spConfigIsBinaryFeatures(config, &msg),
+			spConfigGetMaxImageDimension(config, &msg));
+	return true;
+}
+
+SPExtractionManifest* readPreviousManifest(SPConfig config, const char* manifestPath) {
+	SP_EXTRACTION_MANIFEST_MSG manifestMsg;
+	SPExtractionManifest* previous = spExtractionManifestRead(manifestPath, &manifestMsg);
+	unsigned long long settingsHash;
+	if (previous != NULL && (!extractionSettingsHash(config, &settingsHash)
+			|| spExtractionManifestGetSettingsHash(previous) != settingsHash)) {
+		spExtractionManifestDestroy(previous);
+		previous = NULL;
+	}
+	return previous;
+}
+
+bool isPCATrainingNeeded(SPConfig config) {
+	if (config == NULL) {
 		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
-		return -1;
+		return false;
+	}
+	SP_CONFIG_MSG msg;
+	if (!spConfigIsExtractionMode(config, &msg) || spConfigGetFeatureType(config, &msg) == ORB_FEATURES) {
+		return false;
+	}
+	char manifestPath[STR_MAX_LENGTH+1] = {'\0'};
+	if (spConfigGetExtractionManifestPath(manifestPath, config) != SP_CONFIG_SUCCESS || manifestPath[0] == '\0') {
+		return true;
 	}
+	//the PCA the features of the previous extraction were projected by is kept, so they can be reused
+	SPExtractionManifest* previous = readPreviousManifest(config, manifestPath);
+	spExtractionManifestDestroy(previous);
+	return previous == NULL;
+}
 
+SPPoint** reuseImageFeatures(int imgIndex, int* numOfFeatures, SPConfig config, int pcaNumComp,
+		SPFeatureStore* previousStore) {
+	if (previousStore != NULL) { //copying the features out of the previous database
+		int size = spFeatureStoreGetImageSize(previousStore, imgIndex);
+		SPPoint** previousFeatures = spFeatureStoreGetImageFeatures(previousStore, imgIndex);
+		SPPoint** features = (SPPoint**) malloc(sizeof(SPPoint*) * (size > 0 ? size : 1));
+		if (size < 0 || features == NULL) {
+			free(features);
+			return NULL;
+		}
+		for (int i=0; i<size; i++) {
+			features[i] = spPointCopy(previousFeatures[i]);
+			if (features[i] == NULL) { //Allocation failure
+				spPoint1DDestroy(features, i);
+				return NULL;
+			}
+		}
+		*numOfFeatures = size;
+		return features;
+	}
 	char path[STR_MAX_LENGTH+1] = {'\0'};
-	FILE* featsFile=NULL;
+	if (spConfigGetFeatsPath(path, config, imgIndex) != SP_CONFIG_SUCCESS) {
+		return NULL;
+	}
+	SP_FEATS_FILE_MSG featsMsg;
+	return spFeatsFileRead(path, imgIndex, pcaNumComp, numOfFeatures, &featsMsg);
+}
+
+void extractImagesFeaturesWorker(ImagesExtraction* extraction) {
+	SP_CONFIG_MSG msg;
+	SPConfig config = extraction->config;
+	char path[STR_MAX_LENGTH+1] = {'\0'};
+	SPPoint** imageFeatures = NULL;
+	int numOfFeatures = 0;
+	int pcaNumComp = spConfigGetFeatureDim(config, &msg);
+	bool isBinaryFeatures = spConfigIsBinaryFeatures(config, &msg);
+
+	for (int i = extraction->nextImage++; i<extraction->numOfImgs && !extraction->failed;
+			i = extraction->nextImage++) {
+		//get current image path
+		if(spConfigGetImagePath(path, config ,i) != SP_CONFIG_SUCCESS) {		// if unsuccessful
+			spLoggerPrintError(IMG_PATH_ERROR,__FILE__,__func__,__LINE__);
+			extraction->failed = true;
+			return;
+		}
+		//recording the image, and reusing its features if it's unchanged since the previous extraction
+		if (extraction->manifest != NULL && spExtractionManifestRecord(extraction->manifest, i, path,
+				extraction->previous) != SP_EXTRACTION_MANIFEST_SUCCESS) {
+			spLoggerPrintError(EXTRACTION_MANIFEST_RECORD_ERROR,__FILE__,__func__,__LINE__);
+			extraction->failed = true;
+			return;
+		}
+		imageFeatures = NULL;
+		if ((!extraction->isDatabase || extraction->previousStore != NULL)
+				&& spExtractionManifestIsUnchanged(extraction->manifest, extraction->previous, i)) {
+			imageFeatures = reuseImageFeatures(i, &numOfFeatures, config, pcaNumComp, extraction->previousStore);
+			if (imageFeatures == NULL) {
+				spLoggerPrintWarning(FEATS_REUSE_ERROR,__FILE__,__func__,__LINE__);
+			}
+		}
+		bool isReused = imageFeatures != NULL;
+		if (isReused) {
+			extraction->numOfReused++;
+		} else { //get current image features, from its descriptors if they were kept by the PCA training
+			try {
+				imageFeatures = extraction->imageProc->getTrainingImageFeatures(i,&numOfFeatures);
+				if (imageFeatures == NULL) {
+					imageFeatures = extraction->imageProc->getImageFeatures(path,i,&numOfFeatures);
+				}
+			} catch (...) { //an openCV failure ends the extraction rather than the worker's thread
+				imageFeatures = NULL;
+			}
+			if (imageFeatures == NULL) {	// if unsuccessful
+				spLoggerPrintError(FUNCTION_ERROR, __FILE__, __func__, __LINE__);
+				extraction->failed = true;
+				return;
+			}
+		}
+		extraction->features[i] = imageFeatures;
+		extraction->numOfFeatures[i] = numOfFeatures;
+		//the database is written once all the images are extracted, and reused feats files are kept
+		if (extraction->isDatabase || isReused) {
+			continue;
+		}
+
+		//get current image output file path
+		if (spConfigGetFeatsPath(path, config, i) != SP_CONFIG_SUCCESS) {	// if unsuccessful
+			spLoggerPrintError(IMG_PATH_ERROR,__FILE__,__func__,__LINE__);
+			extraction->failed = true;
+			return;
+		}
+
+		//saving extracted features to feats files (one file per image), in the background
+		//while the next image is extracted
+		if (!extraction->writer->write(path, imageFeatures, numOfFeatures, pcaNumComp, isBinaryFeatures)) {
+			spLoggerPrintError(FEAT_WRITE_ERROR,__FILE__,__func__,__LINE__);
+			extraction->failed = true;
+			return;
+		}
+	}
+}
+
+bool extractImagesFeatures(SPFeatureStore* store, int numOfImgs, SPConfig config, ImageProc* imageProc,
+		sp::FeatureWriter& writer, bool isDatabase, SPExtractionManifest* manifest,
+		const SPExtractionManifest* previous, SPFeatureStore* previousStore) {
+	SP_CONFIG_MSG msg;
+	ImagesExtraction extraction;
+	extraction.config = config;
+	extraction.numOfImgs = numOfImgs;
+	extraction.imageProc = imageProc;
+	extraction.writer = &writer;
+	extraction.isDatabase = isDatabase;
+	extraction.manifest = manifest;
+	extraction.previous = previous;
+	extraction.previousStore = previousStore;
+	extraction.features.assign(numOfImgs, NULL);
+	extraction.numOfFeatures.assign(numOfImgs, 0);
+	extraction.nextImage = 0;
+	extraction.numOfReused = 0;
+	extraction.failed = false;
+
+	// no point in more workers than images
+	int numOfThreads = spConfigGetNumOfExtractThreads(config, &msg);
+	int numOfWorkers = (numOfThreads < numOfImgs) ? numOfThreads : numOfImgs;
+	if (numOfWorkers <= 1) { // extracting on the calling thread
+		extractImagesFeaturesWorker(&extraction);
+	} else {
+		std::vector<std::thread> workers;
+		for (int t=0; t<numOfWorkers; t++) {
+			try {
+				workers.push_back(std::thread(extractImagesFeaturesWorker, &extraction));
+			} catch (std::exception& ex) { // thread creation failed
+				spLoggerPrintError(FUNCTION_ERROR,__FILE__,__func__,__LINE__);
+				extraction.failed = true;
+				break;
+			}
+		}
+		for (size_t t=0; t<workers.size(); t++) {
+			workers[t].join();
+		}
+	}
+
+	// the writer is done with the features before they're moved into the store in order, or destroyed
+	// on failure (a write failure is reported by the caller's finish)
+	writer.finish();
+	bool succeeded = !extraction.failed;
+	for (int i=0; i<numOfImgs; i++) {
+		if (extraction.features[i] == NULL) {
+			continue;
+		}
+		if (succeeded) {
+			succeeded = addImageFeatures(store, i, extraction.features[i], extraction.numOfFeatures[i]);
+		} else {
+			spPoint1DDestroy(extraction.features[i], extraction.numOfFeatures[i]);
+		}
+	}
+	if (succeeded && manifest != NULL) {
+		char info[STR_MAX_LENGTH+1] = {'\0'};
+		snprintf(info, sizeof(info), FEATURES_REUSED, (int) extraction.numOfReused, numOfImgs);
+		spLoggerPrintInfo(info);
+	}
+	return succeeded;
+}
+
+int extractFeatures(SPFeatureStore* store, int numOfImgs, SPConfig config, SP_CONFIG_MSG* msg,
+		ImageProc* imageProc) {
+	if (store==NULL || numOfImgs<1 || config==NULL || msg==NULL || imageProc==NULL) {
+		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
+		return -1;
+	}
+
+	char databasePath[STR_MAX_LENGTH+1] = {'\0'};
+
+	//an empty database path means the features are kept in per-image feats files
+	if (spConfigGetDatabasePath(databasePath, config) != SP_CONFIG_SUCCESS) {
+		spLoggerPrintError(DATABASE_PATH_ERROR,__FILE__,__func__,__LINE__);
+		return -1;
+	}
+	bool isDatabase = databasePath[0] != '\0';
 
 	//extracting of sift features from images or from files
 	bool isExtractMode = spConfigIsExtractionMode(config, msg);
@@ -35,106 +534,93 @@ int extractFeatures(SPPoint*** siftDB, int numOfImgs, int* numOfFeaturesPerImage
 	}
 	if (isExtractMode) { //extracting from images and saving to feats files
 		spLoggerPrintInfo(EXTRACT_FEATURES_FROM_IMAGES);
-		for (int i=0; i<numOfImgs; i++) {
-			//get current image path
-			if(spConfigGetImagePath(path, config ,i) != SP_CONFIG_SUCCESS) {		// if unsuccessful
-				spLoggerPrintError(IMG_PATH_ERROR,__FILE__,__func__,__LINE__);
-				return -1;
-			}
-			//get current image features
-			siftDB[i]=imageProc->getImageFeatures(path,i,numOfFeaturesPerImage+i);
-			if (siftDB[i] == NULL) {	// if unsuccessful
-				spLoggerPrintError(FUNCTION_ERROR, __FILE__, __func__, __LINE__);
-				return -1;
-			}
+		int pcaNumComp = spConfigGetFeatureDim(config, msg);
 
-			//get current image output file path
-			if (spConfigGetFeatsPath(path, config, i) != SP_CONFIG_SUCCESS) {	// if unsuccessful
-				spLoggerPrintError(IMG_PATH_ERROR,__FILE__,__func__,__LINE__);
-				return -1;
-			}
-
-			//create output file
-			featsFile = fopen(path,	"w");
-			if (featsFile == NULL) { 	// if unsuccessful
-				spLoggerPrintError(FEAT_CANNOT_OPEN_FILE,__FILE__,__func__,__LINE__);
-				return -1;
-			}
-			//saving extracted features to feats files (one file per image)
-			//the index and number of features for the current image is written in the first line of the feat file
-			//if unsuccessful print error and return
-			if (fprintf(featsFile, "%d\n", numOfFeaturesPerImage[i]) < 0) {
-				spLoggerPrintError(FEAT_CANNOT_OPEN_FILE,__FILE__,__func__,__LINE__);
-				fclose(featsFile);
+		//an empty manifest path means every image is extracted
+		char manifestPath[STR_MAX_LENGTH+1] = {'\0'};
+		if (spConfigGetExtractionManifestPath(manifestPath, config) != SP_CONFIG_SUCCESS) {
+			spLoggerPrintError(EXTRACTION_MANIFEST_PATH_ERROR,__FILE__,__func__,__LINE__);
+			return -1;
+		}
+		SPExtractionManifest* manifest = NULL;
+		SPExtractionManifest* previous = NULL;
+		SPFeatureStore* previousStore = NULL;
+		if (manifestPath[0] != '\0') {
+			unsigned long long settingsHash = 0;
+			if (!extractionSettingsHash(config, &settingsHash)
+					|| (manifest = spExtractionManifestCreate(numOfImgs, settingsHash)) == NULL) {
+				spLoggerPrintError(EXTRACTION_MANIFEST_ERROR,__FILE__,__func__,__LINE__);
 				return -1;
 			}
-
-			//writing features to output file
-			for (int j=0; j<numOfFeaturesPerImage[i]; j++) {
-				for (int k=0; k<spConfigGetPCADim(config, msg); k++) {
-					if (fprintf(featsFile, "%lf ", spPointGetAxisCoor(siftDB[i][j],k)) < 0) {
-						spLoggerPrintError(FEAT_WRITE_ERROR,__FILE__,__func__,__LINE__);
-						fclose(featsFile);
-						return -1;
-					}
-				}
-				if (fprintf(featsFile, "\n") < 0) {
-					spLoggerPrintError(FEAT_WRITE_ERROR,__FILE__,__func__,__LINE__);
-					fclose(featsFile);
-					return -1;
+			previous = readPreviousManifest(config, manifestPath);
+			spLoggerPrintInfo((previous != NULL) ? EXTRACTION_MANIFEST_LOADED : EXTRACTION_MANIFEST_FULL);
+			//the features of the unchanged images are copied out of the previous database
+			if (previous != NULL && isDatabase) {
+				previousStore = spFeatureStoreCreate(spExtractionManifestGetNumOfImages(previous));
+				if (previousStore != NULL && spFeatsFileReadDatabase(databasePath, previousStore, pcaNumComp)
+						!= SP_FEATS_FILE_SUCCESS) {
+					spLoggerPrintWarning(DATABASE_READ_ERROR,__FILE__,__func__,__LINE__);
+					spFeatureStoreDestroy(previousStore);
+					previousStore = NULL;
 				}
 			}
-			//updating num of all features
-			*numOfAllFeatures += numOfFeaturesPerImage[i];
-			// closing the file
-			fclose(featsFile);
+		}
+
+		sp::FeatureWriter writer(FEATURE_WRITER_QUEUE_SIZE); // finished on return, the store outlives it
+		bool succeeded = (isDatabase || writer.start())
+				&& extractImagesFeatures(store, numOfImgs, config, imageProc, writer, isDatabase, manifest,
+						previous, previousStore);
+		imageProc->releaseTrainingDescriptors(); // the queries are extracted from their images
+		spFeatureStoreDestroy(previousStore);
+		spExtractionManifestDestroy(previous);
+		if (succeeded && !writer.finish()) {
+			spLoggerPrintError(FEAT_WRITE_ERROR,__FILE__,__func__,__LINE__);
+			succeeded = false;
+		}
+		if (succeeded && isDatabase && spFeatsFileWriteDatabase(databasePath, store, pcaNumComp)
+				!= SP_FEATS_FILE_SUCCESS) {
+			spLoggerPrintError(DATABASE_WRITE_ERROR,__FILE__,__func__,__LINE__);
+			succeeded = false;
+		}
+		//the manifest is only saved once the features it describes are, and a manifest which
+		//couldn't be saved only costs the next run a full extraction
+		if (succeeded && manifest != NULL
+				&& spExtractionManifestWrite(manifestPath, manifest) != SP_EXTRACTION_MANIFEST_SUCCESS) {
+			spLoggerPrintWarning(EXTRACTION_MANIFEST_WRITE_ERROR,__FILE__,__func__,__LINE__);
+		}
+		spExtractionManifestDestroy(manifest);
+		if (!succeeded) {
+			return -1;
+		}
+	}
+
+	else if (isDatabase) //reading all the features from the database file
+	{
+		spLoggerPrintInfo(EXTRACT_FEATURES_FROM_DATABASE);
+		if (spFeatsFileReadDatabase(databasePath, store, spConfigGetFeatureDim(config, msg)) != SP_FEATS_FILE_SUCCESS
+				|| !spFeatureStoreIsComplete(store)) {
+			spLoggerPrintError(DATABASE_READ_ERROR,__FILE__,__func__,__LINE__);
+			return -1;
 		}
 	}
 
 	else //extracting from feats files
 	{
 		spLoggerPrintInfo(EXTRACT_FEATURES_FROM_FILE);
-		int pcaNumComp = spConfigGetPCADim(config, msg);
+		int pcaNumComp = spConfigGetFeatureDim(config, msg);
+		int numOfLoadThreads = spConfigGetNumOfLoadThreads(config, msg);
 
-		//getting features from files
-		for (int i=0; i<numOfImgs; i++) {
-			//get current image path
-			if(spConfigGetFeatsPath(path, config ,i) != SP_CONFIG_SUCCESS) {		// if unsuccessful
-				spLoggerPrintError(IMG_PATH_ERROR,__FILE__,__func__,__LINE__);
-				return -1;
-			}
-			//insert image features from file to DB
-			siftDB[i] = readFeaturesFromFile(i, numOfFeaturesPerImage+i, path, pcaNumComp);
-			if (siftDB[i] == NULL) {	// if unsuccessful
-				spLoggerPrintError(FUNCTION_ERROR, __FILE__, __func__, __LINE__);
-				return -1;
-			}
-			//updating num of all features
-			*numOfAllFeatures += numOfFeaturesPerImage[i];
+		//getting features from files, each image into its own slot
+		if (!readFeaturesFiles(store, numOfImgs, config, pcaNumComp, numOfLoadThreads)) {
+			return -1;
 		}
 	}
 
 	return 1;
 }
 
-int createAllFeaturesArray(SPPoint** allFeaturesArr, SPPoint*** siftDB, int numOfImgs, int* numOfFeaturesPerImage) {
-	int k=0;
-	for(int i=0; i<numOfImgs; i++){
-		for(int j=0; j<numOfFeaturesPerImage[i]; j++) {
-			allFeaturesArr[k] = spPointCopy(siftDB[i][j]);
-			if (allFeaturesArr[k] == NULL) { 	//Allocation failure
-				spLoggerPrintError(ALLOCATION_ERROR, __FILE__, __func__, __LINE__);
-				return k;
-			}
-			k++;
-		}
-	}
-	return k;
-}
-
-
-SPKDTreeNode* buildFeaturesKDTree(SPPoint** allFeaturesArr, int numOfAllFeatures, SPConfig config, SP_CONFIG_MSG* msg) {
-	if (allFeaturesArr==NULL || numOfAllFeatures<1 || config==NULL || msg==NULL) {
+SPKDTreeNode* buildFeaturesKDTree(SPFeatureStore* store, SPConfig config, SP_CONFIG_MSG* msg) {
+	if (store==NULL || spFeatureStoreGetSize(store)<1 || config==NULL || msg==NULL) {
 		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
 		return NULL;
 	}
@@ -143,15 +629,69 @@ SPKDTreeNode* buildFeaturesKDTree(SPPoint** allFeaturesArr, int numOfAllFeatures
 
 	int dim = spConfigGetPCADim(config, msg);
 
-	SPKDTreeNode* featuresTree = spKDTreeBuild(allFeaturesArr, numOfAllFeatures, dim, splitMethod);
+	char snapshotPath[STR_MAX_LENGTH+1] = {'\0'};
+	if (spConfigGetKDTreeSnapshotPath(snapshotPath, config) != SP_CONFIG_SUCCESS) {
+		spLoggerPrintError(KD_TREE_SNAPSHOT_PATH_ERROR, __FILE__, __func__, __LINE__);
+		return NULL;
+	}
+	bool isSnapshot = snapshotPath[0] != '\0';
+	SPPoint** features = spFeatureStoreGetFeatures(store);
+	int size = spFeatureStoreGetSize(store);
+
+	//loading the tree from its snapshot, as long as it was built from the same features and config
+	unsigned long long sourceHash = 0;
+	if (isSnapshot) {
+		sourceHash = spKDTreeSnapshotHash(features, size, dim, splitMethod);
+		SP_KD_TREE_SNAPSHOT_MSG snapshotMsg;
+		SPKDTreeNode* loadedTree = spKDTreeSnapshotRead(snapshotPath, features, size, dim, sourceHash, &snapshotMsg);
+		if (loadedTree != NULL) {
+			spLoggerPrintInfo(KD_TREE_SNAPSHOT_LOADED);
+			return loadedTree;
+		}
+		spLoggerPrintInfo(KD_TREE_SNAPSHOT_REBUILD);
+	}
+
+	SPKDTreeNode* featuresTree = spKDTreeBuild(features, size, dim, splitMethod);
 
 	if (featuresTree == NULL) {
 		spLoggerPrintError(FUNCTION_ERROR, __FILE__, __func__, __LINE__);
 		return NULL;
 	}
+
+	//a snapshot which couldn't be saved only costs the next run a build
+	if (isSnapshot && spKDTreeSnapshotWrite(snapshotPath, featuresTree, features, size, dim, sourceHash)
+			!= SP_KD_TREE_SNAPSHOT_SUCCESS) {
+		spLoggerPrintWarning(KD_TREE_SNAPSHOT_WRITE_ERROR, __FILE__, __func__, __LINE__);
+	}
 	return featuresTree;
 }
 
+FeaturesIndex* buildFeaturesIndex(SPFeatureStore* store, SPConfig config, SP_CONFIG_MSG* msg) {
+	if (store==NULL || spFeatureStoreGetSize(store)<1 || config==NULL || msg==NULL) {
+		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
+		return NULL;
+	}
+	FeaturesIndex* featuresIndex = new (std::nothrow) FeaturesIndex();
+	if (featuresIndex == NULL) { // Allocation failure
+		spLoggerPrintError(ALLOCATION_ERROR,__FILE__,__func__,__LINE__);
+		return NULL;
+	}
+	if (spConfigGetFeatureType(config, msg) == ORB_FEATURES) { // searched by Hamming distance
+		featuresIndex->hamming = spHammingIndexBuild(spFeatureStoreGetFeatures(store), spFeatureStoreGetSize(store),
+				spConfigGetFeatureDim(config, msg));
+		if (featuresIndex->hamming == NULL) {
+			spLoggerPrintError(FUNCTION_ERROR, __FILE__, __func__, __LINE__);
+		}
+	} else {
+		featuresIndex->tree = buildFeaturesKDTree(store, config, msg);
+	}
+	if (featuresIndex->tree == NULL && featuresIndex->hamming == NULL) {
+		delete featuresIndex;
+		return NULL;
+	}
+	return featuresIndex;
+}
+
 
 int getQueryPath(char* path) {
 	printf(ENTER_QUERY_PATH);
@@ -161,83 +701,352 @@ int getQueryPath(char* path) {
 	return 1;
 }
 
-int* countKClosestPerFeature(SPKDTreeNode* featuresTree, int numOfImgs, char* queryPath,
-		SPConfig config, SP_CONFIG_MSG* msg, ImageProc* imageProc) {
-	if (featuresTree==NULL || numOfImgs<1 || queryPath==NULL || config==NULL || msg==NULL || imageProc==NULL) {
+QueryCache* createQueryCache(SPConfig config, int numOfImgs, int numOfAllFeatures) {
+	if (config==NULL || numOfImgs<1 || numOfAllFeatures<1) {
 		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
 		return NULL;
 	}
 
+	SP_CONFIG_MSG msg;
+	int cacheSize = spConfigGetQueryCacheSize(config, &msg);
+	if (cacheSize <= 0) { // the cache is disabled
+		return NULL;
+	}
+	// the rankings depend on the search parameters and on the index
+	int rankingParameters[] = { spConfigGetKNN(config, &msg), spConfigGetNumOfSimilarImages(config, &msg),
+			decidedTopNFromConfig(config), spConfigGetFeatureDim(config, &msg), spConfigGetNumOfFeatures(config, &msg),
+			(int) spConfigGetKDTreeSplitMethod(config, &msg), (int) spConfigGetFeatureType(config, &msg), numOfImgs,
+			numOfAllFeatures };
+	unsigned long long rankingContext = QueryCache::hashBytes(rankingParameters, sizeof(rankingParameters),
+			QUERY_CACHE_CONTEXT_SEED);
+	QueryCache* cache = new (std::nothrow) QueryCache((size_t) cacheSize << 20, rankingContext);
+	if (cache == NULL) { // Allocation failure
+		spLoggerPrintError(ALLOCATION_ERROR,__FILE__,__func__,__LINE__);
+		return NULL;
+	}
+	spLoggerPrintInfo(QUERY_CACHE_CREATED);
+	return cache;
+}
+
+BPQueueElement* findClosestImages(FeaturesIndex* featuresIndex, int numOfImgs, const char* queryPath,
+		SPConfig config, SP_CONFIG_MSG* msg, ImageProc* imageProc, QueryCache* cache, int numOfThreads,
+		bool* degraded) {
+	if (featuresIndex==NULL || numOfImgs<1 || queryPath==NULL || config==NULL || msg==NULL || imageProc==NULL
+			|| numOfThreads<1 || degraded==NULL) {
+		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
+		return NULL;
+	}
+	// the latency budget covers the whole query, decoding and extraction included
+	long long deadline = queryDeadlineFromConfig(config);
+	*degraded = false;
+
 	int spKNN = spConfigGetKNN(config, msg);
 	if (spKNN == -1) {
 		spLoggerPrintError(FUNCTION_ERROR,__FILE__,__func__,__LINE__);
 		return NULL;
 	}
-	int* counter = (int*) calloc(numOfImgs, sizeof(int));
-	SPBPQueue* bpq = spBPQueueCreate(spKNN);
-	BPQueueElement* element = (BPQueueElement*) malloc(sizeof(BPQueueElement));
-	if (counter==NULL || bpq==NULL || element==NULL) { 		// Allocation failure
-		free(counter);
-		spBPQueueDestroy(bpq);
-		free(element);
-		spLoggerPrintError(ALLOCATION_ERROR,__FILE__,__func__,__LINE__);
+	int numOfSimilarImages = spConfigGetNumOfSimilarImages(config, msg);
+	if (numOfSimilarImages == -1) {
+		spLoggerPrintError(FUNCTION_ERROR,__FILE__,__func__,__LINE__);
 		return NULL;
 	}
-	int nFeaturesQuery = 0;
-	spLoggerPrintInfo(EXTRACT_FEATURES_FROM_QUERY);
-	SPPoint** querySift = imageProc->getImageFeatures(queryPath, 0, &nFeaturesQuery);
-	if (querySift==NULL) {		//ImageProc error
-		free(counter);
-		spPoint1DDestroy(querySift, nFeaturesQuery);
-		spBPQueueDestroy(bpq);
-		free(element);
+	int decidedTopN = decidedTopNFromConfig(config);
+	if (decidedTopN == -1) {
+		spLoggerPrintError(FUNCTION_ERROR,__FILE__,__func__,__LINE__);
+		return NULL;
+	}
+	int pcaDim = spConfigGetFeatureDim(config, msg);
+	if (pcaDim == -1) {
+		spLoggerPrintError(FUNCTION_ERROR,__FILE__,__func__,__LINE__);
 		return NULL;
 	}
 
+	// a repeated query is answered from the cache
+	QueryContentKey contentKey = QueryContentKey();
+	bool cached = (cache != NULL) && QueryCache::hashFile(queryPath, &contentKey);
+	BPQueueElement* queryClosestImages = cached ? cache->getRanking(contentKey, numOfSimilarImages) : NULL;
+	if (queryClosestImages != NULL) {
+		return queryClosestImages;
+	}
+
+	int nFeaturesQuery = 0;
+	SPPoint** querySift = cached ? cache->getFeatures(contentKey, &nFeaturesQuery) : NULL;
+	if (querySift == NULL) {
+		querySift = getQueryFeatures(queryPath, &nFeaturesQuery, pcaDim, imageProc);
+		if (querySift==NULL) {		//ImageProc or feats file error
+			return NULL;
+		}
+		if (cached && !isFeaturesFile(queryPath)) {
+			cache->putFeatures(contentKey, querySift, nFeaturesQuery);
+		}
+	}
+
 	// searching for KNN points for each query feature
 	spLoggerPrintInfo(SEARCH_CLOSEST_IMAGES);
-	for(int i=0; i<nFeaturesQuery; i++) {
-		// getting the KNN into the bpq
-		if (spKDTreeNodeGetKNN(featuresTree, bpq, querySift[i]) == -1) { // search failed
-			free(counter);
-			spPoint1DDestroy(querySift, nFeaturesQuery);
-			spBPQueueDestroy(bpq);
-			free(element);
-			spLoggerPrintError(KNN_ERROR,__FILE__,__func__,__LINE__);
-			return NULL;
+	SPVoteTable* votes = countKClosestForFeatures(featuresIndex, numOfImgs, querySift, nFeaturesQuery, spKNN,
+			numOfThreads, decidedTopN, deadline, degraded);
+	// free allocations
+	spPoint1DDestroy(querySift, nFeaturesQuery);
+	if (votes == NULL) { // search failed
+		spLoggerPrintError(KNN_ERROR,__FILE__,__func__,__LINE__);
+		return NULL;
+	}
+
+	// sorting the images indexes by the number of feature hits
+	queryClosestImages = sortFeaturesCount(votes, numOfImgs, numOfSimilarImages);
+	spVoteTableDestroy(votes);
+	if (queryClosestImages != NULL && cached && !*degraded) {
+		cache->putRanking(contentKey, queryClosestImages, numOfSimilarImages);
+	}
+	return queryClosestImages;
+}
+
+long long queryClockNow() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+long long queryDeadlineFromConfig(SPConfig config) {
+	SP_CONFIG_MSG msg;
+	int budget = spConfigGetQueryDeadline(config, &msg);
+	if (msg != SP_CONFIG_SUCCESS || budget <= 0) { // no deadline
+		return 0;
+	}
+	return queryClockNow() + (long long) budget * 1000;
+}
+
+SPVoteTable* countKClosestForFeatures(FeaturesIndex* featuresIndex, int numOfImgs, SPPoint** querySift,
+		int nFeaturesQuery, int spKNN, int numOfThreads, int decidedTopN, long long deadline, bool* degraded) {
+	if (featuresIndex==NULL || numOfImgs<1 || querySift==NULL || nFeaturesQuery<0 || spKNN<1 || numOfThreads<1
+			|| decidedTopN<0 || deadline<0) {
+		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
+		return NULL;
+	}
+	if (degraded != NULL) {
+		*degraded = false;
+	}
+
+	// when every image is ranked, nothing trails the best images, and the whole query is a single block
+	bool isEarlyTermination = (decidedTopN > 0 && decidedTopN < numOfImgs);
+	QuerySearch search;
+	search.featuresIndex = featuresIndex;
+	search.querySift = querySift;
+	search.nFeaturesQuery = nFeaturesQuery;
+	search.spKNN = spKNN;
+	search.numOfImgs = numOfImgs;
+	search.decidedTopN = isEarlyTermination ? decidedTopN : 0;
+	search.deadline = deadline;
+	// no point in more workers than features
+	search.numOfWorkers = (numOfThreads < nFeaturesQuery) ? numOfThreads : nFeaturesQuery;
+	search.numOfWorkers = (search.numOfWorkers > 1) ? search.numOfWorkers : 1;
+	search.blockSize = isEarlyTermination ? SEARCH_BLOCK_SIZE * numOfThreads : nFeaturesQuery;
+	search.blockEnd = (nFeaturesQuery < search.blockSize) ? nFeaturesQuery : search.blockSize;
+	search.leaders = NULL;
+	search.nextFeature = 0;
+	search.searchedFeatures = 0;
+	search.maxChecks = 0;
+	search.stopped = false;
+	search.failed = false;
+	search.degraded = false;
+	search.participants = search.numOfWorkers;
+	search.arrived = 0;
+	search.checkpoints = 0;
+	search.finished = false;
+
+	// at most spKNN images are voted for by each feature, and never more than the whole database
+	long long maxVotedImages = (long long) nFeaturesQuery * spKNN;
+	int capacity = (int) ((maxVotedImages < numOfImgs) ? maxVotedImages : numOfImgs);
+	search.votes = spVoteTableCreate(capacity > 0 ? capacity : 1);
+	bool allocated = (search.votes != NULL);
+	// each worker counts into a table of its own for the whole query, worker 0 directly into the votes
+	search.workerVotes.assign(search.numOfWorkers, NULL);
+	search.workerVotes[0] = search.votes;
+	for (int t=1; t<search.numOfWorkers; t++) {
+		search.workerVotes[t] = spVoteTableCreate(capacity > 0 ? capacity : 1);
+		allocated = allocated && (search.workerVotes[t] != NULL);
+	}
+	if (isEarlyTermination) {
+		search.leaders = (BPQueueElement*) malloc((decidedTopN+1)*sizeof(BPQueueElement));
+		allocated = allocated && (search.leaders != NULL);
+	}
+	if (!allocated) { // Allocation failure
+		spLoggerPrintError(ALLOCATION_ERROR,__FILE__,__func__,__LINE__);
+		for (int t=0; t<search.numOfWorkers; t++) {
+			spVoteTableDestroy(search.workerVotes[t]);
+		}
+		free(search.leaders);
+		return NULL;
+	}
+
+	// the workers are started once for the whole query, the calling thread being worker 0
+	search.searchStart = queryClockNow();
+	std::vector<std::thread> workers;
+	for (int t=1; t<search.numOfWorkers; t++) {
+		try {
+			workers.push_back(std::thread(countKClosestWorker, &search, t));
+		} catch (std::exception& ex) { // thread creation failed, the started workers finish the block and stop
+			spLoggerPrintError(FUNCTION_ERROR,__FILE__,__func__,__LINE__);
+			std::lock_guard<std::mutex> lock(search.checkpointMutex);
+			search.participants = t;
+			search.failed = true;
+			search.stopped = true;
+			break;
+		}
+	}
+	countKClosestWorker(&search, 0);
+	for (size_t t=0; t<workers.size(); t++) {
+		workers[t].join();
+	}
+
+	for (int t=1; t<search.numOfWorkers; t++) {
+		spVoteTableDestroy(search.workerVotes[t]);
+	}
+	free(search.leaders);
+	if (search.failed) {
+		spVoteTableDestroy(search.votes);
+		return NULL;
+	}
+	if (degraded != NULL) {
+		*degraded = search.degraded;
+	}
+	return search.votes;
+}
+
+void countKClosestWorker(QuerySearch* search, int worker) {
+	SPVoteTable* votes = search->workerVotes[worker];
+	SPBPQueue* bpq = spBPQueueCreate(search->spKNN);
+	if (bpq == NULL) { // Allocation failure
+		spLoggerPrintError(ALLOCATION_ERROR,__FILE__,__func__,__LINE__);
+		search->failed = true;
+		search->stopped = true;
+	}
+	BPQueueElement element;
+	while (true) {
+		int i = search->nextFeature++;
+		if (i >= search->blockEnd || search->stopped) { // the block is done, waiting for the other workers
+			if (querySearchCheckpoint(search)) {
+				continue;
+			}
+			break;
+		}
+		if (search->deadline > 0) {
+			long long now = queryClockNow();
+			// the first feature of each worker is always searched
+			if (i >= search->numOfWorkers && now >= search->deadline) { // out of time, the rest are dropped
+				search->degraded = true;
+				search->stopped = true;
+				continue;
+			}
+			// projecting the time of the remaining features from the features searched so far
+			int searched = search->searchedFeatures;
+			long long projected = (searched > 0) ? (now-search->searchStart) * (search->nFeaturesQuery-i) / searched : 0;
+			if (search->maxChecks == 0 && (now >= search->deadline || now + projected > search->deadline)) {
+				search->maxChecks = DEADLINE_APPROXIMATE_CHECKS;
+				search->degraded = true;
+			}
+		}
+
+		// getting the KNN into the bpq, approximately if the query is late for its deadline
+		int maxChecks = search->maxChecks;
+		int found;
+		if (search->featuresIndex->hamming != NULL) {
+			found = (maxChecks > 0) ? spHammingIndexGetKNNBounded(search->featuresIndex->hamming, bpq,
+					search->querySift[i], maxChecks)
+					: spHammingIndexGetKNN(search->featuresIndex->hamming, bpq, search->querySift[i]);
+		} else {
+			found = (maxChecks > 0) ? spKDTreeNodeGetKNNBounded(search->featuresIndex->tree, bpq,
+					search->querySift[i], maxChecks)
+					: spKDTreeNodeGetKNN(search->featuresIndex->tree, bpq, search->querySift[i]);
+		}
+		if (found == -1) { // search failed
+			search->failed = true;
+			search->stopped = true;
+			continue;
 		}
 		// counting which images the KNN points belong to
-		for(int j=0; j<spKNN; j++) {
-			spBPQueuePeek(bpq, element);
+		for(int j=0; j<search->spKNN; j++) {
+			spBPQueuePeek(bpq, &element);
 			spBPQueueDequeue(bpq);
-			counter[element->index]++;
+			if (spVoteTableAdd(votes, element.index, 1) != SP_VOTE_TABLE_SUCCESS) {
+				spLoggerPrintError(ALLOCATION_ERROR,__FILE__,__func__,__LINE__);
+				search->failed = true;
+				search->stopped = true;
+				break;
+			}
 		}
+		search->searchedFeatures++;
 	}
-	// free allocations
-	spPoint1DDestroy(querySift, nFeaturesQuery);
 	spBPQueueDestroy(bpq);
-	free(element);
+}
+
+bool querySearchCheckpoint(QuerySearch* search) {
+	std::unique_lock<std::mutex> lock(search->checkpointMutex);
+	int checkpoint = search->checkpoints;
+	if (++search->arrived < search->participants) {
+		search->checkpointPassed.wait(lock, [search, checkpoint] { return search->checkpoints != checkpoint; });
+	} else { // the last to arrive
+		querySearchNextBlock(search);
+	}
+	return !search->finished;
+}
+
+void querySearchNextBlock(QuerySearch* search) {
+	for (int t=1; t<search->numOfWorkers; t++) {
+		if (!search->failed && spVoteTableMerge(search->votes, search->workerVotes[t]) != SP_VOTE_TABLE_SUCCESS) {
+			spLoggerPrintError(ALLOCATION_ERROR,__FILE__,__func__,__LINE__);
+			search->failed = true;
+		}
+		spVoteTableClear(search->workerVotes[t]);
+	}
+	int end = search->blockEnd;
+	search->finished = search->failed || search->stopped || end >= search->nFeaturesQuery;
 
-	return counter;
+	// each remaining feature gives at most spKNN votes, so the trailing image can gain at most
+	// that many per feature. Once it can't catch up with the last of the best images, stop.
+	int topN = search->decidedTopN;
+	long long maxGain = (long long) (search->nFeaturesQuery-end) * search->spKNN;
+	if (!search->finished && topN > 0 && maxGain < (long long) end * search->spKNN
+			&& spVoteTableTopN(search->votes, topN+1, search->numOfImgs, search->leaders) == topN+1
+			&& search->leaders[topN-1].value - search->leaders[topN].value > maxGain) {
+		search->finished = true;
+	}
+	if (!search->finished) {
+		search->nextFeature = end;
+		search->blockEnd = (search->nFeaturesQuery-end < search->blockSize) ? search->nFeaturesQuery
+				: end+search->blockSize;
+	}
+	search->arrived = 0;
+	search->checkpoints++;
+	search->checkpointPassed.notify_all();
 }
 
-BPQueueElement* sortFeaturesCount(int* counter, int numOfImgs) {
-	if (counter==NULL || numOfImgs<1) {
+int decidedTopNFromConfig(SPConfig config) {
+	SP_CONFIG_MSG msg;
+	bool isEarlyTermination = spConfigIsEarlyTermination(config, &msg);
+	if (msg != SP_CONFIG_SUCCESS) {
+		return -1;
+	}
+	return isEarlyTermination ? spConfigGetNumOfSimilarImages(config, &msg) : 0;
+}
+
+BPQueueElement* sortFeaturesCount(SPVoteTable* votes, int numOfImgs, int numOfSimilarImages) {
+	if (votes==NULL || numOfImgs<1 || numOfSimilarImages<1 || numOfSimilarImages>numOfImgs) {
 		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
 		return NULL;
 	}
 
-	BPQueueElement* queryClosestImages = (BPQueueElement*) malloc (numOfImgs*sizeof(BPQueueElement));
+	BPQueueElement* queryClosestImages = (BPQueueElement*) malloc (numOfSimilarImages*sizeof(BPQueueElement));
 	if (queryClosestImages == NULL) { //Allocation failure
 		spLoggerPrintError(ALLOCATION_ERROR,__FILE__,__func__,__LINE__);
 		return NULL;
 	}
 
-	for (int i=0; i<numOfImgs; i++) {
-		BPQueueElement node = {i ,(double) counter[i]};
-		queryClosestImages[i]=node;
+	// only the voted images are ranked, and only the best numOfSimilarImages are sorted
+	if (spVoteTableTopN(votes, numOfSimilarImages, numOfImgs, queryClosestImages) != numOfSimilarImages) {
+		spLoggerPrintError(FUNCTION_ERROR,__FILE__,__func__,__LINE__);
+		free(queryClosestImages);
+		return NULL;
 	}
-	qsort(queryClosestImages, numOfImgs, sizeof(BPQueueElement), cmpfunc);
 
 	return queryClosestImages;
 }
@@ -249,78 +1058,56 @@ SPPoint** readFeaturesFromFile(int imgIndex, int* numFeatures, char* path, int p
 		spLoggerPrintError(FEATS_ERROR,__FILE__,__func__,__LINE__);
 		return NULL;
 	}
-	//read values from file
-	FILE* featuresFile;
-	featuresFile = fopen(path,"r");
-	//checks if open failed
-	if (featuresFile == NULL) {
+	//read features, in either format
+	SP_FEATS_FILE_MSG msg;
+	SPPoint** featuresArray = spFeatsFileRead(path, imgIndex, pcaNumComp, numFeatures, &msg);
+	switch (msg) {
+	case SP_FEATS_FILE_SUCCESS:
+		break;
+	case SP_FEATS_FILE_CANNOT_OPEN:
 		spLoggerPrintError(FEAT_READ_ERROR,__FILE__,__func__,__LINE__);
-		fclose(featuresFile);
-		return NULL;
-	}
-
-	//detect the number of feature of image imgIndex
-	if (fscanf(featuresFile, " %d\n", numFeatures) <= 0) {
+		break;
+	case SP_FEATS_FILE_INVALID_COUNT:
 		spLoggerPrintError(NUM_FEATS_READING_ERROR,__FILE__,__func__,__LINE__);
-		fclose(featuresFile);
-		return NULL;
-	}
-
-	//read features
-	SPPoint** featuresArray = (SPPoint**) malloc((*numFeatures)*sizeof(SPPoint*));
-	double* tempArray = (double*) malloc(pcaNumComp*sizeof(double));
-	if (tempArray==NULL || featuresArray==NULL) {
+		break;
+	case SP_FEATS_FILE_OUT_OF_MEMORY:
 		spLoggerPrintError(ALLOCATION_ERROR,__FILE__,__func__,__LINE__);
-		free(tempArray);
-		free(featuresArray);
-		fclose(featuresFile);
-		return NULL;
-	}
-
-	for (int i=0; i<(*numFeatures); i++) {
-		// reading double values to tempArray
-		for (int j=0; j<pcaNumComp; j++) {
-			if(fscanf(featuresFile, " %lf", tempArray+j) <= 0) {
-				spLoggerPrintError(FEATS_READING_ERROR,__FILE__,__func__,__LINE__);
-				free(featuresArray);
-				free(tempArray);
-				fclose(featuresFile);
-				return NULL;
-			}
-		} // end reading double values to tempArray
-
-		// creating the i'th point from tempArray
-		featuresArray[i] = spPointCreate(tempArray, pcaNumComp, imgIndex);
-		if(featuresArray[i] == NULL) { // create point fail
-			spLoggerPrintError(FUNCTION_ERROR,__FILE__,__func__,__LINE__);
-			free(featuresArray);
-			free(tempArray);
-			fclose(featuresFile);
-			return NULL;
-		}
+		break;
+	default: // invalid format, or corrupted
+		spLoggerPrintError(FEATS_READING_ERROR,__FILE__,__func__,__LINE__);
+		break;
 	}
-
-	// free all allocations
-	free(tempArray);
-	fclose(featuresFile);
-
 	return featuresArray;
 }
 
+bool isFeaturesFile(const char* queryPath) {
+	if (queryPath == NULL) {
+		return false;
+	}
+	size_t pathLength = strlen(queryPath);
+	size_t suffixLength = strlen(FEATS_SUFFIX);
+	return pathLength > suffixLength && strcmp(queryPath + pathLength - suffixLength, FEATS_SUFFIX) == 0;
+}
 
-int cmpfunc(const void *a, const void *b) {
-	BPQueueElement* e1 = (BPQueueElement*)a; // casting pointer types
-	BPQueueElement* e2 = (BPQueueElement*)b; // casting pointer types
+SPPoint** getQueryFeatures(const char* queryPath, int* numOfFeatures, int pcaDim, ImageProc* imageProc) {
+	if (queryPath==NULL || numOfFeatures==NULL || pcaDim<1 || imageProc==NULL) {
+		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
+		return NULL;
+	}
 
-	  if (e1->value > e2->value)
-		  return -1;
-	  else if (e1->value < e2->value)
-		  return 1;
-	  else {
-		 if (e1->index > e2->index)
-			 return 1;
-		 return -1;
-	  }
+	if (!isFeaturesFile(queryPath)) {
+		spLoggerPrintInfo(EXTRACT_FEATURES_FROM_QUERY);
+		return imageProc->getImageFeatures(queryPath, 0, numOfFeatures);
+	}
+	// the features were already extracted and projected, going straight to the search
+	char path[STR_MAX_LENGTH+1] = {'\0'};
+	if (strlen(queryPath) > STR_MAX_LENGTH) {
+		spLoggerPrintError(QUERY_PATH_ERROR,__FILE__,__func__,__LINE__);
+		return NULL;
+	}
+	strcpy(path, queryPath);
+	spLoggerPrintInfo(READ_FEATURES_FROM_QUERY);
+	return readFeaturesFromFile(0, numOfFeatures, path, pcaDim);
 }
 
 bool showResults(char* queryPath, BPQueueElement* queryClosestImages, SPConfig config, SP_CONFIG_MSG* msg,
@@ -355,31 +1142,225 @@ bool showResults(char* queryPath, BPQueueElement* queryClosestImages, SPConfig c
 	return true;
 }
 
-void terminate(SPConfig config, SPPoint*** siftDB, int numOfImgs, int* numOfFeaturesPerImage,
-		SPPoint** allFeaturesArr, int numOfAllFeatures, SPKDTreeNode* featuresTree) {
-	printf(EXITING);
-	bool onlyConfig = true;
-	if (siftDB != NULL) {
-		for (int i=0; i< numOfImgs; i++) {
-			spPoint1DDestroy(siftDB[i], numOfFeaturesPerImage[i]);
+int runBatchQueries(FeaturesIndex* featuresIndex, int numOfImgs, const char* queryListPath, const char* resultsPath,
+		SPConfig config, ImageProc* imageProc, QueryCache* cache) {
+	if (featuresIndex==NULL || numOfImgs<1 || queryListPath==NULL || resultsPath==NULL || config==NULL
+			|| imageProc==NULL) {
+		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
+		return -1;
+	}
+
+	SP_CONFIG_MSG msg;
+	int spKNN = spConfigGetKNN(config, &msg);
+	int numOfSimilarImages = spConfigGetNumOfSimilarImages(config, &msg);
+	int numOfDecodeThreads = spConfigGetNumOfDecodeThreads(config, &msg);
+	int numOfExtractThreads = spConfigGetNumOfExtractThreads(config, &msg);
+	int numOfSearchThreads = spConfigGetNumOfSearchThreads(config, &msg);
+	int pipelineQueueSize = spConfigGetPipelineQueueSize(config, &msg);
+	int decidedTopN = decidedTopNFromConfig(config);
+	int pcaDim = spConfigGetFeatureDim(config, &msg);
+	if (spKNN==-1 || numOfSimilarImages==-1 || numOfDecodeThreads==-1 || numOfExtractThreads==-1
+			|| numOfSearchThreads==-1 || pipelineQueueSize==-1 || decidedTopN==-1 || pcaDim==-1) {
+		spLoggerPrintError(FUNCTION_ERROR,__FILE__,__func__,__LINE__);
+		return -1;
+	}
+
+	// reading the query paths, one per line (so a path may contain spaces), skipping empty lines
+	FILE* queryListFile = fopen(queryListPath, "r");
+	if (queryListFile == NULL) {
+		spLoggerPrintError(QUERY_LIST_CANNOT_OPEN_FILE,__FILE__,__func__,__LINE__);
+		return -1;
+	}
+	std::vector<std::string> queries;
+	std::vector<bool> tooLong;
+	char queryPath[STR_MAX_LENGTH+2] = {'\0'}; // a path, its newline and the terminator
+	while (fgets(queryPath, sizeof(queryPath), queryListFile) != NULL) {
+		size_t length = strlen(queryPath);
+		bool complete = (length > 0 && queryPath[length-1] == '\n') || feof(queryListFile);
+		if (!complete) { // the line is longer than any path, its query fails rather than being split
+			spLoggerPrintError(QUERY_PATH_TOO_LONG,__FILE__,__func__,__LINE__);
+			int c;
+			while ((c = fgetc(queryListFile)) != EOF && c != '\n') {
+			}
+		}
+		while (length > 0 && (queryPath[length-1] == '\n' || queryPath[length-1] == '\r')) {
+			queryPath[--length] = '\0';
+		}
+		if (length > 0) {
+			queries.push_back(queryPath);
+			tooLong.push_back(!complete);
 		}
-		free(siftDB);
-		spLoggerPrintInfo(SIFT_DB_DESTROY);
-		onlyConfig = false;
 	}
-	if (allFeaturesArr != NULL) {
-		spPoint1DDestroy(allFeaturesArr, numOfAllFeatures);
-		spLoggerPrintInfo(ALL_FEATURES_ARRAY_DESTROY);
-		onlyConfig = false;
+	fclose(queryListFile);
+
+	FILE* resultsFile = fopen(resultsPath, "w");
+	if (resultsFile == NULL) {
+		spLoggerPrintError(RESULTS_CANNOT_OPEN_FILE,__FILE__,__func__,__LINE__);
+		return -1;
+	}
+
+	// answering the queries: decode -> SIFT and PCA -> KNN and voting, several queries in flight at once
+	spLoggerPrintInfo(BATCH_QUERIES_STARTED);
+	std::vector<QueryJob> jobs(queries.size());
+	for (size_t q=0; q<queries.size(); q++) {
+		jobs[q].queryPath = queries[q].c_str();
+		jobs[q].features = NULL;
+		jobs[q].numOfFeatures = 0;
+		jobs[q].result = NULL;
+		jobs[q].failed = tooLong[q]; // skipped by the stages, and reported as failed
+		jobs[q].contentKey = QueryContentKey();
+		jobs[q].cached = false;
+		jobs[q].deadline = 0;
+		jobs[q].degraded = false;
+	}
+	QueryPipeline pipeline(pipelineQueueSize);
+	pipeline.addStage([imageProc, pcaDim, cache, numOfSimilarImages, config](QueryJob& job) {
+		// the latency budget of the query starts once its first stage picks it
+		job.deadline = queryDeadlineFromConfig(config);
+		// a repeated query skips the following stages, or at least the extraction stage
+		job.cached = (cache != NULL) && QueryCache::hashFile(job.queryPath, &job.contentKey);
+		if (job.cached) {
+			job.result = cache->getRanking(job.contentKey, numOfSimilarImages);
+			if (job.result == NULL) {
+				job.features = cache->getFeatures(job.contentKey, &job.numOfFeatures);
+			}
+			if (job.result != NULL || job.features != NULL) {
+				return;
+			}
+		}
+		if (isFeaturesFile(job.queryPath)) { // nothing to decode, the features are read as is
+			job.features = getQueryFeatures(job.queryPath, &job.numOfFeatures, pcaDim, imageProc);
+			job.failed = (job.features == NULL);
+			return;
+		}
+		job.image = imageProc->loadImage(job.queryPath);
+		job.failed = job.image.empty();
+	}, numOfDecodeThreads);
+	pipeline.addStage([imageProc, cache](QueryJob& job) {
+		if (job.result != NULL || job.features != NULL) { // cached, or read from a feats file by the decoding stage
+			return;
+		}
+		job.features = imageProc->getImageFeatures(job.image, 0, &job.numOfFeatures);
+		job.image.release();
+		job.failed = (job.features == NULL);
+		if (!job.failed && job.cached) {
+			cache->putFeatures(job.contentKey, job.features, job.numOfFeatures);
+		}
+	}, numOfExtractThreads);
+	pipeline.addStage([featuresIndex, numOfImgs, spKNN, numOfSimilarImages, decidedTopN, cache](QueryJob& job) {
+		if (job.result != NULL) { // answered from the cache
+			return;
+		}
+		// the stages already run in parallel, so each query is searched by a single thread
+		SPVoteTable* votes = countKClosestForFeatures(featuresIndex, numOfImgs, job.features, job.numOfFeatures,
+				spKNN, 1, decidedTopN, job.deadline, &job.degraded);
+		spPoint1DDestroy(job.features, job.numOfFeatures);
+		job.features = NULL;
+		if (votes != NULL) {
+			job.result = sortFeaturesCount(votes, numOfImgs, numOfSimilarImages);
+			spVoteTableDestroy(votes);
+		}
+		job.failed = (job.result == NULL);
+		if (!job.failed && job.cached && !job.degraded) {
+			cache->putRanking(job.contentKey, job.result, numOfSimilarImages);
+		}
+	}, numOfSearchThreads);
+	if (!pipeline.run(jobs)) {
+		spLoggerPrintError(FUNCTION_ERROR,__FILE__,__func__,__LINE__);
+	}
+
+	// writing the results in the order of the query list
+	char imagePath[STR_MAX_LENGTH+1] = {'\0'};
+	bool written = true;
+	for (size_t q=0; q<jobs.size(); q++) {
+		if (jobs[q].features != NULL) { // the query failed after its features were extracted
+			spPoint1DDestroy(jobs[q].features, jobs[q].numOfFeatures);
+		}
+		if (jobs[q].failed || jobs[q].result == NULL) { // the query failed
+			written = written && (fprintf(resultsFile, QUERY_FAILED, jobs[q].queryPath) >= 0);
+			free(jobs[q].result);
+			continue;
+		}
+		written = written && (fprintf(resultsFile, BEST_CANDIDATES, jobs[q].queryPath) >= 0);
+		if (jobs[q].degraded) {
+			written = written && (fprintf(resultsFile, DEGRADED_RESULTS) >= 0);
+		}
+		for (int i=0; i<numOfSimilarImages; i++) {
+			if (spConfigGetImagePath(imagePath, config, jobs[q].result[i].index) != SP_CONFIG_SUCCESS) {
+				spLoggerPrintError(IMG_PATH_ERROR,__FILE__,__func__,__LINE__);
+				written = false;
+				break;
+			}
+			written = written && (fprintf(resultsFile, "%s\n", imagePath) >= 0);
+		}
+		free(jobs[q].result);
+	}
+	if (fclose(resultsFile) != 0 || !written) {
+		spLoggerPrintError(RESULTS_WRITE_ERROR,__FILE__,__func__,__LINE__);
+		return -1;
+	}
+	spLoggerPrintInfo(BATCH_QUERIES_DONE);
+	return 1;
+}
+
+int runQueryServer(FeaturesIndex* featuresIndex, int numOfImgs, const char* socketPath, SPConfig config,
+		ImageProc* imageProc, QueryCache* cache) {
+	if (featuresIndex==NULL || numOfImgs<1 || socketPath==NULL || config==NULL || imageProc==NULL) {
+		spLoggerPrintError(INVALID_ARGUMENTS_ERROR, __FILE__, __func__, __LINE__);
+		return -1;
+	}
+
+	SP_CONFIG_MSG msg;
+	int spKNN = spConfigGetKNN(config, &msg);
+	int numOfSimilarImages = spConfigGetNumOfSimilarImages(config, &msg);
+	int numOfServerThreads = spConfigGetNumOfServerThreads(config, &msg);
+	int pcaDim = spConfigGetFeatureDim(config, &msg);
+	int decidedTopN = decidedTopNFromConfig(config);
+	if (spKNN==-1 || numOfSimilarImages==-1 || numOfServerThreads==-1 || pcaDim==-1 || decidedTopN==-1) {
+		spLoggerPrintError(FUNCTION_ERROR,__FILE__,__func__,__LINE__);
+		return -1;
 	}
-	if (numOfFeaturesPerImage != NULL) {
-		free(numOfFeaturesPerImage);
+
+	QueryServer server(socketPath, numOfServerThreads, pcaDim, numOfSimilarImages,
+			[featuresIndex, numOfImgs, config, imageProc, cache](const char* path, bool* degraded) {
+				// the clients are already served in parallel, so each query is searched by a single thread
+				SP_CONFIG_MSG queryMsg;
+				return findClosestImages(featuresIndex, numOfImgs, path, config, &queryMsg, imageProc, cache, 1,
+						degraded);
+			},
+			[featuresIndex, numOfImgs, spKNN, numOfSimilarImages, decidedTopN, config](SPPoint** features,
+					int numOfFeatures, bool* degraded) {
+				// the clients are already served in parallel, so each query is searched by a single thread
+				SPVoteTable* votes = countKClosestForFeatures(featuresIndex, numOfImgs, features, numOfFeatures,
+						spKNN, 1, decidedTopN, queryDeadlineFromConfig(config), degraded);
+				if (votes == NULL) {
+					return (BPQueueElement*) NULL;
+				}
+				BPQueueElement* queryClosestImages = sortFeaturesCount(votes, numOfImgs, numOfSimilarImages);
+				spVoteTableDestroy(votes);
+				return queryClosestImages;
+			});
+	if (!server.run()) {
+		return -1;
 	}
-	if (featuresTree != NULL) {
-			spKDTreeNodeDestroy(featuresTree);
+	return 1;
+}
+
+void terminate(SPConfig config, SPFeatureStore* store, FeaturesIndex* featuresIndex) {
+	printf(EXITING);
+	bool onlyConfig = true;
+	if (featuresIndex != NULL) { // referencing the features of the store, destroyed first
+			spKDTreeNodeDestroy(featuresIndex->tree);
+			spHammingIndexDestroy(featuresIndex->hamming);
+			delete featuresIndex;
 		spLoggerPrintInfo(KD_TREE_DESTROY);
 		onlyConfig = false;
 	}
+	if (store != NULL) {
+		spFeatureStoreDestroy(store);
+		spLoggerPrintInfo(FEATURE_STORE_DESTROY);
+		onlyConfig = false;
+	}
 	spConfigDestroy(config);
 	if (onlyConfig) {  // before logger created
 		printf(CONFIG_DESTROY);
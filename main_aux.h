@@ -2,16 +2,28 @@
 #define MAIN_AUX_H_
 
 #include "SPImageProc.h"
+#include "SPQueryPipeline.h"
+#include "SPQueryServer.h"
+#include "SPQueryCache.h"
+#include "SPFeatureWriter.h"
 extern "C" {
 #include <stdlib.h>
 #include <stddef.h>
 #include <string.h>
 #include "SPKDTreeNode.h"
+#include "SPHammingIndex.h"
+#include "SPVoteTable.h"
+#include "SPFeatureStore.h"
+#include "SPFeatsFile.h"
+#include "SPKDTreeSnapshot.h"
+#include "SPExtractionManifest.h"
 }
 using namespace sp;
 
 #define DEFAULT_CONFIG_FILENAME "spcbir.config"
-#define INVALID_COMMAND_LINE_ERROR "Invalid command line : use -c %s\n"
+#define DEFAULT_RESULTS_FILENAME "spcbir.results"
+#define INVALID_COMMAND_LINE_ERROR "Invalid command line : use -c %s [-q <query list file> [-o <results file>]]" \
+	" [-s <socket file>]\n"
 #define CONFIG_CANNOT_OPEN_FILE "The%s configuration file %s couldn't be opened\n"
 #define CONFIG_CREATED "Config CREATED\n"
 #define CONFIG_DESTROY "Config DESTROYED\n"
@@ -31,68 +43,104 @@ using namespace sp;
 #define BEST_CANDIDATES "Best candidates for - %s - are:\n"
 #define COULDNT_BE_RESOLVED "couldn't be resolved\n"
 #define EXTRACTING_FEATS_ERROR "Extracting features from images failed\n"
-#define SIFT_DB_CREATED "Sift DB CREATED\n"
-#define SIFT_DB_DESTROY "Sift DB DESTROYED\n"
-#define ALL_FEATURES_ARRAY_CREATED "All Features Array CREATED\n"
-#define ALL_FEATURES_ARRAY_DESTROY "All Features Array DESTROYED\n"
-#define ALL_FEATURES_ARRAY_ERROR "All Features Array couldn't be created\n"
+#define FEATURE_STORE_CREATED "Feature Store CREATED\n"
+#define FEATURE_STORE_DESTROY "Feature Store DESTROYED\n"
+#define FEATURE_STORE_ERROR "Feature Store couldn't be created\n"
 #define KD_TREE_CREATED "KD Tree CREATED\n"
 #define KD_TREE_DESTROY "KD Tree DESTROYED\n"
 #define KD_TREE_ERROR "KD Tree couldn't be created\n"
+#define KD_TREE_SNAPSHOT_PATH_ERROR "KD Tree snapshot path couldn't be resolved\n"
+#define KD_TREE_SNAPSHOT_LOADED "KD Tree LOADED from its snapshot\n"
+#define KD_TREE_SNAPSHOT_REBUILD "KD Tree snapshot couldn't be loaded, building the KD Tree\n"
+#define KD_TREE_SNAPSHOT_WRITE_ERROR "KD Tree snapshot couldn't be saved\n"
 #define KNN_ERROR "Couldn't find K nearest neighbors\n"
 #define TERMINATE "<>"
 #define EXITING "Exiting...\n"
-#define COUNT_K_CLOSEST_ERROR "the function countKClosestPerFeature couldn't be complete\n"
-#define SORT_FEATURES_COUNT_ERROR "the function sortFeaturesCount couldn't be complete\n"
+#define FIND_CLOSEST_IMAGES_ERROR "the function findClosestImages couldn't be complete\n"
 #define FEATS_ERROR "There is no feats for these image\n"
 #define FEATS_READING_ERROR "Can't read features from file\n"
 #define NUM_FEATS_READING_ERROR "Can't read number of features per image\n"
 #define EXTRACT_FEATURES_FROM_IMAGES "Extracting the features from images...\n"
 #define EXTRACT_FEATURES_FROM_FILE "Extracting the features from feats files...\n"
+#define EXTRACT_FEATURES_FROM_DATABASE "Reading the features from the database file...\n"
+#define DATABASE_PATH_ERROR "Database path couldn't be resolved\n"
+#define DATABASE_READ_ERROR "Can't read features from the database file\n"
+#define DATABASE_WRITE_ERROR "Write to database file failed\n"
+#define EXTRACTION_MANIFEST_PATH_ERROR "Extraction manifest path couldn't be resolved\n"
+#define EXTRACTION_MANIFEST_ERROR "Extraction manifest couldn't be created\n"
+#define EXTRACTION_MANIFEST_RECORD_ERROR "Image couldn't be recorded in the extraction manifest\n"
+#define EXTRACTION_MANIFEST_WRITE_ERROR "Extraction manifest couldn't be saved\n"
+#define EXTRACTION_MANIFEST_LOADED "Extraction manifest LOADED, only new or changed images are extracted\n"
+#define EXTRACTION_MANIFEST_FULL "No matching extraction manifest, extracting all the images\n"
+#define FEATS_REUSE_ERROR "The features of an unchanged image couldn't be reused, extracting it again\n"
+#define FEATURES_REUSED "The features of %d of the %d images were reused\n"
 #define EXTRACT_FEATURES_FROM_QUERY "Extracting the features from query image...\n"
+#define READ_FEATURES_FROM_QUERY "Reading the features from query feats file...\n"
+#define FEATS_SUFFIX ".feats"
 #define SHOW_RESULTS_ERROR "the function showResults couldn't be complete\n"
 #define IMAGE_PROC_ERROR "Error in ImageProc functions\n"
 #define SEARCH_CLOSEST_IMAGES "Searching for closest images...\n"
+#define QUERY_LIST_CANNOT_OPEN_FILE "The query list file couldn't be opened\n"
+#define RESULTS_CANNOT_OPEN_FILE "The results file couldn't be opened\n"
+#define RESULTS_WRITE_ERROR "Write to results file failed\n"
+#define QUERY_FAILED "Query - %s - couldn't be processed\n"
+#define QUERY_PATH_TOO_LONG "A line of the query list is too long for a path, its query fails\n"
+#define BATCH_QUERIES_STARTED "Answering the queries of the query list...\n"
+#define BATCH_QUERIES_DONE "All the queries of the query list were answered\n"
+#define BATCH_QUERIES_ERROR "the function runBatchQueries couldn't be complete\n"
+#define QUERY_SERVER_ERROR "the function runQueryServer couldn't be complete\n"
+#define QUERY_CACHE_CREATED "Query cache CREATED\n"
+#define QUERY_CACHE_CONTEXT_SEED 14695981039346656037ULL
+#define SEARCH_BLOCK_SIZE 16 // features searched by each worker between two vote margin checks
+#define DEADLINE_APPROXIMATE_CHECKS 32 // leaves checked by each approximate search of a query late for its deadline
+#define FEATURE_WRITER_QUEUE_SIZE 4 // feats files waiting to be written while the next images are extracted
+#define DEGRADED_RESULTS "(degraded to meet the query deadline)\n"
 
 
 /**
- * Extracting all the features of the images, and stores it to a SPPoint array database.
+ * Extracting all the features of the images, and moves them into the feature store.
  * Supports two modes:
  * EXTRACTION		- extracts the features of each image and stores each of these features to a
  * 					  ".feat" file.
- * NON-EXTRACTION	- extracts the features of each image from the ".feat" files.
+ * NON-EXTRACTION	- extracts the features of each image from the ".feat" files, read by
+ * 					  spNumOfLoadThreads workers.
+ * When spDatabaseFilename is set, the single database file takes the place of the ".feat" files
+ * in both modes.
+ * When spExtractionManifestFilename is set, extraction mode only extracts the images which are new
+ * or changed since the manifest of the previous extraction, and reuses the features of the others.
  *
- * @param siftDB 		 	 - the SPPoint array in which the function stores the extracted features to
+ * @param store 		 	 - the feature store in which the function stores the extracted features to
  * @param numOfImgs			 - the number of images to extract the features from
- * @param numOfAllFeatures 	 - the number of all features which were successfully extracted
  * @param config 			 - the configuration structure
  * @param msg 				 - pointer in which the msg returned by any functions of the config is stored
  * @param imageProc 		 - imageProc object for using openCV
  *
  * @return
  * -1 in case of invalid arguments, or failure
- * 1 if successfully extracted all the features and stored it to <siftDB>
+ * 1 if successfully extracted all the features and stored it to <store>
  */
-int extractFeatures(SPPoint*** siftDB, int numOfImgs, int* numOfFeaturesPerImage, int* numOfAllFeatures,
-		SPConfig config, SP_CONFIG_MSG* msg, ImageProc* imageProc);
+int extractFeatures(SPFeatureStore* store, int numOfImgs, SPConfig config, SP_CONFIG_MSG* msg,
+		ImageProc* imageProc);
 
 /**
- * Converting 2D SPPoint array to 1D SPPoint array.
+ * Checks whether the PCA should be trained from the images, rather than loaded from the PCA file.
+ * It's trained in extraction mode, unless the extraction manifest of the previous extraction
+ * matches the PCA file and the other settings - the PCA is then kept, so the features of the
+ * unchanged images can be reused (see extractFeatures).
  *
- * @param allFeaturesArr 	 	- the SPPoint array in which the function stores the features to
- * @param siftDB			 	- the sift features which stores all the features of the files
- * @param numOfImgs 	 	 	- the number of images
- * @param numOfFeaturesPerImage - array of ints which stores the number of features of each image
+ * @param config 			 - the configuration structure
  *
- * @return the number of points which were copied to <allFeaturesArr>
+ * @return
+ * true if the PCA should be trained, false otherwise (as with ORB features, which have no PCA,
+ * or in case of invalid arguments)
  */
-int createAllFeaturesArray(SPPoint** allFeaturesArr, SPPoint*** siftDB, int numOfImgs, int* numOfFeaturesPerImage);
+bool isPCATrainingNeeded(SPConfig config);
 
 /**
- * Builds the features KDTree database.
+ * Builds the features KDTree database over the features of the store.
+ * The leaves of the KDTree reference the features of the store, so the store must outlive the KDTree.
  *
- * @param allFeaturesArr 	 - the SPPoint array in which the function uses to build the KDArray
- * @param numOfAllFeatures 	 - the number of all features which successfully extracted
+ * @param store 			 - the feature store the function uses to build the KDArray
  * @param config 			 - the configuration structure
  * @param msg 				 - pointer in which the msg returned by any functions of the config is stored
  *
@@ -100,42 +148,152 @@ int createAllFeaturesArray(SPPoint** allFeaturesArr, SPPoint*** siftDB, int numO
  * NULL in case of invalid arguments, or failure
  * Otherwise, the root of the KDTree is returned
  */
-SPKDTreeNode* buildFeaturesKDTree(SPPoint** allFeaturesArr, int numOfAllFeatures, SPConfig config ,SP_CONFIG_MSG* msg);
+SPKDTreeNode* buildFeaturesKDTree(SPFeatureStore* store, SPConfig config ,SP_CONFIG_MSG* msg);
+
+/**
+ * The index the query features are searched in: a KDTree over SIFT features, or a Hamming index
+ * over ORB features (see spFeatureType). Only the one of the feature type is set.
+ */
+struct FeaturesIndex {
+	SPKDTreeNode* tree;
+	SPHammingIndex* hamming;
+};
 
 /**
- * Getting the querySift DB, finding KNN for each feature, and counting the feature hits for each image.
+ * Builds the index of the features of the store by the feature type - the KDTree of
+ * buildFeaturesKDTree for SIFT features, or a Hamming index (which copies the features) for ORB features.
  *
- * @param featuresTree 	 	 - the root to the features KDArray
+ * @param store 			 - the feature store the function uses to build the index
+ * @param config 			 - the configuration structure
+ * @param msg 				 - pointer in which the msg returned by any functions of the config is stored
+ *
+ * @return
+ * NULL in case of invalid arguments, or failure
+ * Otherwise, the index is returned, to be destroyed by terminate
+ */
+FeaturesIndex* buildFeaturesIndex(SPFeatureStore* store, SPConfig config ,SP_CONFIG_MSG* msg);
+
+/**
+ * Creates the query cache shared by all the queries of this run, sized by spQueryCacheSize.
+ * The cached rankings are tied to spKNN, spNumOfSimilarImages, the early termination mode and
+ * the index, so a run with other values never sees them.
+ *
+ * @param config 			 - the configuration structure
+ * @param numOfImgs 	 	 - the number of images
+ * @param numOfAllFeatures 	 - the number of features in the index
+ *
+ * @return
+ * NULL if the cache is disabled, in case of invalid arguments, or failure
+ * Otherwise, the new cache is returned
+ */
+QueryCache* createQueryCache(SPConfig config, int numOfImgs, int numOfAllFeatures);
+
+/**
+ * Getting the querySift DB, finding KNN for each feature, counting the feature hits for each image,
+ * and sorting the images indexes by the number of feature hits (see sortFeaturesCount).
+ * The query may be an image, or a precomputed ".feats" file (see getQueryFeatures).
+ * If a cache is given, a query whose file content was already seen reuses its cached ranking,
+ * or at least its cached features, and the computed features and ranking are cached.
+ *
+ * @param featuresIndex 	 	 - the index of the features
  * @param numOfImgs 	 	 - the number of images
  * @param queryPath 		 - the query path
  * @param config 			 - the configuration structure
  * @param msg 				 - pointer in which the msg returned by any functions of the config is stored
  * @param imageProc 		 - imageProc object for using openCV
+ * @param cache 			 - the query cache, or NULL
+ * @param numOfThreads 		 - the maximal number of workers searching the query features
+ * @param degraded 			 - set to true if the search was degraded to meet spQueryDeadline
+ * 							   (see countKClosestForFeatures), false otherwise. Degraded rankings aren't cached.
  *
  * @return
  * NULL in case of invalid arguments, or failure
- * Otherwise, the pointer to the counter array which stores the feature hits for each image is returned
+ * Otherwise, the sorted BPQueueElement array of the numOfSimilarImages best images indexes and their
+ * # of feature hits is returned
+ */
+BPQueueElement* findClosestImages(FeaturesIndex* featuresIndex, int numOfImgs, const char* queryPath,
+		SPConfig config, SP_CONFIG_MSG* msg, ImageProc* imageProc, QueryCache* cache, int numOfThreads,
+		bool* degraded);
+
+/**
+ * A monotonic clock for measuring the latency of the queries.
+ *
+ * @return the current time in microseconds, since an arbitrary point
+ */
+long long queryClockNow();
+
+/**
+ * Returns the deadline of a query starting now, by spQueryDeadline.
+ *
+ * @param config - the configuration structure
+ *
+ * @return
+ * 0 if there is no deadline, or in case of failure
+ * Otherwise, the queryClockNow time at which the query is due
  */
-int* countKClosestPerFeature(SPKDTreeNode* featuresTree, int numOfImgs, char* queryPath,
-		SPConfig config, SP_CONFIG_MSG* msg, ImageProc* imageProc);
+long long queryDeadlineFromConfig(SPConfig config);
 
 /**
- * Sorting the images indexes by the number of feature hits.
- * Using BPQueueElement which holds <i ,counter[i]>, such that:
- * <i> = the index of the image, counter[i] = the number of feature hits of the image.
- * The best images appear first, i.e the images which have the most feature hits
+ * Finding KNN for each of the query features, and counting the feature hits for each image.
+ * The search starts up to <numOfThreads> workers once for the whole query, and each worker takes
+ * the next unsearched feature into its own BPQueue and vote table. The tables are merged at the end
+ * (of each block, see below), so the result is identical to searching the features one after another.
  *
- * @param counter 	 		 - the root to the features KDArray
+ * If decidedTopN is positive (early termination mode), the features are searched in blocks, and
+ * after each block the vote margin between the decidedTopN-th best image and the best image
+ * trailing it is checked. Once the remaining features can't close that margin the search stops,
+ * so the set of the best decidedTopN images is the same as in a full search, while their
+ * internal order follows the votes counted so far. The features should be ordered strongest
+ * first (see ImageProc::getImageFeatures) so the leading images pull ahead early.
+ *
+ * If a deadline is given, the workers check it before each feature, and the search degrades
+ * rather than miss it: once the time of the remaining features, projected from the features searched
+ * so far, would pass the deadline, the rest are searched approximately (see spKDTreeNodeGetKNNBounded
+ * and spHammingIndexGetKNNBounded),
+ * and once the deadline passed the remaining, i.e weakest, features aren't searched at all.
+ * The first feature of each worker is always searched.
+ *
+ * @param featuresIndex 	 	 - the index of the features
  * @param numOfImgs 	 	 - the number of images
+ * @param querySift 	 	 - the query features
+ * @param nFeaturesQuery 	 - the number of query features
+ * @param spKNN 	 	 	 - the number of nearest neighbors to count for each feature
+ * @param numOfThreads 	 	 - the maximal number of workers to use
+ * @param decidedTopN 	 	 - the number of best images whose ranking ends the search early,
+ * 							   or 0 to search every feature
+ * @param deadline 	 	 	 - the queryClockNow time at which the query is due, or 0 for no deadline
+ * @param degraded 	 	 	 - if not NULL, set to true if the search was degraded to meet the deadline,
+ * 							   false otherwise
  *
  * @return
  * NULL in case of invalid arguments, or failure
- * Otherwise, the sorted BPQueueElement array of the images indexes and their # of feature hits is returned
+ * Otherwise, the vote table which stores the feature hits of each voted image is returned
  */
-BPQueueElement* sortFeaturesCount(int* counter, int numOfImgs);
+SPVoteTable* countKClosestForFeatures(FeaturesIndex* featuresIndex, int numOfImgs, SPPoint** querySift,
+		int nFeaturesQuery, int spKNN, int numOfThreads, int decidedTopN, long long deadline, bool* degraded);
+
+/**
+ * Sorting the images indexes by the number of feature hits, and keeping the best numOfSimilarImages.
+ * Using BPQueueElement which holds <i ,votes[i]>, such that:
+ * <i> = the index of the image, votes[i] = the number of feature hits of the image.
+ * The best images appear first, i.e the images which have the most feature hits, and images with
+ * the same feature hits are sorted by their index. Only the voted images are visited, and only
+ * the best numOfSimilarImages of them are sorted (see spVoteTableTopN).
+ *
+ * @param votes 	 		 - the feature hits of the voted images
+ * @param numOfImgs 	 	 - the number of images
+ * @param numOfSimilarImages - the number of best images to return
+ *
+ * @return
+ * NULL in case of invalid arguments, or failure
+ * Otherwise, the sorted BPQueueElement array of the numOfSimilarImages best images indexes and their
+ * # of feature hits is returned
+ */
+BPQueueElement* sortFeaturesCount(SPVoteTable* votes, int numOfImgs, int numOfSimilarImages);
 
 /**
  * Reads the features of an image from the ".feat" file, and stores it to a SPPoint array.
+ * The file may be in the text or in the binary format (see SPFeatsFile.h).
  *
  * @param imgIndex 		 	 - the index of the image
  * @param numFeatures		 - the array which used to stored the number of extracted features
@@ -148,6 +306,32 @@ BPQueueElement* sortFeaturesCount(int* counter, int numOfImgs);
  */
 SPPoint** readFeaturesFromFile(int imgIndex, int* numFeatures, char* path, int pcaNumComp);
 
+/**
+ * Checks whether a query path refers to a precomputed ".feats" file rather than an image.
+ *
+ * @param queryPath 		 - the query path
+ *
+ * @return
+ * true if queryPath ends with ".feats", false otherwise
+ */
+bool isFeaturesFile(const char* queryPath);
+
+/**
+ * Gets the features of a query. A ".feats" query is read as is, in the same format the
+ * extraction mode writes, skipping image decoding, SIFT and PCA. Any other query is
+ * treated as an image and its features are extracted by imageProc.
+ *
+ * @param queryPath 		 - the query path
+ * @param numOfFeatures 	 - pointer in which the number of query features is stored
+ * @param pcaDim 			 - the PCA dimension
+ * @param imageProc 		 - imageProc object for using openCV
+ *
+ * @return
+ * NULL in case of invalid arguments, or failure
+ * Otherwise, the SPPoint array of the query features is returned
+ */
+SPPoint** getQueryFeatures(const char* queryPath, int* numOfFeatures, int pcaDim, ImageProc* imageProc);
+
 /**
  * Getting the image query path from user.
  *
@@ -182,10 +366,57 @@ int getQueryPath(char* path);
 bool showResults(char* queryPath, BPQueueElement* queryClosestImages, SPConfig config, SP_CONFIG_MSG* msg,
 		ImageProc* imageProc);
 
+/**
+ * Batch mode - answers every query path listed in <queryListPath> (one path per line), and writes
+ * the numOfSimilarImages closest images of each query to <resultsPath>, in the order of the list.
+ * The format of each query result is the same as in NON-MINIMAL GUI mode.
+ * The queries go through a QueryPipeline of three stages - decoding, SIFT extraction and PCA
+ * projection, and KNN search and voting - run by spNumOfDecodeThreads, spNumOfExtractThreads and
+ * spNumOfSearchThreads workers respectively, with up to spPipelineQueueSize queries waiting between
+ * two stages. A ".feats" query is read by the decoding stage and skips the extraction stage.
+ * A query found in the cache skips the stages it doesn't need, from the decoding stage on.
+ * A query which fails (e.g. a missing image, or a line too long for a path) is reported in the
+ * results file, and does not stop the other queries.
+ *
+ * @param featuresIndex 	 - the index of the features
+ * @param numOfImgs 	 - the number of images
+ * @param queryListPath  - the file which lists the query paths
+ * @param resultsPath 	 - the file to write the results to
+ * @param config 		 - the configuration structure
+ * @param imageProc 	 - imageProc object for using openCV
+ * @param cache 		 - the query cache, or NULL
+ *
+ * @return
+ * -1 in case of invalid arguments, or failure
+ * 1 if all the queries were answered and written to <resultsPath>
+ */
+int runBatchQueries(FeaturesIndex* featuresIndex, int numOfImgs, const char* queryListPath, const char* resultsPath,
+		SPConfig config, ImageProc* imageProc, QueryCache* cache);
+
+/**
+ * Server mode - serves queries over the Unix domain socket <socketPath> until a client sends a
+ * SHUTDOWN request (see QueryServer for the protocol). The database and the KDTree are loaded once,
+ * and up to spNumOfServerThreads requests are served concurrently. Each query is answered by the
+ * numOfSimilarImages closest images and their feature hits. A QUERY path may be an image or a
+ * precomputed ".feats" file, and FEATURES requests carry the raw features themselves.
+ *
+ * @param featuresIndex 	 - the index of the features
+ * @param numOfImgs 	 - the number of images
+ * @param socketPath 	 - the path of the socket
+ * @param config 		 - the configuration structure
+ * @param imageProc 	 - imageProc object for using openCV
+ * @param cache 		 - the query cache, or NULL
+ *
+ * @return
+ * -1 in case of invalid arguments, or failure
+ * 1 if the server was shut down by a client
+ */
+int runQueryServer(FeaturesIndex* featuresIndex, int numOfImgs, const char* socketPath, SPConfig config,
+		ImageProc* imageProc, QueryCache* cache);
+
 /**
  * Frees all memory resources associate with the program, and terminates it.
  */
-void terminate(SPConfig config, SPPoint*** siftDB, int numOfImgs, int* numOfFeaturesPerImage,
-		SPPoint** allFeaturesArr, int numOfAllFeatures, SPKDTreeNode* featuresTree);
+void terminate(SPConfig config, SPFeatureStore* store, FeaturesIndex* featuresIndex);
 
 #endif /* MAIN_AUX_H_ */
@@ -91,6 +91,10 @@ bool configFilesSetValues(){
 	num = spConfigGetNumOfSimilarImages(config,&msg);
 	ASSERT_TRUE(num==5);
 	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+
+	num = spConfigGetNumOfThreads(config,&msg);
+	ASSERT_TRUE(num==4);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
 	return true;
 
 	msg = spConfigGetImagePath(char1,config,0);
@@ -131,12 +135,96 @@ bool configFilesDefultValues(){
 	ASSERT_TRUE(num==20);
 	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
 
+	num = spConfigGetNumOfThreads(config,&msg);
+	ASSERT_TRUE(num==1);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+
+	num = spConfigGetNumOfSearchThreads(config,&msg);
+	ASSERT_TRUE(num==1);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+
+	num = spConfigGetPipelineQueueSize(config,&msg);
+	ASSERT_TRUE(num==8);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+
+	bool1 = spConfigIsEarlyTermination(config,&msg);
+	ASSERT_TRUE(bool1==false);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+
+	num = spConfigGetQueryCacheSize(config,&msg);
+	ASSERT_TRUE(num==0);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+
+	num = spConfigGetQueryDeadline(config,&msg);
+	ASSERT_TRUE(num==0);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+
+	bool1 = spConfigIsBinaryFeatures(config,&msg);
+	ASSERT_TRUE(bool1==false);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+
 
 	msg = spConfigGetPCAPath(char1,config);
 	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
 	num = strcmp(char1,"./images/pca.yml");
 	ASSERT_TRUE(num==0);
 
+	num = spConfigGetNumOfLoadThreads(config,&msg);
+	ASSERT_TRUE(num==1);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+
+	num = spConfigGetMaxImageDimension(config,&msg);
+	ASSERT_TRUE(num==0);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+
+	ASSERT_TRUE(spConfigGetFeatureType(config,&msg)==SIFT_FEATURES);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+
+	num = spConfigGetFeatureDim(config,&msg);
+	ASSERT_TRUE(num==spConfigGetPCADim(config,&msg));
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+
+	msg = spConfigGetDatabasePath(char1,config);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+	num = strcmp(char1,"");
+	ASSERT_TRUE(num==0);
+
+	msg = spConfigGetKDTreeSnapshotPath(char1,config);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+	num = strcmp(char1,"");
+	ASSERT_TRUE(num==0);
+
+	msg = spConfigGetExtractionManifestPath(char1,config);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+	num = strcmp(char1,"");
+	ASSERT_TRUE(num==0);
+
+	return true;
+	}
+
+//checks the paths of the images listed in an image catalogue
+bool configFileCatalogue(){
+	SP_CONFIG_MSG msg;
+	SPConfig config;
+	char char1[1024*4];
+
+	config = spConfigCreate("./unit_tests/configs/config_catalogue.config",&msg);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+	ASSERT_TRUE(spConfigGetNumOfImages(config,&msg)==3);
+
+	msg = spConfigGetImagePath(char1,config,0);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+	ASSERT_TRUE(strcmp(char1,"/data/a7/img0.jpg")==0);
+	msg = spConfigGetImagePath(char1,config,1);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+	ASSERT_TRUE(strcmp(char1,"./unit_tests/configs/b2/img1.png")==0);
+	msg = spConfigGetFeatsPath(char1,config,2);
+	ASSERT_TRUE(msg==SP_CONFIG_SUCCESS);
+	ASSERT_TRUE(strcmp(char1,"./unit_tests/configs/b2/img2.tar.feats")==0);
+	msg = spConfigGetImagePath(char1,config,3);
+	ASSERT_TRUE(msg==SP_CONFIG_INDEX_OUT_OF_RANGE);
+
+	spConfigDestroy(config);
 	return true;
 	}
 
@@ -153,6 +241,8 @@ int main(){
 	printf("*********************************************\n");
 	RUN_TEST(configFilesDefultValues);
 	printf("*********************************************\n");
+	RUN_TEST(configFileCatalogue);
+	printf("*********************************************\n");
 
 	printf("test ok!");
 	return 0;
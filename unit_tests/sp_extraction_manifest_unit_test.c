@@ -0,0 +1,142 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "unit_test_util.h" //SUPPORTING MACROS ASSERT_TRUE/ASSERT_FALSE etc..
+#include "../SPExtractionManifest.h"
+
+#define MANIFEST "./unit_tests/extraction_manifest_test.spmf"
+#define FIRST_IMAGE "./unit_tests/extraction_manifest_test_0.png"
+#define SECOND_IMAGE "./unit_tests/extraction_manifest_test_1.png"
+
+static bool writeImage(const char* path, const char* content){
+	FILE* file = fopen(path, "wb");
+	if (file == NULL) {
+		return false;
+	}
+	fputs(content, file);
+	return fclose(file) == 0;
+}
+
+static void removeFiles(){
+	remove(MANIFEST);
+	remove(FIRST_IMAGE);
+	remove(SECOND_IMAGE);
+}
+
+static SPExtractionManifest* recordImages(int numOfImages, unsigned long long settingsHash,
+		const SPExtractionManifest* previous){
+	SPExtractionManifest* manifest = spExtractionManifestCreate(numOfImages, settingsHash);
+	if (manifest == NULL
+			|| spExtractionManifestRecord(manifest, 0, FIRST_IMAGE, previous) != SP_EXTRACTION_MANIFEST_SUCCESS
+			|| (numOfImages > 1 && spExtractionManifestRecord(manifest, 1, SECOND_IMAGE, previous)
+					!= SP_EXTRACTION_MANIFEST_SUCCESS)) {
+		spExtractionManifestDestroy(manifest);
+		return NULL;
+	}
+	return manifest;
+}
+
+static bool manifestRoundTripTest(){
+	ASSERT_TRUE(writeImage(FIRST_IMAGE, "first image"));
+	ASSERT_TRUE(writeImage(SECOND_IMAGE, "second image"));
+	unsigned long long settingsHash = spExtractionManifestSettingsHash(42, 20, 100, false, 0);
+	SPExtractionManifest* written = recordImages(2, settingsHash, NULL);
+	ASSERT_TRUE(written != NULL);
+	ASSERT_TRUE(spExtractionManifestWrite(MANIFEST, written) == SP_EXTRACTION_MANIFEST_SUCCESS);
+
+	SP_EXTRACTION_MANIFEST_MSG msg;
+	SPExtractionManifest* read = spExtractionManifestRead(MANIFEST, &msg);
+	ASSERT_TRUE(msg == SP_EXTRACTION_MANIFEST_SUCCESS);
+	ASSERT_TRUE(spExtractionManifestGetNumOfImages(read) == 2);
+	ASSERT_TRUE(spExtractionManifestGetSettingsHash(read) == settingsHash);
+	ASSERT_TRUE(spExtractionManifestIsUnchanged(written, read, 0));
+	ASSERT_TRUE(spExtractionManifestIsUnchanged(written, read, 1));
+	ASSERT_FALSE(spExtractionManifestIsUnchanged(written, NULL, 0));
+
+	spExtractionManifestDestroy(read);
+	spExtractionManifestDestroy(written);
+	removeFiles();
+	return true;
+}
+
+static bool manifestChangesTest(){
+	ASSERT_TRUE(writeImage(FIRST_IMAGE, "first image"));
+	unsigned long long settingsHash = spExtractionManifestSettingsHash(42, 20, 100, false, 0);
+	SPExtractionManifest* previous = recordImages(1, settingsHash, NULL);
+	ASSERT_TRUE(previous != NULL);
+
+	// rewriting the same content is no change, a new image or new settings are
+	ASSERT_TRUE(writeImage(FIRST_IMAGE, "first image"));
+	ASSERT_TRUE(writeImage(SECOND_IMAGE, "second image"));
+	SPExtractionManifest* current = recordImages(2, settingsHash, previous);
+	ASSERT_TRUE(current != NULL);
+	ASSERT_TRUE(spExtractionManifestIsUnchanged(current, previous, 0));
+	ASSERT_FALSE(spExtractionManifestIsUnchanged(current, previous, 1));
+	SPExtractionManifest* otherSettings = recordImages(1, spExtractionManifestSettingsHash(42, 20, 100, true, 0),
+			previous);
+	ASSERT_TRUE(otherSettings != NULL);
+	ASSERT_FALSE(spExtractionManifestIsUnchanged(otherSettings, previous, 0));
+	spExtractionManifestDestroy(otherSettings);
+	otherSettings = recordImages(1, spExtractionManifestSettingsHash(42, 20, 100, false, 1024), previous);
+	ASSERT_TRUE(otherSettings != NULL);
+	ASSERT_FALSE(spExtractionManifestIsUnchanged(otherSettings, previous, 0));
+	spExtractionManifestDestroy(otherSettings);
+	spExtractionManifestDestroy(current);
+
+	// a changed content is a change
+	ASSERT_TRUE(writeImage(FIRST_IMAGE, "first image, edited"));
+	current = recordImages(1, settingsHash, previous);
+	ASSERT_TRUE(current != NULL);
+	ASSERT_FALSE(spExtractionManifestIsUnchanged(current, previous, 0));
+	spExtractionManifestDestroy(current);
+
+	// an image which can't be read can't be recorded
+	remove(FIRST_IMAGE);
+	current = spExtractionManifestCreate(1, settingsHash);
+	ASSERT_TRUE(spExtractionManifestRecord(current, 0, FIRST_IMAGE, previous) == SP_EXTRACTION_MANIFEST_CANNOT_OPEN);
+	ASSERT_TRUE(spExtractionManifestRecord(current, 1, SECOND_IMAGE, previous)
+			== SP_EXTRACTION_MANIFEST_INVALID_ARGUMENT);
+	ASSERT_FALSE(spExtractionManifestIsUnchanged(current, previous, 0));
+
+	spExtractionManifestDestroy(current);
+	spExtractionManifestDestroy(previous);
+	removeFiles();
+	return true;
+}
+
+static bool manifestCorruptedTest(){
+	ASSERT_TRUE(writeImage(FIRST_IMAGE, "first image"));
+	SPExtractionManifest* manifest = recordImages(1, 7, NULL);
+	ASSERT_TRUE(manifest != NULL);
+	ASSERT_TRUE(spExtractionManifestWrite(MANIFEST, manifest) == SP_EXTRACTION_MANIFEST_SUCCESS);
+	spExtractionManifestDestroy(manifest);
+
+	// flipping a byte of an entry
+	FILE* file = fopen(MANIFEST, "r+b");
+	ASSERT_TRUE(file != NULL);
+	fseek(file, SP_EXTRACTION_MANIFEST_HEADER_SIZE + 8, SEEK_SET);
+	int byte = fgetc(file);
+	fseek(file, SP_EXTRACTION_MANIFEST_HEADER_SIZE + 8, SEEK_SET);
+	fputc(byte ^ 0xFF, file);
+	fclose(file);
+	SP_EXTRACTION_MANIFEST_MSG msg;
+	ASSERT_TRUE(spExtractionManifestRead(MANIFEST, &msg) == NULL);
+	ASSERT_TRUE(msg == SP_EXTRACTION_MANIFEST_CORRUPTED);
+
+	// not a manifest at all
+	ASSERT_TRUE(writeImage(MANIFEST, "not a manifest, but long enough for a header"));
+	ASSERT_TRUE(spExtractionManifestRead(MANIFEST, &msg) == NULL);
+	ASSERT_TRUE(msg == SP_EXTRACTION_MANIFEST_INVALID_FORMAT);
+
+	removeFiles();
+	ASSERT_TRUE(spExtractionManifestRead(MANIFEST, &msg) == NULL);
+	ASSERT_TRUE(msg == SP_EXTRACTION_MANIFEST_CANNOT_OPEN);
+	return true;
+}
+
+int main() {
+	RUN_TEST(manifestRoundTripTest);
+	RUN_TEST(manifestChangesTest);
+	RUN_TEST(manifestCorruptedTest);
+	return 0;
+}
@@ -0,0 +1,222 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "unit_test_util.h" //SUPPORTING MACROS ASSERT_TRUE/ASSERT_FALSE etc..
+#include "../SPFeatsFile.h"
+
+#define TEXT_FEATS "./unit_tests/feats_file_test_text.feats"
+#define BINARY_FEATS "./unit_tests/feats_file_test_binary.feats"
+#define DATABASE "./unit_tests/feats_file_test_database.spdb"
+
+static bool writeTextFeats(){
+	FILE* file = fopen(TEXT_FEATS, "w");
+	if (file == NULL) {
+		return false;
+	}
+	fprintf(file, "3\n1.500000 -2.000000 \n0.250000 4.000000 \n-8.000000 16.500000 \n");
+	fclose(file);
+	return true;
+}
+
+static bool featsFileTextTest(){
+	ASSERT_TRUE(writeTextFeats());
+	SP_FEATS_FILE_MSG msg;
+	int n = 0;
+	ASSERT_FALSE(spFeatsFileIsBinary(TEXT_FEATS));
+	SPPoint** features = spFeatsFileRead(TEXT_FEATS, 7, 2, &n, &msg);
+	ASSERT_TRUE(msg == SP_FEATS_FILE_SUCCESS);
+	ASSERT_TRUE(n == 3);
+	ASSERT_TRUE(spPointGetIndex(features[1]) == 7);
+	ASSERT_TRUE(spPointGetAxisCoor(features[1], 0) == 0.25);
+	ASSERT_TRUE(spPointGetAxisCoor(features[2], 1) == 16.5);
+	for (int i=0; i<n; i++) {
+		spPointDestroy(features[i]);
+	}
+	free(features);
+
+	// a missing coordinate
+	ASSERT_TRUE(spFeatsFileReadText(TEXT_FEATS, 7, 3, &n, &msg) == NULL);
+	ASSERT_TRUE(msg == SP_FEATS_FILE_INVALID_FORMAT);
+	remove(TEXT_FEATS);
+	ASSERT_TRUE(spFeatsFileReadText(TEXT_FEATS, 7, 2, &n, &msg) == NULL);
+	ASSERT_TRUE(msg == SP_FEATS_FILE_CANNOT_OPEN);
+	return true;
+}
+
+static bool writeFile(const char* content){
+	FILE* file = fopen(TEXT_FEATS, "w");
+	if (file == NULL) {
+		return false;
+	}
+	fputs(content, file);
+	fclose(file);
+	return true;
+}
+
+static bool featsFileTextFormatsTest(){
+	SP_FEATS_FILE_MSG msg;
+	int n = 0;
+	// any number strtod reads, separated by any white-space
+	ASSERT_TRUE(writeFile(" 2\r\n-1e2\t+.5 \n 0.1234567890123456789 1E-30\n"));
+	SPPoint** features = spFeatsFileReadText(TEXT_FEATS, 0, 2, &n, &msg);
+	ASSERT_TRUE(msg == SP_FEATS_FILE_SUCCESS);
+	ASSERT_TRUE(n == 2);
+	ASSERT_TRUE(spPointGetAxisCoor(features[0], 0) == -100);
+	ASSERT_TRUE(spPointGetAxisCoor(features[0], 1) == 0.5);
+	ASSERT_TRUE(spPointGetAxisCoor(features[1], 0) == strtod("0.1234567890123456789", NULL));
+	ASSERT_TRUE(spPointGetAxisCoor(features[1], 1) == 1e-30);
+	for (int i=0; i<n; i++) {
+		spPointDestroy(features[i]);
+	}
+	free(features);
+
+	// no features
+	ASSERT_TRUE(writeFile("0\n"));
+	features = spFeatsFileReadText(TEXT_FEATS, 0, 2, &n, &msg);
+	ASSERT_TRUE(msg == SP_FEATS_FILE_SUCCESS);
+	ASSERT_TRUE(n == 0);
+	free(features);
+
+	// a bad count, and a value which isn't a number
+	ASSERT_TRUE(writeFile(""));
+	ASSERT_TRUE(spFeatsFileReadText(TEXT_FEATS, 0, 2, &n, &msg) == NULL);
+	ASSERT_TRUE(msg == SP_FEATS_FILE_INVALID_COUNT);
+	ASSERT_TRUE(writeFile("-1\n"));
+	ASSERT_TRUE(spFeatsFileReadText(TEXT_FEATS, 0, 2, &n, &msg) == NULL);
+	ASSERT_TRUE(msg == SP_FEATS_FILE_INVALID_COUNT);
+	ASSERT_TRUE(writeFile("1\n1.5 abc\n"));
+	ASSERT_TRUE(spFeatsFileReadText(TEXT_FEATS, 0, 2, &n, &msg) == NULL);
+	ASSERT_TRUE(msg == SP_FEATS_FILE_INVALID_FORMAT);
+	remove(TEXT_FEATS);
+	return true;
+}
+
+static bool featsFileBinaryTest(){
+	ASSERT_TRUE(writeTextFeats());
+	SP_FEATS_FILE_MSG msg;
+	int n = 0, m = 0;
+	SPPoint** text = spFeatsFileReadText(TEXT_FEATS, 7, 2, &n, &msg);
+	ASSERT_TRUE(spFeatsFileWriteBinary(BINARY_FEATS, text, n, 2) == SP_FEATS_FILE_SUCCESS);
+	ASSERT_TRUE(spFeatsFileIsBinary(BINARY_FEATS));
+
+	// the coordinates are exact in float, so the round trip is lossless
+	SPPoint** binary = spFeatsFileRead(BINARY_FEATS, 7, 2, &m, &msg);
+	ASSERT_TRUE(msg == SP_FEATS_FILE_SUCCESS);
+	ASSERT_TRUE(m == n);
+	for (int i=0; i<n; i++) {
+		ASSERT_TRUE(spPointGetIndex(binary[i]) == 7);
+		ASSERT_TRUE(spPointL2SquaredDistance(text[i], binary[i]) == 0);
+		spPointDestroy(binary[i]);
+	}
+	free(binary);
+
+	// another dim
+	ASSERT_TRUE(spFeatsFileReadBinary(BINARY_FEATS, 7, 3, &m, &msg) == NULL);
+	ASSERT_TRUE(msg == SP_FEATS_FILE_INVALID_FORMAT);
+
+	for (int i=0; i<n; i++) {
+		spPointDestroy(text[i]);
+	}
+	free(text);
+	remove(TEXT_FEATS);
+	return true;
+}
+
+static bool featsFileCorruptedTest(){
+	SP_FEATS_FILE_MSG msg;
+	int n = 0;
+	double data[2] = {1, 2};
+	SPPoint* feature = spPointCreate(data, 2, 0);
+	ASSERT_TRUE(spFeatsFileWriteBinary(BINARY_FEATS, &feature, 1, 2) == SP_FEATS_FILE_SUCCESS);
+	spPointDestroy(feature);
+
+	// flipping a bit of the feature block
+	FILE* file = fopen(BINARY_FEATS, "r+b");
+	ASSERT_TRUE(file != NULL);
+	fseek(file, SP_FEATS_FILE_HEADER_SIZE, SEEK_SET);
+	int byte = fgetc(file);
+	fseek(file, SP_FEATS_FILE_HEADER_SIZE, SEEK_SET);
+	fputc(byte ^ 1, file);
+	fclose(file);
+	ASSERT_TRUE(spFeatsFileRead(BINARY_FEATS, 0, 2, &n, &msg) == NULL);
+	ASSERT_TRUE(msg == SP_FEATS_FILE_CORRUPTED);
+
+	// a truncated file
+	file = fopen(BINARY_FEATS, "wb");
+	ASSERT_TRUE(file != NULL);
+	fputs(SP_FEATS_FILE_MAGIC, file);
+	fclose(file);
+	ASSERT_TRUE(spFeatsFileRead(BINARY_FEATS, 0, 2, &n, &msg) == NULL);
+	ASSERT_TRUE(msg == SP_FEATS_FILE_CORRUPTED);
+	remove(BINARY_FEATS);
+	return true;
+}
+
+static SPFeatureStore* createDatabaseStore(){
+	SPFeatureStore* store = spFeatureStoreCreate(3);
+	double data[2] = {0, 0};
+	// image 1 has no features
+	for (int img=0; img<3; img+=2) {
+		SPPoint** features = (SPPoint**) malloc(2*sizeof(SPPoint*));
+		for (int i=0; i<2; i++) {
+			data[0] = img + i;
+			data[1] = -0.5 * i;
+			features[i] = spPointCreate(data, 2, img);
+		}
+		spFeatureStoreAddImage(store, img, features, 2);
+	}
+	spFeatureStoreAddImage(store, 1, (SPPoint**) malloc(sizeof(SPPoint*)), 0);
+	return store;
+}
+
+static bool featsFileDatabaseTest(){
+	SPFeatureStore* written = createDatabaseStore();
+	ASSERT_TRUE(spFeatsFileWriteDatabase(DATABASE, written, 2) == SP_FEATS_FILE_SUCCESS);
+
+	SPFeatureStore* read = spFeatureStoreCreate(3);
+	ASSERT_TRUE(spFeatsFileReadDatabase(DATABASE, read, 2) == SP_FEATS_FILE_SUCCESS);
+	ASSERT_TRUE(spFeatureStoreIsComplete(read));
+	ASSERT_TRUE(spFeatureStoreGetSize(read) == 4);
+	ASSERT_TRUE(spFeatureStoreGetImageSize(read, 1) == 0);
+	for (int img=0; img<3; img+=2) {
+		ASSERT_TRUE(spFeatureStoreGetImageSize(read, img) == 2);
+		for (int i=0; i<2; i++) {
+			SPPoint* feature = spFeatureStoreGetImageFeatures(read, img)[i];
+			ASSERT_TRUE(spPointGetIndex(feature) == img);
+			ASSERT_TRUE(spPointL2SquaredDistance(feature, spFeatureStoreGetImageFeatures(written, img)[i]) == 0);
+		}
+	}
+	spFeatureStoreDestroy(read);
+
+	// another number of images, and another dim
+	read = spFeatureStoreCreate(2);
+	ASSERT_TRUE(spFeatsFileReadDatabase(DATABASE, read, 2) == SP_FEATS_FILE_INVALID_FORMAT);
+	spFeatureStoreDestroy(read);
+	read = spFeatureStoreCreate(3);
+	ASSERT_TRUE(spFeatsFileReadDatabase(DATABASE, read, 3) == SP_FEATS_FILE_INVALID_FORMAT);
+
+	// flipping a bit of the feature block
+	FILE* file = fopen(DATABASE, "r+b");
+	ASSERT_TRUE(file != NULL);
+	fseek(file, -1, SEEK_END);
+	int byte = fgetc(file);
+	fseek(file, -1, SEEK_END);
+	fputc(byte ^ 1, file);
+	fclose(file);
+	ASSERT_TRUE(spFeatsFileReadDatabase(DATABASE, read, 2) == SP_FEATS_FILE_CORRUPTED);
+	ASSERT_TRUE(spFeatureStoreGetSize(read) == 0);
+
+	spFeatureStoreDestroy(read);
+	spFeatureStoreDestroy(written);
+	remove(DATABASE);
+	return true;
+}
+
+int main() {
+	RUN_TEST(featsFileTextTest);
+	RUN_TEST(featsFileTextFormatsTest);
+	RUN_TEST(featsFileBinaryTest);
+	RUN_TEST(featsFileCorruptedTest);
+	RUN_TEST(featsFileDatabaseTest);
+	return 0;
+}
@@ -0,0 +1,82 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "unit_test_util.h" //SUPPORTING MACROS ASSERT_TRUE/ASSERT_FALSE etc..
+#include "../SPFeatureStore.h"
+
+static SPPoint** imageFeatures(int imgIndex, int n){
+	SPPoint** features = (SPPoint**) malloc(n*sizeof(SPPoint*));
+	double data[2];
+	for (int i=0; i<n; i++) {
+		data[0] = imgIndex;
+		data[1] = i;
+		features[i] = spPointCreate(data, 2, imgIndex);
+	}
+	return features;
+}
+
+static bool featureStoreAddTest(){
+	SPFeatureStore* store = spFeatureStoreCreate(3);
+	ASSERT_TRUE(store != NULL);
+	ASSERT_TRUE(spFeatureStoreGetSize(store) == 0);
+	ASSERT_TRUE(spFeatureStoreGetFeatures(store) == NULL);
+	ASSERT_FALSE(spFeatureStoreIsComplete(store));
+
+	// adding out of order
+	ASSERT_TRUE(spFeatureStoreAddImage(store, 2, imageFeatures(2, 3), 3) == SP_FEATURE_STORE_SUCCESS);
+	ASSERT_TRUE(spFeatureStoreAddImage(store, 0, imageFeatures(0, 2), 2) == SP_FEATURE_STORE_SUCCESS);
+	ASSERT_TRUE(spFeatureStoreGetImageSize(store, 1) == -1);
+	ASSERT_TRUE(spFeatureStoreAddImage(store, 1, NULL, 0) == SP_FEATURE_STORE_SUCCESS);
+	ASSERT_TRUE(spFeatureStoreIsComplete(store));
+
+	ASSERT_TRUE(spFeatureStoreGetSize(store) == 5);
+	ASSERT_TRUE(spFeatureStoreGetNumOfImages(store) == 3);
+	ASSERT_TRUE(spFeatureStoreGetImageSize(store, 0) == 2);
+	ASSERT_TRUE(spFeatureStoreGetImageSize(store, 1) == 0);
+	ASSERT_TRUE(spFeatureStoreGetImageSize(store, 2) == 3);
+	ASSERT_TRUE(spFeatureStoreGetImageFeatures(store, 1) == NULL);
+
+	// each image's features are one after another in the array of all the features
+	SPPoint** image2 = spFeatureStoreGetImageFeatures(store, 2);
+	for (int i=0; i<3; i++) {
+		ASSERT_TRUE(spPointGetIndex(image2[i]) == 2);
+		ASSERT_TRUE(spPointGetAxisCoor(image2[i], 1) == i);
+	}
+	SPPoint** all = spFeatureStoreGetFeatures(store);
+	int perImage[3] = {0, 0, 0};
+	for (int i=0; i<5; i++) {
+		perImage[spPointGetIndex(all[i])]++;
+	}
+	ASSERT_TRUE(perImage[0] == 2 && perImage[1] == 0 && perImage[2] == 3);
+
+	spFeatureStoreDestroy(store);
+	return true;
+}
+
+static bool featureStoreInvalidTest(){
+	ASSERT_TRUE(spFeatureStoreCreate(0) == NULL);
+	ASSERT_TRUE(spFeatureStoreAddImage(NULL, 0, NULL, 0) == SP_FEATURE_STORE_INVALID_ARGUMENT);
+	ASSERT_TRUE(spFeatureStoreGetSize(NULL) == -1);
+	ASSERT_TRUE(spFeatureStoreGetImageSize(NULL, 0) == -1);
+
+	SPFeatureStore* store = spFeatureStoreCreate(2);
+	ASSERT_TRUE(spFeatureStoreAddImage(store, 2, NULL, 0) == SP_FEATURE_STORE_INVALID_ARGUMENT);
+	ASSERT_TRUE(spFeatureStoreAddImage(store, 0, NULL, 1) == SP_FEATURE_STORE_INVALID_ARGUMENT);
+	ASSERT_TRUE(spFeatureStoreAddImage(store, 0, imageFeatures(0, 1), 1) == SP_FEATURE_STORE_SUCCESS);
+
+	// the caller keeps the features which weren't added
+	SPPoint** again = imageFeatures(0, 1);
+	ASSERT_TRUE(spFeatureStoreAddImage(store, 0, again, 1) == SP_FEATURE_STORE_IMAGE_EXISTS);
+	ASSERT_TRUE(spFeatureStoreGetSize(store) == 1);
+	spPointDestroy(again[0]);
+	free(again);
+
+	spFeatureStoreDestroy(store);
+	return true;
+}
+
+int main() {
+	RUN_TEST(featureStoreAddTest);
+	RUN_TEST(featureStoreInvalidTest);
+	return 0;
+}
@@ -0,0 +1,166 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "unit_test_util.h" //SUPPORTING MACROS ASSERT_TRUE/ASSERT_FALSE etc..
+#include "../SPHammingIndex.h"
+
+#define DIM 16
+#define K 5
+
+//a pseudo random 16-bit word
+static double randomWord() {
+	return (double) (rand() & 0xFFFF);
+}
+
+static SPPoint* randomCode(int index) {
+	double data[DIM];
+	for (int i=0; i<DIM; i++) {
+		data[i] = randomWord();
+	}
+	return spPointCreate(data, DIM, index);
+}
+
+//a copy of p with <flips> of its bits flipped
+static SPPoint* nearCode(SPPoint* p, int flips, int index) {
+	double data[DIM];
+	for (int i=0; i<DIM; i++) {
+		data[i] = spPointGetAxisCoor(p, i);
+	}
+	for (int i=0; i<flips; i++) {
+		int bit = rand() % (DIM * 16);
+		int word = (int) data[bit / 16];
+		data[bit / 16] = (double) (word ^ (1 << (bit % 16)));
+	}
+	return spPointCreate(data, DIM, index);
+}
+
+//the K smallest distances of the query from the points, by brute force
+static void bruteForceKNN(SPPoint** points, int size, SPPoint* query, int* res) {
+	for (int k=0; k<K; k++) {
+		res[k] = DIM * 16 + 1;
+	}
+	for (int i=0; i<size; i++) {
+		int distance = spHammingIndexDistance(points[i], query);
+		for (int k=0; k<K; k++) {
+			if (distance < res[k]) {
+				for (int j=K-1; j>k; j--) {
+					res[j] = res[j-1];
+				}
+				res[k] = distance;
+				break;
+			}
+		}
+	}
+}
+
+//compares the distances in bpq with the brute force ones
+static bool sameKNN(SPBPQueue* bpq, SPPoint** points, int size, SPPoint* query) {
+	int expected[K];
+	BPQueueElement e;
+	bruteForceKNN(points, size, query, expected);
+	for (int k=0; k<K; k++) {
+		if (spBPQueuePeek(bpq, &e) != SP_BPQUEUE_SUCCESS || e.value != expected[k]
+				|| spHammingIndexDistance(points[e.index], query) != expected[k]) {
+			return false;
+		}
+		spBPQueueDequeue(bpq);
+	}
+	return true;
+}
+
+static bool hammingIndexInvalidTest() {
+	double data[DIM] = {0};
+	SPPoint* p = spPointCreate(data, DIM, 0);
+	ASSERT_TRUE(spHammingIndexBuild(NULL, 1, DIM) == NULL);
+	ASSERT_TRUE(spHammingIndexBuild(&p, 0, DIM) == NULL);
+	ASSERT_TRUE(spHammingIndexBuild(&p, 1, DIM - 1) == NULL);
+	data[3] = 0.5; //not a word
+	SPPoint* q = spPointCreate(data, DIM, 0);
+	ASSERT_TRUE(spHammingIndexBuild(&q, 1, DIM) == NULL);
+	data[3] = 65536.0; //more than 16 bits
+	SPPoint* r = spPointCreate(data, DIM, 0);
+	ASSERT_TRUE(spHammingIndexBuild(&r, 1, DIM) == NULL);
+
+	SPHammingIndex* index = spHammingIndexBuild(&p, 1, DIM);
+	SPBPQueue* bpq = spBPQueueCreate(1);
+	ASSERT_TRUE(index != NULL);
+	ASSERT_TRUE(spHammingIndexGetSize(index) == 1);
+	ASSERT_TRUE(spHammingIndexGetKNN(index, bpq, q) == -1);
+	ASSERT_TRUE(spHammingIndexGetKNN(index, NULL, p) == -1);
+	ASSERT_TRUE(spHammingIndexGetKNNBounded(index, bpq, p, 0) == -1);
+	ASSERT_TRUE(spHammingIndexGetKNN(index, bpq, p) == 1);
+	ASSERT_TRUE(spBPQueueMinValue(bpq) == 0);
+	spBPQueueDestroy(bpq);
+	spHammingIndexDestroy(index);
+	spPointDestroy(p);
+	spPointDestroy(q);
+	spPointDestroy(r);
+	return true;
+}
+
+static bool hammingIndexDistanceTest() {
+	double a[2] = {0, 65535.0};
+	double b[2] = {7, 65534.0};
+	SPPoint* p = spPointCreate(a, 2, 0);
+	SPPoint* q = spPointCreate(b, 2, 1);
+	ASSERT_TRUE(spHammingIndexDistance(p, p) == 0);
+	ASSERT_TRUE(spHammingIndexDistance(p, q) == 4);
+	ASSERT_TRUE(spHammingIndexDistance(q, p) == 4);
+	spPointDestroy(p);
+	spPointDestroy(q);
+	return true;
+}
+
+//searches sizes which probe the tables, and which fall back to a scan, against brute force
+static bool hammingIndexKNNTest() {
+	int sizes[3] = {10, 300, 3000};
+	srand(7);
+	for (int s=0; s<3; s++) {
+		int size = sizes[s];
+		SPPoint** points = (SPPoint**) malloc(size * sizeof(SPPoint*));
+		SPPoint* queries[4];
+		for (int i=0; i<4; i++) {
+			queries[i] = randomCode(0);
+		}
+		for (int i=0; i<size; i++) { //half near the queries
+			points[i] = (i % 2) ? randomCode(i) : nearCode(queries[i % 4], rand() % 60, i);
+		}
+		SPHammingIndex* index = spHammingIndexBuild(points, size, DIM);
+		ASSERT_TRUE(index != NULL);
+		ASSERT_TRUE(spHammingIndexGetSize(index) == size);
+		SPBPQueue* bpq = spBPQueueCreate(K);
+		for (int i=0; i<4; i++) {
+			ASSERT_TRUE(spHammingIndexGetKNN(index, bpq, queries[i]) == 1);
+			ASSERT_TRUE(sameKNN(bpq, points, size, queries[i]));
+		}
+
+		//a bounded search still fills the queue with true distances
+		ASSERT_TRUE(spHammingIndexGetKNNBounded(index, bpq, queries[0], 1) == 1);
+		ASSERT_TRUE(spBPQueueIsFull(bpq));
+		BPQueueElement e;
+		spBPQueuePeek(bpq, &e);
+		ASSERT_TRUE(e.value == spHammingIndexDistance(points[e.index], queries[0]));
+		spBPQueueClear(bpq);
+
+		spBPQueueDestroy(bpq);
+		spHammingIndexDestroy(index);
+		for (int i=0; i<size; i++) {
+			spPointDestroy(points[i]);
+		}
+		for (int i=0; i<4; i++) {
+			spPointDestroy(queries[i]);
+		}
+		free(points);
+	}
+	return true;
+}
+
+int main(){
+	RUN_TEST(hammingIndexInvalidTest);
+	printf("*********************************************\n");
+	RUN_TEST(hammingIndexDistanceTest);
+	printf("*********************************************\n");
+	RUN_TEST(hammingIndexKNNTest);
+	printf("*********************************************\n");
+	return 0;
+}
@@ -0,0 +1,79 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "unit_test_util.h" //SUPPORTING MACROS ASSERT_TRUE/ASSERT_FALSE etc..
+#include "../SPImageCatalogue.h"
+
+#define CATALOGUE "./unit_tests/image_catalogue_test.list"
+#define MAX_PATH_LENGTH 64
+
+static bool writeCatalogue(const char* content){
+	FILE* file = fopen(CATALOGUE, "w");
+	if (file == NULL) {
+		return false;
+	}
+	fputs(content, file);
+	return fclose(file) == 0;
+}
+
+// loads the catalogue, expecting it to fail with <expected> at <expectedLine>
+static bool catalogueFails(const char* content, SP_IMAGE_CATALOGUE_MSG expected, int expectedLine){
+	if (!writeCatalogue(content)) {
+		return false;
+	}
+	SP_IMAGE_CATALOGUE_MSG msg;
+	int line;
+	SPImageCatalogue* catalogue = spImageCatalogueLoad(CATALOGUE, "./images/", MAX_PATH_LENGTH, &line, &msg);
+	spImageCatalogueDestroy(catalogue);
+	remove(CATALOGUE);
+	return catalogue == NULL && msg == expected && line == expectedLine;
+}
+
+static bool catalogueLoadTest(){
+	ASSERT_TRUE(writeCatalogue("# sharded by the hash of the image\n"
+			"2 c4/img2.png\r\n"
+			"\n"
+			"0\t9a/img0.png\n"
+			"  1   /data/other shard/img1.jpg  \n"
+			"3 c4/img3.png"));
+	SP_IMAGE_CATALOGUE_MSG msg;
+	int line;
+	SPImageCatalogue* catalogue = spImageCatalogueLoad(CATALOGUE, "./images/", MAX_PATH_LENGTH, &line, &msg);
+	ASSERT_TRUE(msg == SP_IMAGE_CATALOGUE_SUCCESS);
+	ASSERT_TRUE(spImageCatalogueGetNumOfImages(catalogue) == 4);
+	ASSERT_TRUE(strcmp(spImageCatalogueGetPath(catalogue, 0), "./images/9a/img0.png") == 0);
+	ASSERT_TRUE(strcmp(spImageCatalogueGetPath(catalogue, 1), "/data/other shard/img1.jpg") == 0);
+	ASSERT_TRUE(strcmp(spImageCatalogueGetPath(catalogue, 2), "./images/c4/img2.png") == 0);
+	ASSERT_TRUE(strcmp(spImageCatalogueGetPath(catalogue, 3), "./images/c4/img3.png") == 0);
+	ASSERT_TRUE(spImageCatalogueGetPath(catalogue, 4) == NULL);
+	ASSERT_TRUE(spImageCatalogueGetPath(catalogue, -1) == NULL);
+	spImageCatalogueDestroy(catalogue);
+	remove(CATALOGUE);
+	return true;
+}
+
+static bool catalogueInvalidTest(){
+	ASSERT_TRUE(catalogueFails("0 a.png\nimg1.png\n", SP_IMAGE_CATALOGUE_INVALID_LINE, 2));
+	ASSERT_TRUE(catalogueFails("0 a.png\n1\n", SP_IMAGE_CATALOGUE_INVALID_LINE, 2));
+	ASSERT_TRUE(catalogueFails("0x a.png\n", SP_IMAGE_CATALOGUE_INVALID_LINE, 1));
+	ASSERT_TRUE(catalogueFails("0 a-path-which-is-far-too-long-once-the-base-directory-is-prepended.png\n",
+			SP_IMAGE_CATALOGUE_INVALID_LINE, 1));
+	ASSERT_TRUE(catalogueFails("0 a.png\n1 b.png\n0 c.png\n", SP_IMAGE_CATALOGUE_DUPLICATE_ID, 0));
+	ASSERT_TRUE(catalogueFails("0 a.png\n2 c.png\n", SP_IMAGE_CATALOGUE_MISSING_ID, 0));
+	ASSERT_TRUE(catalogueFails("# nothing but a comment\n", SP_IMAGE_CATALOGUE_MISSING_ID, 0));
+
+	SP_IMAGE_CATALOGUE_MSG msg;
+	int line;
+	ASSERT_TRUE(spImageCatalogueLoad(CATALOGUE, "./images/", MAX_PATH_LENGTH, &line, &msg) == NULL);
+	ASSERT_TRUE(msg == SP_IMAGE_CATALOGUE_CANNOT_OPEN);
+	ASSERT_TRUE(spImageCatalogueLoad(NULL, "./images/", MAX_PATH_LENGTH, &line, &msg) == NULL);
+	ASSERT_TRUE(msg == SP_IMAGE_CATALOGUE_INVALID_ARGUMENT);
+	return true;
+}
+
+int main() {
+	RUN_TEST(catalogueLoadTest);
+	RUN_TEST(catalogueInvalidTest);
+	return 0;
+}
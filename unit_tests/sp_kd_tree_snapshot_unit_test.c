@@ -0,0 +1,104 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "unit_test_util.h" //SUPPORTING MACROS ASSERT_TRUE/ASSERT_FALSE etc..
+#include "../SPKDTreeSnapshot.h"
+
+#define SNAPSHOT "./unit_tests/kd_tree_snapshot_test.spkt"
+#define NUM_OF_POINTS 40
+
+static SPPoint** snapshotPoints(){
+	SPPoint** points = (SPPoint**) malloc(NUM_OF_POINTS*sizeof(SPPoint*));
+	double data[3];
+	for (int i=0; i<NUM_OF_POINTS; i++) {
+		data[0] = (i * 7) % 13;
+		data[1] = (i * 11) % 17 - 8.5;
+		data[2] = i / 4.0;
+		points[i] = spPointCreate(data, 3, i % 5);
+	}
+	return points;
+}
+
+static void destroyPoints(SPPoint** points){
+	for (int i=0; i<NUM_OF_POINTS; i++) {
+		spPointDestroy(points[i]);
+	}
+	free(points);
+}
+
+// the trees have the same nodes, and their leaves reference the same points
+static bool sameTree(SPKDTreeNode* first, SPKDTreeNode* second){
+	if (first == NULL || second == NULL) {
+		return first == second;
+	}
+	return spKDTreeGetNodeDim(first) == spKDTreeGetNodeDim(second)
+			&& spKDTreeGetNodeVal(first) == spKDTreeGetNodeVal(second)
+			&& spKDTreeGetNodePoint(first) == spKDTreeGetNodePoint(second)
+			&& sameTree(spKDTreeGetLeftNode(first), spKDTreeGetLeftNode(second))
+			&& sameTree(spKDTreeGetRightNode(first), spKDTreeGetRightNode(second));
+}
+
+static bool snapshotRoundTripTest(){
+	SPPoint** points = snapshotPoints();
+	SPKDTreeNode* built = spKDTreeBuild(points, NUM_OF_POINTS, 3, MAX_SPREAD);
+	unsigned long long hash = spKDTreeSnapshotHash(points, NUM_OF_POINTS, 3, MAX_SPREAD);
+	ASSERT_TRUE(spKDTreeSnapshotWrite(SNAPSHOT, built, points, NUM_OF_POINTS, 3, hash) == SP_KD_TREE_SNAPSHOT_SUCCESS);
+
+	SP_KD_TREE_SNAPSHOT_MSG msg;
+	SPKDTreeNode* loaded = spKDTreeSnapshotRead(SNAPSHOT, points, NUM_OF_POINTS, 3, hash, &msg);
+	ASSERT_TRUE(msg == SP_KD_TREE_SNAPSHOT_SUCCESS);
+	ASSERT_TRUE(sameTree(built, loaded));
+
+	spKDTreeNodeDestroy(loaded);
+	spKDTreeNodeDestroy(built);
+	destroyPoints(points);
+	remove(SNAPSHOT);
+	return true;
+}
+
+static bool snapshotStaleTest(){
+	SPPoint** points = snapshotPoints();
+	SPKDTreeNode* built = spKDTreeBuild(points, NUM_OF_POINTS, 3, MAX_SPREAD);
+	unsigned long long hash = spKDTreeSnapshotHash(points, NUM_OF_POINTS, 3, MAX_SPREAD);
+	ASSERT_TRUE(spKDTreeSnapshotWrite(SNAPSHOT, built, points, NUM_OF_POINTS, 3, hash) == SP_KD_TREE_SNAPSHOT_SUCCESS);
+
+	// another split method, or other points
+	ASSERT_TRUE(hash != spKDTreeSnapshotHash(points, NUM_OF_POINTS, 3, INCREMENTAL));
+	SP_KD_TREE_SNAPSHOT_MSG msg;
+	unsigned long long otherHash = spKDTreeSnapshotHash(points, NUM_OF_POINTS, 3, INCREMENTAL);
+	ASSERT_TRUE(spKDTreeSnapshotRead(SNAPSHOT, points, NUM_OF_POINTS, 3, otherHash, &msg) == NULL);
+	ASSERT_TRUE(msg == SP_KD_TREE_SNAPSHOT_STALE);
+	ASSERT_TRUE(spKDTreeSnapshotRead(SNAPSHOT, points, NUM_OF_POINTS - 1, 3, hash, &msg) == NULL);
+	ASSERT_TRUE(msg == SP_KD_TREE_SNAPSHOT_STALE);
+	double data[3] = {100, 100, 100};
+	SPPoint* moved = points[7];
+	points[7] = spPointCreate(data, 3, 0);
+	ASSERT_TRUE(hash != spKDTreeSnapshotHash(points, NUM_OF_POINTS, 3, MAX_SPREAD));
+	spPointDestroy(points[7]);
+	points[7] = moved;
+
+	// flipping a bit of the last node
+	FILE* file = fopen(SNAPSHOT, "r+b");
+	ASSERT_TRUE(file != NULL);
+	fseek(file, -1, SEEK_END);
+	int byte = fgetc(file);
+	fseek(file, -1, SEEK_END);
+	fputc(byte ^ 1, file);
+	fclose(file);
+	ASSERT_TRUE(spKDTreeSnapshotRead(SNAPSHOT, points, NUM_OF_POINTS, 3, hash, &msg) == NULL);
+	ASSERT_TRUE(msg == SP_KD_TREE_SNAPSHOT_CORRUPTED);
+
+	remove(SNAPSHOT);
+	ASSERT_TRUE(spKDTreeSnapshotRead(SNAPSHOT, points, NUM_OF_POINTS, 3, hash, &msg) == NULL);
+	ASSERT_TRUE(msg == SP_KD_TREE_SNAPSHOT_CANNOT_OPEN);
+
+	spKDTreeNodeDestroy(built);
+	destroyPoints(points);
+	return true;
+}
+
+int main() {
+	RUN_TEST(snapshotRoundTripTest);
+	RUN_TEST(snapshotStaleTest);
+	return 0;
+}
@@ -80,9 +80,46 @@ static bool incrementalTreeTest(){
 	return true;
 }
 
+static bool boundedKNNTest(){
+	SPPoint** pointsArray =spKD2DArrayPoints();
+	SPKDTreeNode* tree = spKDTreeBuild(pointsArray, 5, 2, MAX_SPREAD);
+	double query_data[2] = {2,3};
+	SPPoint* query = spPointCreate(query_data,2,0);
+	SPBPQueue* exact = spBPQueueCreate(3);
+	SPBPQueue* bounded = spBPQueueCreate(3);
+	BPQueueElement exactElement, boundedElement;
+
+	// with enough checks the approximate search is exact
+	ASSERT_TRUE(spKDTreeNodeGetKNN(tree, exact, query) == 1);
+	ASSERT_TRUE(spKDTreeNodeGetKNNBounded(tree, bounded, query, 5) == 1);
+	while (!spBPQueueIsEmpty(exact)) {
+		spBPQueuePeek(exact, &exactElement);
+		spBPQueuePeek(bounded, &boundedElement);
+		ASSERT_TRUE(exactElement.index == boundedElement.index);
+		spBPQueueDequeue(exact);
+		spBPQueueDequeue(bounded);
+	}
+	ASSERT_TRUE(spBPQueueIsEmpty(bounded));
+
+	// with a single check the BPQueue is still filled
+	ASSERT_TRUE(spKDTreeNodeGetKNNBounded(tree, bounded, query, 1) == 1);
+	ASSERT_TRUE(spBPQueueIsFull(bounded));
+	ASSERT_TRUE(spKDTreeNodeGetKNNBounded(tree, bounded, query, 0) == -1);
+
+	spBPQueueDestroy(exact);
+	spBPQueueDestroy(bounded);
+	spPointDestroy(query);
+	spPoint1DDestroy(pointsArray, 5);
+	spKDTreeNodeDestroy(tree);
+
+	return true;
+}
+
 int main(){
 	RUN_TEST(maxSpreadTreeTest);
 	printf("*********************************************\n");
 	RUN_TEST(incrementalTreeTest);
 	printf("*********************************************\n");
+	RUN_TEST(boundedKNNTest);
+	printf("*********************************************\n");
 }
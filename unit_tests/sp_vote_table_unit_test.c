@@ -0,0 +1,101 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "unit_test_util.h" //SUPPORTING MACROS ASSERT_TRUE/ASSERT_FALSE etc..
+#include "../SPVoteTable.h"
+
+static bool voteTableAddGetTest(){
+	SPVoteTable* table = spVoteTableCreate(2);
+	ASSERT_TRUE(table != NULL);
+	ASSERT_TRUE(spVoteTableAdd(table, 7, 1) == SP_VOTE_TABLE_SUCCESS);
+	ASSERT_TRUE(spVoteTableAdd(table, 7, 2) == SP_VOTE_TABLE_SUCCESS);
+	ASSERT_TRUE(spVoteTableAdd(table, 3, 1) == SP_VOTE_TABLE_SUCCESS);
+	ASSERT_TRUE(spVoteTableAdd(table, -1, 1) == SP_VOTE_TABLE_INVALID_ARGUMENT);
+	ASSERT_TRUE(spVoteTableAdd(table, 1, 0) == SP_VOTE_TABLE_INVALID_ARGUMENT);
+	ASSERT_TRUE(spVoteTableGet(table, 7) == 3);
+	ASSERT_TRUE(spVoteTableGet(table, 3) == 1);
+	ASSERT_TRUE(spVoteTableGet(table, 4) == 0);
+	ASSERT_TRUE(spVoteTableSize(table) == 2);
+
+	// growing way past the initial capacity
+	for (int i=0; i<1000; i++) {
+		ASSERT_TRUE(spVoteTableAdd(table, 100+i, i+1) == SP_VOTE_TABLE_SUCCESS);
+	}
+	ASSERT_TRUE(spVoteTableSize(table) == 1002);
+	ASSERT_TRUE(spVoteTableGet(table, 7) == 3);
+	ASSERT_TRUE(spVoteTableGet(table, 1099) == 1000);
+
+	spVoteTableClear(table);
+	ASSERT_TRUE(spVoteTableSize(table) == 0);
+	ASSERT_TRUE(spVoteTableGet(table, 7) == 0);
+	ASSERT_TRUE(spVoteTableGet(table, 1099) == 0);
+
+	spVoteTableDestroy(table);
+	return true;
+}
+
+static bool voteTableTopNTest(){
+	SPVoteTable* table = spVoteTableCreate(8);
+	BPQueueElement res[5];
+	int votes[10] = {0, 4, 0, 9, 4, 1, 0, 4, 0, 2};
+	for (int i=0; i<10; i++) {
+		if (votes[i] > 0)
+			spVoteTableAdd(table, i, votes[i]);
+	}
+	// same order as sorting all the images by votes, then by index
+	ASSERT_TRUE(spVoteTableTopN(table, 4, 10, res) == 4);
+	ASSERT_TRUE(res[0].index == 3 && res[0].value == 9);
+	ASSERT_TRUE(res[1].index == 1 && res[1].value == 4);
+	ASSERT_TRUE(res[2].index == 4 && res[2].value == 4);
+	ASSERT_TRUE(res[3].index == 7 && res[3].value == 4);
+	ASSERT_TRUE(spVoteTableTopN(table, 11, 10, res) == -1);
+	ASSERT_TRUE(spVoteTableTopN(table, 0, 10, res) == -1);
+	spVoteTableDestroy(table);
+	return true;
+}
+
+static bool voteTableTopNPaddingTest(){
+	SPVoteTable* table = spVoteTableCreate(8);
+	BPQueueElement res[5];
+	spVoteTableAdd(table, 2, 3);
+	spVoteTableAdd(table, 0, 1);
+	// only two images received votes, the rest are the lowest indexes without votes
+	ASSERT_TRUE(spVoteTableTopN(table, 5, 6, res) == 5);
+	ASSERT_TRUE(res[0].index == 2 && res[0].value == 3);
+	ASSERT_TRUE(res[1].index == 0 && res[1].value == 1);
+	ASSERT_TRUE(res[2].index == 1 && res[2].value == 0);
+	ASSERT_TRUE(res[3].index == 3 && res[3].value == 0);
+	ASSERT_TRUE(res[4].index == 4 && res[4].value == 0);
+	spVoteTableDestroy(table);
+	return true;
+}
+
+static bool voteTableMergeTest(){
+	SPVoteTable* a = spVoteTableCreate(4);
+	SPVoteTable* b = spVoteTableCreate(4);
+	spVoteTableAdd(a, 1, 2);
+	spVoteTableAdd(a, 5, 1);
+	spVoteTableAdd(b, 5, 4);
+	spVoteTableAdd(b, 9, 1);
+	ASSERT_TRUE(spVoteTableMerge(a, b) == SP_VOTE_TABLE_SUCCESS);
+	ASSERT_TRUE(spVoteTableGet(a, 1) == 2);
+	ASSERT_TRUE(spVoteTableGet(a, 5) == 5);
+	ASSERT_TRUE(spVoteTableGet(a, 9) == 1);
+	ASSERT_TRUE(spVoteTableSize(a) == 3);
+	ASSERT_TRUE(spVoteTableMerge(a, NULL) == SP_VOTE_TABLE_INVALID_ARGUMENT);
+	spVoteTableDestroy(a);
+	spVoteTableDestroy(b);
+	return true;
+}
+
+int main(){
+	RUN_TEST(voteTableAddGetTest);
+	printf("*********************************************\n");
+	RUN_TEST(voteTableTopNTest);
+	printf("*********************************************\n");
+	RUN_TEST(voteTableTopNPaddingTest);
+	printf("*********************************************\n");
+	RUN_TEST(voteTableMergeTest);
+	printf("*********************************************\n");
+	return 0;
+}